@@ -25,24 +25,39 @@
 #include "game.h"
 #include "ai.h"
 #include "client.h"
+#include "common_glib.h"
+#include "network.h"
+#include "node_cache.h"
 #include <stdlib.h>
 #include <stdio.h>
 #include <unistd.h>
 #include <string.h>
 
-static char *server = NULL;
-static char *port = NULL;
-static char *name = NULL;
-char *chromosomeFile = NULL;
-static char *ai;
-static int waittime = 1000;
-static gboolean silent = FALSE;
-static gboolean enable_debug = FALSE;
-static gboolean show_version = FALSE;
-static Map *map = NULL;
+static THREAD_LOCAL char *server = NULL;
+static THREAD_LOCAL char *port = NULL;
+static THREAD_LOCAL char *name = NULL;
+THREAD_LOCAL char *chromosomeFile = NULL;
+static THREAD_LOCAL char *ai;
+static THREAD_LOCAL int waittime = 1000;
+static THREAD_LOCAL gboolean silent = FALSE;
+THREAD_LOCAL gboolean ai_quiet = FALSE;
+THREAD_LOCAL gint ai_simulations = 0;
+THREAD_LOCAL gint ai_think_time = 0;
+static THREAD_LOCAL gboolean enable_debug = FALSE;
+static THREAD_LOCAL gboolean show_version = FALSE;
+static THREAD_LOCAL gint64 seed = -1;
+static THREAD_LOCAL Map *map = NULL;
+
+/** The step of the computer player that waits for the pacing delay */
+static THREAD_LOCAL AiStep pending_step = NULL;
+/** The mode of the client when the step was scheduled */
+static THREAD_LOCAL enum callback_mode pending_mode;
+static THREAD_LOCAL guint pending_timer = 0;
 
 /** Randomizer only to be used for chat messages */
-GRand *chat_rand;
+THREAD_LOCAL GRand *chat_rand;
+
+THREAD_LOCAL GRand *ai_rand;
 
 /** Use any of the messages from the array to chat.
  * @param array An array for gchar * containing chat messages.
@@ -57,7 +72,7 @@ GRand *chat_rand;
 
 /** Avoid multiple chat messages when more than one other player
  * must discard resources */
-gboolean discard_starting;
+THREAD_LOCAL gboolean discard_starting;
 
 
 static void logbot_init(void);
@@ -80,43 +95,57 @@ static const struct algorithm_info {
 /* *INDENT-ON* */
 };
 
-static guint active_algorithm = 0;
-
-UIDriver Glib_Driver;
-
-static GOptionEntry commandline_entries[] = {
-	{ "chromosome-file", '\0', 0, G_OPTION_ARG_STRING, &chromosomeFile,
-	 /* Commandline pioneersai: chromosome-file */
-	 N_("Chromosome File"), NULL },
-	{ "server", 's', 0, G_OPTION_ARG_STRING, &server,
-	 /* Commandline pioneersai: server */
-	 N_("Server Host"), PIONEERS_DEFAULT_GAME_HOST },
-	{ "port", 'p', 0, G_OPTION_ARG_STRING, &port,
-	 /* Commandline pioneersai: port */
-	 N_("Server Port"), PIONEERS_DEFAULT_GAME_PORT },
-	{ "name", 'n', 0, G_OPTION_ARG_STRING, &name,
-	 /* Commandline pioneersai: name */
-	 N_("Computer name (mandatory)"), NULL },
-	{ "time", 't', 0, G_OPTION_ARG_INT, &waittime,
-	 /* Commandline pioneersai: time */
-	 N_("Time to wait between turns (in milliseconds)"), "1000" },
-	{ "chat-free", 'c', 0, G_OPTION_ARG_NONE, &silent,
-	 /* Commandline pioneersai: chat-free */
-	 N_("Stop computer player from talking"), NULL },
-	{ "algorithm", 'a', 0, G_OPTION_ARG_STRING, &ai,
-	 /* Commandline pioneersai: algorithm */
-	 N_("Type of computer player"), "greedy" },
-	{ "debug", '\0', 0, G_OPTION_ARG_NONE, &enable_debug,
-	 /* Commandline option of ai: enable debug logging */
-	 N_("Enable debug messages"), NULL },
-	{ "version", '\0', 0, G_OPTION_ARG_NONE, &show_version,
-	 /* Commandline option of ai: version */
-	 N_("Show version information"), NULL },
-	{ NULL, '\0', 0, 0, NULL, NULL, NULL }
-};
+static THREAD_LOCAL guint active_algorithm = 0;
 
 static void ai_init_glib_et_al(int argc, char **argv)
 {
+	/* The options are stored per thread, so the addresses are only
+	 * known at runtime */
+	GOptionEntry commandline_entries[] = {
+		{ "chromosome-file", '\0', 0, G_OPTION_ARG_STRING, &chromosomeFile,
+		 /* Commandline pioneersai: chromosome-file */
+		 N_("Chromosome File"), NULL },
+		{ "simulations", '\0', 0, G_OPTION_ARG_INT, &ai_simulations,
+		 /* Commandline pioneersai: simulations */
+		 N_("Number of simulations of the genetic player"), "100" },
+		{ "think-time", '\0', 0, G_OPTION_ARG_INT, &ai_think_time,
+		 /* Commandline pioneersai: think-time */
+		 N_("Time for the simulations of the genetic player "
+		    "(in milliseconds)"), NULL },
+		{ "server", 's', 0, G_OPTION_ARG_STRING, &server,
+		 /* Commandline pioneersai: server */
+		 N_("Server Host"), PIONEERS_DEFAULT_GAME_HOST },
+		{ "port", 'p', 0, G_OPTION_ARG_STRING, &port,
+		 /* Commandline pioneersai: port */
+		 N_("Server Port"), PIONEERS_DEFAULT_GAME_PORT },
+		{ "name", 'n', 0, G_OPTION_ARG_STRING, &name,
+		 /* Commandline pioneersai: name */
+		 N_("Computer name (mandatory)"), NULL },
+		{ "time", 't', 0, G_OPTION_ARG_INT, &waittime,
+		 /* Commandline pioneersai: time */
+		 N_("Time to wait between turns (in milliseconds), "
+		    "0 for no delay"), "1000" },
+		{ "chat-free", 'c', 0, G_OPTION_ARG_NONE, &silent,
+		 /* Commandline pioneersai: chat-free */
+		 N_("Stop computer player from talking"), NULL },
+		{ "quiet", 'q', 0, G_OPTION_ARG_NONE, &ai_quiet,
+		 /* Commandline pioneersai: quiet */
+		 N_("Do not print the reasoning of the computer player"),
+		 NULL },
+		{ "algorithm", 'a', 0, G_OPTION_ARG_STRING, &ai,
+		 /* Commandline pioneersai: algorithm */
+		 N_("Type of computer player"), "greedy" },
+		{ "debug", '\0', 0, G_OPTION_ARG_NONE, &enable_debug,
+		 /* Commandline option of ai: enable debug logging */
+		 N_("Enable debug messages"), NULL },
+		{ "version", '\0', 0, G_OPTION_ARG_NONE, &show_version,
+		 /* Commandline option of ai: version */
+		 N_("Show version information"), NULL },
+		{ "seed", '\0', 0, G_OPTION_ARG_INT64, &seed,
+		 /* Commandline option of ai: seed */
+		 N_("Seed for the random number generators"), "N" },
+		{ NULL, '\0', 0, 0, NULL, NULL, NULL }
+	};
 	GOptionContext *context;
 	GError *error = NULL;
 
@@ -144,13 +173,24 @@ static void ai_init_glib_et_al(int argc, char **argv)
 	/* Starting with glib 2.36, this function does nothing */
 	g_type_init();
 #endif
-	set_ui_driver(&Glib_Driver);
-	log_set_func_default();
+	if (seed >= 0) {
+		g_rand_set_seed(chat_rand, (guint32) seed);
+		g_rand_set_seed(ai_rand, (guint32) seed + 1);
+	}
+	/* When the computer player runs in the process of a server, the
+	 * server has already set up the driver */
+	if (driver == NULL) {
+		set_ui_driver(&Glib_Driver);
+		log_set_func_default();
+	}
 }
 
 static void ai_init(void)
 {
-	set_enable_debug(enable_debug);
+	/* Do not turn off the debug messages of a server that hosts
+	 * this computer player */
+	if (enable_debug)
+		set_enable_debug(TRUE);
 
 	if (server == NULL)
 		server = g_strdup(PIONEERS_DEFAULT_GAME_HOST);
@@ -194,6 +234,7 @@ static void ai_offline(void)
 		   !algorithms[active_algorithm].request_player);
 	g_free(style);
 	g_free(name);
+	name = NULL;
 }
 
 static void ai_start_game(void)
@@ -205,9 +246,41 @@ static void ai_start_game(void)
 	}
 }
 
-void ai_wait(void)
+static void ai_cancel_wait(void)
+{
+	if (pending_timer != 0) {
+		net_source_remove(g_main_context_get_thread_default(),
+				  pending_timer);
+		pending_timer = 0;
+	}
+	pending_step = NULL;
+}
+
+static gboolean ai_resume(G_GNUC_UNUSED gpointer data)
+{
+	AiStep step = pending_step;
+
+	pending_timer = 0;
+	pending_step = NULL;
+	/* When the state has changed in the meantime, the client has
+	 * already asked for the next decision */
+	if (callback_mode == pending_mode)
+		step();
+	return FALSE;
+}
+
+void ai_wait(AiStep step)
 {
-	g_usleep((gulong) waittime * 1000u);
+	ai_cancel_wait();
+	if (waittime <= 0) {
+		step();
+		return;
+	}
+	pending_step = step;
+	pending_mode = callback_mode;
+	pending_timer =
+	    net_timeout_add(g_main_context_get_thread_default(),
+			    (guint) waittime, ai_resume, NULL);
 }
 
 void ai_chat(const char *message)
@@ -224,6 +297,12 @@ static Map *ai_get_map(void)
 static void ai_set_map(Map * new_map)
 {
 	map = new_map;
+	node_cache_reset();
+}
+
+static void ai_draw_node(Node * node)
+{
+	node_cache_node_changed(node);
 }
 
 /* Chat messages */
@@ -450,6 +529,7 @@ static void ai_game_over(gint player_num, G_GNUC_UNUSED gint points)
 		/* AI chat when another player wins */
 		ai_chat(N_("My congratulations"));
 	}
+	node_cache_log_statistics();
 	cb_disconnect();
 }
 
@@ -461,6 +541,7 @@ void frontend_set_callbacks(void)
 	callbacks.start_game = &ai_start_game;
 	callbacks.get_map = &ai_get_map;
 	callbacks.set_map = &ai_set_map;
+	callbacks.draw_node = &ai_draw_node;
 	callbacks.error = &ai_error;
 	callbacks.game_over = &ai_game_over;
 
@@ -474,6 +555,35 @@ void frontend_set_callbacks(void)
 	callbacks.new_statistics = &chat_new_statistics;
 
 	chat_rand = g_rand_new();
+	ai_rand = g_rand_new();
+}
+
+void ai_finish(void)
+{
+	ai_cancel_wait();
+	node_cache_free();
+	g_free(server);
+	server = NULL;
+	g_free(port);
+	port = NULL;
+	g_free(name);
+	name = NULL;
+	g_free(ai);
+	ai = NULL;
+	g_free(chromosomeFile);
+	chromosomeFile = NULL;
+	waittime = 1000;
+	silent = FALSE;
+	ai_quiet = FALSE;
+	ai_simulations = 0;
+	ai_think_time = 0;
+	enable_debug = FALSE;
+	seed = -1;
+	active_algorithm = 0;
+	g_rand_free(chat_rand);
+	chat_rand = NULL;
+	g_rand_free(ai_rand);
+	ai_rand = NULL;
 }
 
 /* The logbot is intended to be used as a spectator in a game, and to collect
@@ -25,11 +25,33 @@
 #include "callback.h"
 
 /** Filename for the chromosome of the genetic player */
-extern char *chromosomeFile;
+extern THREAD_LOCAL char *chromosomeFile;
+/** Randomizer for the decisions of the computer player */
+extern THREAD_LOCAL GRand *ai_rand;
+/** Do not print the reasoning of the computer player */
+extern THREAD_LOCAL gboolean ai_quiet;
+/** Number of simulations of the genetic player, 0 for the default */
+extern THREAD_LOCAL gint ai_simulations;
+/** Time in ms for the simulations of the genetic player, 0 to use
+ * the number of simulations instead */
+extern THREAD_LOCAL gint ai_think_time;
+
+/** A decision of the computer player, that is made after a delay */
+typedef void (*AiStep) (void);
 
 void ai_panic(const char *message);
-void ai_wait(void);
+/** Make a decision after the delay that is set on the command line.
+ * The main loop keeps running while waiting, a new call replaces the
+ * step that is still waiting.  The step is dropped when the mode of
+ * the client changes in the meantime.
+ * @param step The decision to make
+ */
+void ai_wait(AiStep step);
 void ai_chat(const char *message);
+/** Release the resources of the computer player of this thread.
+ * Only needed when the computer player runs inside another program.
+ */
+void ai_finish(void);
 void genetic_init(void);
 void greedy_init(void);
 void lobbybot_init(void);
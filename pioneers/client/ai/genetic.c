@@ -22,15 +22,18 @@
 #include "ai.h"
 #include "genetic_core.h"
 #include "cost.h"
+#include "node_cache.h"
+#include <stdarg.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
 /*
  * This is computer a player for Pioneers based on a genetic algorithm.
  */
 
 /** default chromosome */
-struct chromosome_t thisChromosome = (struct chromosome_t) {
+const struct chromosome_t default_chromosome = {
 	{
 	 /* weight of every resource, value of Development Card, relative value of City 
 	    (compared to equivalen Settlement) and Ports, when I have X Victory Points */
@@ -48,14 +51,23 @@ struct chromosome_t thisChromosome = (struct chromosome_t) {
 	1.714336, 0.580583, 0.265190	/* depreciation, turn and probability */
 };
 
+/** chromosome of the current game */
+static THREAD_LOCAL struct chromosome_t thisChromosome;
+
 typedef struct resource_values_s {
 	float value[NO_RESOURCE];
 	MaritimeInfo info;
 	gint ports[NO_RESOURCE];
 } resource_values_t;
 
-static int quote_num;
-static gboolean default_chromosome_used = TRUE;
+static THREAD_LOCAL int quote_num;
+static THREAD_LOCAL gboolean default_chromosome_used = TRUE;
+/* The arguments of the callbacks, for the decisions after the delay */
+static THREAD_LOCAL gint setup_settlements;
+static THREAD_LOCAL gint setup_roads;
+static THREAD_LOCAL gint free_roads;
+static THREAD_LOCAL gint discard_count;
+static THREAD_LOCAL gint plenty_bank[NO_RESOURCE];
 
 /* things we can buy, in the order that we want them. */
 typedef enum {
@@ -115,37 +127,23 @@ float bestActualAverageResourcesSupply(const struct gameState_t
 
 typedef struct node_seen_set_s {
 
-	Node *seen[MAP_SIZE * MAP_SIZE];
-	int size;
+	guint32 seen[MAP_SET_WORDS(MAP_SIZE * MAP_SIZE * 6)];
 
 } node_seen_set_t;
 
 static void nodeset_reset(node_seen_set_t * set)
 {
-	set->size = 0;
+	memset(set->seen, 0, sizeof(set->seen));
 }
 
 static void nodeset_set(node_seen_set_t * set, Node * n)
 {
-	int i;
-
-	for (i = 0; i < set->size; i++)
-		if (set->seen[i] == n)
-			return;
-
-	set->seen[set->size] = n;
-	set->size++;
+	MAP_SET_ADD(set->seen, n->id);
 }
 
 static int nodeset_isset(node_seen_set_t * set, Node * n)
 {
-	int i;
-
-	for (i = 0; i < set->size; i++)
-		if (set->seen[i] == n)
-			return 1;
-
-	return 0;
+	return MAP_SET_TEST(set->seen, n->id);
 }
 
 typedef void iterate_node_func_t(Node * n, void *rock);
@@ -503,8 +501,8 @@ static void reevaluate_resources(resource_values_t * outval)
 	/*
 	 * Save the maritime info too so we know if we can do port trades
 	 */
-	map_maritime_info(callbacks.get_map(), &outval->info,
-			  my_player_num());
+	port_index_maritime_info(get_port_index(), &outval->info,
+				 my_player_num());
 
 	for (i = 0; i < NO_RESOURCE; i++) {
 		if (outval->info.specific_resource[i])
@@ -591,16 +589,40 @@ static int facingOK(const Node * node, Hex * hex)
 
 
 
+/** The inputs of genetic_score_node that are the same for all nodes */
+struct scoreInputs_t {
+	const struct chromosome_t *chromosome;
+	int victoryPoints;	/* max index in chromosome */
+	MaritimeInfo info;
+	int resourcesSupply[11][5];
+};
+static THREAD_LOCAL struct scoreInputs_t scoreInputs;
+
+/* Sets the inputs for genetic_score_node, before the nodes are scored with this chromosome and game state */
+static void set_score_inputs(const struct chromosome_t *myChromosome,
+			     const struct gameState_t *myGameState)
+{
+	/* The padding is compared too */
+	memset(&scoreInputs, 0, sizeof(scoreInputs));
+	scoreInputs.chromosome = myChromosome;
+	scoreInputs.victoryPoints = player_get_score(my_player_num());
+	if (scoreInputs.victoryPoints > 9)
+		scoreInputs.victoryPoints = 9;
+	port_index_maritime_info(get_port_index(), &scoreInputs.info,
+				 my_player_num());
+	memcpy(scoreInputs.resourcesSupply, myGameState->resourcesSupply,
+	       sizeof(scoreInputs.resourcesSupply));
+	node_cache_set_inputs(&scoreInputs, sizeof(scoreInputs));
+}
+
 /* It returns the value given to an hex surrounding a node. We also need to know the node to check (for maritime hexes) if it has access to the port */
 static float genetic_score_hex(const Node * node, Hex * hex,
 			       const struct chromosome_t *myChromosome,
 			       const struct gameState_t *myGameState)
 {
 	Resource resrc;
-	int victoryPoints = player_get_score(my_player_num());
-	if (victoryPoints > 9)
-		victoryPoints = 9;	/* max index in chromosome */
-	MaritimeInfo info;
+	int victoryPoints = scoreInputs.victoryPoints;
+	const MaritimeInfo *info = &scoreInputs.info;
 	float value = 0;
 	float port_bonus = 0;	/* bonus for being a port */
 	float port_constant =
@@ -611,11 +633,10 @@ static float genetic_score_hex(const Node * node, Hex * hex,
 		return 0;
 	int increment = dice_AVR(hex->roll);	/* Average resources supply each 36 turns given by that number */
 	resrc = terrain_to_resource(hex->terrain);
-	map_maritime_info(callbacks.get_map(), &info, my_player_num());
 	/* I want to decrease the devaluation the hex resource suffers (increase the hex value) if a I have a generic port or a specific port to export that resource */
-	if (info.any_resource)
+	if (info->any_resource)
 		port = 3;	/* I have a generic port, depreciation will be less */
-	else if (resrc < NO_RESOURCE && info.specific_resource[resrc])
+	else if (resrc < NO_RESOURCE && info->specific_resource[resrc])
 		port = 2;	/* I have a port to export this resource, depreciation will be even less */
 	nodeHasPort = facingOK(node, hex);
 	if (resrc < NO_RESOURCE) {
@@ -624,7 +645,7 @@ static float genetic_score_hex(const Node * node, Hex * hex,
 		    resourcesIncrementValue(increment, resrc,
 					    victoryPoints, myChromosome,
 					    myGameState, port);
-	} else if ((hex->resource == ANY_RESOURCE) && (!info.any_resource)) {
+	} else if ((hex->resource == ANY_RESOURCE) && (!info->any_resource)) {
 		/* This is a generic port and I do not have one, its value depends on my best supplied resource */
 		port_bonus =
 		    bestActualAverageResourcesSupply(myGameState) / 36.0;
@@ -690,6 +711,7 @@ static float score_node(const Node * node, gboolean city,
 }
 #endif
 
+/* The inputs must have been set with set_score_inputs */
 static float genetic_score_node(const Node * node, gboolean city,
 				const struct chromosome_t *myChromosome,
 				const struct gameState_t *myGameState)
@@ -700,22 +722,24 @@ static float genetic_score_node(const Node * node, gboolean city,
 	/* if not a node, how did this happen? */
 	g_assert(node != NULL);
 
+	if (node_cache_lookup(node, city, &score))
+		return score;
+
 	/* if already occupied, in water, or too close to others  give a score of -1 */
 	if (is_node_on_land(node) == FALSE)
-		return -1;
-	if (is_node_spacing_ok(node) == FALSE)
-		return -1;
-	if (!city) {
-		if (node->owner != -1)	/* I want a settlement, and this is already occupied */
-			return -1;
-	}
-
-	for (i = 0; i < 3; i++) {
-		score +=
-		    genetic_score_hex(node, node->hexes[i], myChromosome,
-				      myGameState);
-	}
+		score = -1;
+	else if (is_node_spacing_ok(node) == FALSE)
+		score = -1;
+	else if (!city && node->owner != -1)	/* I want a settlement, and this is already occupied */
+		score = -1;
+	else
+		for (i = 0; i < 3; i++) {
+			score +=
+			    genetic_score_hex(node, node->hexes[i],
+					      myChromosome, myGameState);
+		}
 
+	node_cache_store(node, city, score);
 	return score;
 }
 
@@ -756,6 +780,7 @@ static Node *best_settlement_spot(gboolean during_setup,
 	float score;
 	Map *map = callbacks.get_map();
 
+	set_score_inputs(myChromosome, myGameState);
 	for (i = 0; i < map->x_size; i++) {
 		for (j = 0; j < map->y_size; j++) {
 			for (k = 0; k < 6; k++) {
@@ -819,6 +844,7 @@ static Node *best_city_spot(const struct chromosome_t *myChromosome,
 	float bestscore = -1.0;
 	Map *map = callbacks.get_map();
 
+	set_score_inputs(myChromosome, myGameState);
 	for (i = 0; i < map->x_size; i++) {
 		for (j = 0; j < map->y_size; j++) {
 			for (k = 0; k < 6; k++) {
@@ -931,6 +957,7 @@ static Edge *best_road_to_road_spot(Node * n, float *score, const struct chromos
 	Edge *best = NULL;
 	int i, j;
 
+	set_score_inputs(myChromosome, myGameState);
 	for (i = 0; i < 3; i++) {
 		Edge *e = n->edges[i];
 		if (e) {
@@ -1026,6 +1053,7 @@ static Edge *best_road_spot(const struct chromosome_t *myChromosome,
 	node_seen_set_t nodeseen;
 	Map *map = callbacks.get_map();
 
+	set_score_inputs(myChromosome, myGameState);
 	/*
 	 * For every node that we're the owner of traverse out to find the best
 	 * node we're one road away from and build that road
@@ -1339,7 +1367,7 @@ static void set_myPorts(gint * myPorts)
 {
 	MaritimeInfo info;
 	int i;
-	map_maritime_info(callbacks.get_map(), &info, my_player_num());
+	port_index_maritime_info(get_port_index(), &info, my_player_num());
 	for (i = 0; i < NO_RESOURCE; i++) {
 		if (info.specific_resource[i])
 			myPorts[i] = 2;
@@ -1352,9 +1380,14 @@ static void set_myPorts(gint * myPorts)
 }
 #endif
 
-
-
-
+/** Prepare the simulations with the budget from the command line */
+static void init_simulation(struct simulationsData_t *simulation)
+{
+	simulation->rand = ai_rand;
+	simulation->numberOfSimulations =
+	    ai_simulations > 0 ? ai_simulations : DEFAULT_SIMULATIONS;
+	simulation->timeBudget = ai_think_time;
+}
 
 void updateTradingMatrix(const struct chromosome_t *myChromosome,
 			 float profit,
@@ -1373,7 +1406,8 @@ void updateTradingMatrix(const struct chromosome_t *myChromosome,
 	float turn = myChromosome->turn;
 	float prob = myChromosome->probability;
 	MaritimeInfo info;
-	map_maritime_info(callbacks.get_map(), &info, my_player_num());
+	port_index_maritime_info(get_port_index(), &info, my_player_num());
+	init_simulation(&thisSimulation);
 
 	for (give = 0; give <= 4; give++) {
 		for (take = 0; take <= 4; take++) {
@@ -1597,36 +1631,39 @@ static gboolean will_play_development_card(DevelType cardtype)
 void outputGameState(const struct gameState_t myGameState)
 {
 	int i, j;
-	printf("\033[2J");	/*  clear the screen  */
-	printf("\033[H");	/*  position cursor at top-left corner */
+	genetic_print("\033[2J");	/*  clear the screen  */
+	/*  position cursor at top-left corner */
+	genetic_print("\033[H");
 	/*int sysret;
 	   sysret=system("clear");
 	   if (sysret) return; */
-	printf("\t\t\t\tBr\tGr\tOr\tWo\tLu\n");
+	genetic_print("\t\t\t\tBr\tGr\tOr\tWo\tLu\n");
 	for (i = 0; i <= 10; i++) {
-		printf("\t\t\t\t");
+		genetic_print("\t\t\t\t");
 		for (j = 0; j < 5; j++) {
-			printf("%d\t", myGameState.resourcesSupply[i][j]);
+			genetic_print("%d\t",
+				      myGameState.resourcesSupply[i][j]);
 		}
-		printf("If %d is rolled\n", i + 2);
+		genetic_print("If %d is rolled\n", i + 2);
 	}
-	printf("\n\t\t\t\tSET\tCIT\tDEV\tRSET\tRRSET\n");
-	printf("\t\tActionValues:\t%.2f\t%.2f\t%.2f\t%.2f\t%.2f\n\n",
+	genetic_print("\n\t\t\t\tSET\tCIT\tDEV\tRSET\tRRSET\n");
+	genetic_print("\t\tActionValues:\t%.2f\t%.2f\t%.2f\t%.2f\t%.2f\n\n",
 	       myGameState.actionValue[SET], myGameState.actionValue[CIT],
 	       myGameState.actionValue[DEV], myGameState.actionValue[RSET],
 	       myGameState.actionValue[RRSET]);
-	printf("\t\t\t\tBr\tGr\tOr\tWo\tLu\n");
-	printf("\t\tResources:");
+	genetic_print("\t\t\t\tBr\tGr\tOr\tWo\tLu\n");
+	genetic_print("\t\tResources:");
 	for (i = 0; i < NO_RESOURCE; ++i)
-		printf("\t%d", myGameState.resourcesAlreadyHave[i]);
-	printf("\tTotal resources:\t%d\t\tVictory Points:\t%d\n\n",
+		genetic_print("\t%d", myGameState.resourcesAlreadyHave[i]);
+	genetic_print("\tTotal resources:\t%d\t\tVictory Points:\t%d\n\n",
 	       player_get(my_player_num())->statistics[STAT_RESOURCES],
 	       player_get_score(my_player_num()));
-	printf("Statistics:\t");
+	genetic_print("Statistics:\t");
 	for (i = 0; i <= STAT_DEVELOPMENT; i++) {
-		printf("%d\t", player_get(my_player_num())->statistics[i]);
+		genetic_print("%d\t",
+			      player_get(my_player_num())->statistics[i]);
 	}
-	printf
+	genetic_print
 	    ("\nStock of:\tRoads %d\tSettlements %d\tCities %d\tDev. Cards %d\n",
 	     stock_num_roads(), stock_num_settlements(),
 	     stock_num_cities(), stock_num_develop());
@@ -1641,25 +1678,26 @@ void outputStrategy(strategy_t myStrategy,
 	time_a = mySimulation.turnsToAction[myStrategy[0]];
 	time_b =
 	    mySimulation.timeCombinedAction[myStrategy[0]][myStrategy[1]];
-	printf("\n\t\tMy strategy is to do ");
+	genetic_print("\n\t\tMy strategy is to do ");
 	printAction(myStrategy[0]);
-	printf(" at time %d, and ", time_a);
+	genetic_print(" at time %d, and ", time_a);
 	printAction(myStrategy[1]);
-	printf(" at time %d\n", time_b);
+	genetic_print(" at time %d\n", time_b);
 	if (time_a == 0) {
-		printf("\t\tSince I can do ");
+		genetic_print("\t\tSince I can do ");
 		printAction(myStrategy[0]);
-		printf(" now, I will do it\n");
+		genetic_print(" now, I will do it\n");
 	} else if (((myStrategy[0] == RSET) || (myStrategy[0] == RRSET)
 		    || (myStrategy[0] == CIT))
 		   &&
 		   (checkRoadNow
 		    (myStrategy[0], myStrategy[1], myGameState))) {
-		printf("\t\tI cannot do ");
+		genetic_print("\t\tI cannot do ");
 		printAction(myStrategy[0]);
-		printf(" complete, but I can already build the road.\n");
+		genetic_print
+		    (" complete, but I can already build the road.\n");
 	}
-	printf("\n");
+	genetic_print("\n");
 
 }
 
@@ -1690,12 +1728,8 @@ static int lastMinute(void)
 }
 
 
-/*
- * What to do? what to do?
- *
- */
-
-static void genetic_turn(void)
+/** The part of the turn after the dice have been rolled */
+static void genetic_turn_rolled(void)
 {
 	/* resource_values_t resval; */
 	struct gameState_t thisGameState;
@@ -1703,6 +1737,7 @@ static void genetic_turn(void)
 	guint i;
 	strategy_t thisStrategy;
 	float turn, probability;
+	init_simulation(&thisSimulation);
 	turn = thisChromosome.turn;
 	probability = thisChromosome.probability;
 	Node *city_node;
@@ -1718,41 +1753,11 @@ static void genetic_turn(void)
 	Resource trade_away, want_resource;
 	int amount;
 
-	printf("Entering genetic_turn...\n");
 	int victoryPoints = player_get_score(my_player_num());
 
 	if (victoryPoints > 9)
 		victoryPoints = 9;	/* Maximum index in the chromosome */
 
-
-
-	/* play soldier card before the turn when an own resource is blocked */
-	Hex *hex = map_robber_hex(callbacks.get_map());
-	if (hex && !have_rolled_dice() && can_play_any_develop()) {
-		const Deck *deck = get_devel_deck();
-		for (i = 0; i < deck_count(deck); i++) {
-			DevelType cardtype = deck_get_guint(deck, i);
-			if (cardtype == DEVEL_SOLDIER
-			    && can_play_develop(i)) {
-				int j;
-				for (j = 0; j < 6; j++) {
-					if (hex->nodes[j]->owner ==
-					    my_player_num()) {
-						cb_play_develop(i);
-						return;
-					}
-				}
-			}
-		}
-	}
-
-	if (!have_rolled_dice()) {
-		cb_roll();
-		return;
-	}
-
-	/* Don't wait before the dice roll, that will take too long */
-	ai_wait();
 	/* reevaluate_resources(&resval); */
 
 	/* This is were I should read the chromosome, now it is using the default */
@@ -1827,38 +1832,37 @@ static void genetic_turn(void)
 
 	outputGameState(thisGameState);
 
-	printf("Calculating best strategy...\n");
+	genetic_print("Calculating best strategy...\n");
 	thisStrategyProfit =
 	    bestStrategy(turn, probability, &thisSimulation, thisStrategy,
 			 thisGameState, 0, 1, num_players());
-	ai_wait();
-	printf
+	genetic_print
 	    ("\t\t\t\tSET\tCIT\tDEV\tRSET\tRRSET\tS+SET\tS+CIT\tS+DEV\tS+RSET\tS+RRSET\tC+CIT\tC+DEV\tC+RSET\tC+RRSET\tD+DEV\tD+RSET\tD+RRSET\tR+RSET\tR+RRSET\tRR+RRSET\n");
-	printf("\t\tTime to Action:\t");
+	genetic_print("\t\tTime to Action:\t");
 	for (i = 0; i < NUM_ACTIONS; i++)
-		printf("%d\t", thisSimulation.turnsToAction[i]);
-	printf("\n");
+		genetic_print("%d\t", thisSimulation.turnsToAction[i]);
+	genetic_print("\n");
 	outputStrategy(thisStrategy, thisSimulation, thisGameState);
 
-	printf
+	genetic_print
 	    ("Will I do it? Lets see if I can trade to do something better...\n");
 
 
 	/* Trading code should go here. Now that I know my expected profit, I can see if there is a way to improve it trading */
-	printf("Updating trading matrixes...\n");
+	genetic_print("Updating trading matrixes...\n");
 	updateTradingMatrix(&thisChromosome, thisStrategyProfit,
 			    &thisTradingMatrixes, thisGameState, 1);
 	/* ai_wait(); */
 	if (best_maritime_trade
 	    (thisTradingMatrixes, &amount, &trade_away, &want_resource)
 	    && can_trade_maritime()) {
-		printf
+		genetic_print
 		    ("According to trading matrixes I will trade %d of %d for 1 of %d\n",
 		     amount, trade_away, want_resource);
 		cb_maritime(amount, trade_away, want_resource);
 		return;
 	} else
-		printf
+		genetic_print
 		    ("According to trading matrixes there is no favorable trade possible\n");
 
 
@@ -1869,15 +1873,16 @@ static void genetic_turn(void)
 	if (time_a == 0) {	/* I can do what I want NOW */
 		/* Under certain uncommon circumstances is possible for bestStrategy to choose an strategy whose first action yields profit 0,
 		 * so we should check that there is in fact possible to do what I want to do before trying to do it*/
-		printf("Resources:");
+		genetic_print("Resources:");
 		for (i = 0; i < 5; i++)
-			printf(" %d ", resource_asset(i));
-		printf("\n");
+			genetic_print(" %d ", resource_asset(i));
+		genetic_print("\n");
 		switch (thisStrategy[0]) {
 		case SET:{
 				if ((sett_node != NULL)
 				    && (stock_num_settlements())) {
-					printf("Building Settlement...\n");
+					genetic_print
+					    ("Building Settlement...\n");
 					cb_build_settlement(sett_node);
 					return;
 				}
@@ -1886,7 +1891,7 @@ static void genetic_turn(void)
 		case CIT:{
 				if ((city_node != NULL)
 				    && (stock_num_cities())) {
-					printf("Building City...\n");
+					genetic_print("Building City...\n");
 					cb_build_city(city_node);
 					return;
 				}
@@ -1895,7 +1900,7 @@ static void genetic_turn(void)
 		case RSET:{
 				if ((road_edge != NULL)
 				    && (stock_num_roads())) {
-					printf
+					genetic_print
 					    ("Building Road as part of RSET...\n");
 					cb_build_road(road_edge);
 					return;
@@ -1905,7 +1910,7 @@ static void genetic_turn(void)
 		case RRSET:{
 				if ((long_road_edge != NULL)
 				    && (stock_num_roads())) {
-					printf
+					genetic_print
 					    ("Building Road as part of RRSET...\n");
 					cb_build_road(long_road_edge);
 					return;
@@ -1914,7 +1919,7 @@ static void genetic_turn(void)
 			}
 		case DEV:{
 				if (can_buy_develop()) {
-					printf
+					genetic_print
 					    ("Buying Development Card...\n");
 					cb_buy_develop();
 					return;
@@ -1935,7 +1940,7 @@ static void genetic_turn(void)
 			switch (thisStrategy[1]) {
 			case RSET:
 				if (destinationRoadScore) {
-					printf
+					genetic_print
 					    ("Building Road of RSET in the meantime...\n");
 					cb_build_road(road_edge);
 					return;
@@ -1943,7 +1948,7 @@ static void genetic_turn(void)
 				break;
 			case RRSET:
 				if (destinationLongRoadScore) {
-					printf
+					genetic_print
 					    ("Building Road of RRSET in the meantime...\n");
 					cb_build_road(long_road_edge);
 					return;
@@ -1953,14 +1958,14 @@ static void genetic_turn(void)
 				if ((destinationRoadScore)
 				    && (destinationRoadScore >=
 					destinationLongRoadScore)) {
-					printf
+					genetic_print
 					    ("Building Road of RSET in the meantime...\n");
 					cb_build_road(road_edge);
 					return;
 				} else if ((destinationLongRoadScore)
 					   && (destinationLongRoadScore >
 					       destinationRoadScore)) {
-					printf
+					genetic_print
 					    ("Building Road of RRSET in the meantime...\n");
 					cb_build_road(long_road_edge);
 					return;
@@ -1979,7 +1984,7 @@ static void genetic_turn(void)
 			break;
 		case RSET:
 			if (destinationRoadScore) {
-				printf
+				genetic_print
 				    ("Building Road of RSET in the meantime...\n");
 				cb_build_road(road_edge);
 				return;
@@ -1987,7 +1992,7 @@ static void genetic_turn(void)
 			break;
 		case RRSET:
 			if (destinationLongRoadScore) {
-				printf
+				genetic_print
 				    ("Building Road of RRSET in the meantime...\n");
 				cb_build_road(long_road_edge);
 				return;
@@ -2038,10 +2043,50 @@ static void genetic_turn(void)
 			}
 		}
 	}
-	printf("Finishing my turn...\n");
+	genetic_print("Finishing my turn...\n");
 	cb_end_turn();
 }
 
+/*
+ * What to do? what to do?
+ *
+ */
+
+static void genetic_turn(void)
+{
+	guint i;
+
+	genetic_print("Entering genetic_turn...\n");
+
+	/* play soldier card before the turn when an own resource is blocked */
+	Hex *hex = map_robber_hex(callbacks.get_map());
+	if (hex && !have_rolled_dice() && can_play_any_develop()) {
+		const Deck *deck = get_devel_deck();
+		for (i = 0; i < deck_count(deck); i++) {
+			DevelType cardtype = deck_get_guint(deck, i);
+			if (cardtype == DEVEL_SOLDIER
+			    && can_play_develop(i)) {
+				int j;
+				for (j = 0; j < 6; j++) {
+					if (hex->nodes[j]->owner ==
+					    my_player_num()) {
+						cb_play_develop(i);
+						return;
+					}
+				}
+			}
+		}
+	}
+
+	if (!have_rolled_dice()) {
+		cb_roll();
+		return;
+	}
+
+	/* Don't wait before the dice roll, that will take too long */
+	ai_wait(genetic_turn_rolled);
+}
+
 
 static float score_node_hurt_opponents(Node * node)
 {
@@ -2103,7 +2148,6 @@ static void genetic_place_robber(void)
 	Hex *besthex = NULL;
 	Map *map = callbacks.get_map();
 
-	ai_wait();
 	for (i = 0; i < map->x_size; i++) {
 		for (j = 0; j < map->y_size; j++) {
 			Hex *hex = map_hex(map, i, j);
@@ -2192,8 +2236,9 @@ static void genetic_free_road(void)
  * We played a year of plenty card. pick the two resources we most need
  */
 
-static void genetic_year_of_plenty(const gint bank[NO_RESOURCE])
+static void genetic_year_of_plenty(void)
 {
+	const gint *bank = plenty_bank;
 	gint want[NO_RESOURCE];
 	gint assets[NO_RESOURCE];
 	int i;
@@ -2201,7 +2246,6 @@ static void genetic_year_of_plenty(const gint bank[NO_RESOURCE])
 	/* resource_values_t resval; */
 	struct gameState_t myGameState;
 
-	ai_wait();
 	for (i = 0; i < NO_RESOURCE; i++) {
 		want[i] = 0;
 		assets[i] = resource_asset(i);
@@ -2310,9 +2354,8 @@ static gint determine_monopoly_resource(void)
 	}
 }
 
-static void genetic_monopoly(void)
+static void genetic_choose_monopoly(void)
 {
-	ai_wait();
 	cb_choose_monopoly(determine_monopoly_resource());
 }
 
@@ -2428,10 +2471,12 @@ static int update_todiscard_resources(int totalDiscards, const struct chromosome
 	strategy_t thisStrategy;
 	float actualProfit;
 
-	printf("Resources:");
+	init_simulation(&thisSimulation);
+
+	genetic_print("Resources:");
 	for (i = 0; i < 5; i++)
-		printf(" %d ", resource_asset(i));
-	printf("\n");
+		genetic_print(" %d ", resource_asset(i));
+	genetic_print("\n");
 
 	int discards = 0;
 
@@ -2473,16 +2518,16 @@ static int update_todiscard_resources(int totalDiscards, const struct chromosome
 		todiscard[giveaway]++;
 		myGameState->resourcesAlreadyHave[giveaway]--;
 		discards++;
-		printf
+		genetic_print
 		    ("The discard number %d of the total %d I have to discard will be ",
 		     discards, totalDiscards);
 		printResource(giveaway);
-		printf(" (and now I have %d of it left)\n",
+		genetic_print(" (and now I have %d of it left)\n",
 		       myGameState->resourcesAlreadyHave[giveaway]);
 	}
 
 	if ((giveaway == -1) || (discards != totalDiscards))
-		printf("giveaway=-1!!! or wrong number of discards\n");
+		genetic_print("giveaway=-1!!! or wrong number of discards\n");
 	return (discards);
 	/* Should never get here */
 	g_assert_not_reached();
@@ -2505,12 +2550,12 @@ static void genetic_discard(int num)
 
 	update_todiscard_resources(num, &thisChromosome, &myGameState,
 				   todiscard);
-	printf("Resources:");
+	genetic_print("Resources:");
 	for (i = 0; i < 5; i++)
-		printf(" %d ", resource_asset(i));
-	printf("\n");
+		genetic_print(" %d ", resource_asset(i));
+	genetic_print("\n");
 	for (i = 0; i < NO_RESOURCE; i++)
-		printf("Resource %d discard %d\n", i, todiscard[i]);
+		genetic_print("Resource %d discard %d\n", i, todiscard[i]);
 
 	cb_discard(todiscard);
 }
@@ -2661,35 +2706,67 @@ static void genetic_consider_quote(G_GNUC_UNUSED gint partner,
 	log_message(MSG_INFO, "Quoting.\n");
 }
 
-static void genetic_setup(gint num_settlements, gint num_roads)
+static void genetic_setup_next(void)
 {
-	ai_wait();
-	if (num_settlements > 0)
+	if (setup_settlements > 0)
 		genetic_setup_house();
-	else if (num_roads > 0)
+	else if (setup_roads > 0)
 		genetic_setup_road();
 	else
 		cb_end_turn();
 }
 
-static void genetic_roadbuilding(gint num_roads)
+static void genetic_setup(gint num_settlements, gint num_roads)
 {
-	ai_wait();
-	if (num_roads > 0)
+	setup_settlements = num_settlements;
+	setup_roads = num_roads;
+	ai_wait(genetic_setup_next);
+}
+
+static void genetic_roadbuilding_next(void)
+{
+	if (free_roads > 0)
 		genetic_free_road();
 	else
 		cb_end_turn();
 }
 
+static void genetic_roadbuilding(gint num_roads)
+{
+	free_roads = num_roads;
+	ai_wait(genetic_roadbuilding_next);
+}
+
+static void genetic_discard_own(void)
+{
+	genetic_discard(discard_count);
+}
+
 static void genetic_discard_add(gint player_num, gint discard_num)
 {
 	ai_chat_discard(player_num, discard_num);
 	if (player_num == my_player_num()) {
-		ai_wait();
-		genetic_discard(discard_num);
+		discard_count = discard_num;
+		ai_wait(genetic_discard_own);
 	}
 }
 
+static void genetic_robber(void)
+{
+	ai_wait(genetic_place_robber);
+}
+
+static void genetic_plenty(const gint bank[NO_RESOURCE])
+{
+	memcpy(plenty_bank, bank, sizeof(plenty_bank));
+	ai_wait(genetic_year_of_plenty);
+}
+
+static void genetic_monopoly(void)
+{
+	ai_wait(genetic_choose_monopoly);
+}
+
 static void genetic_gold_choose(gint gold_num, const gint * bank)
 {
 	resource_values_t resval;
@@ -2739,39 +2816,43 @@ static void genetic_gold_choose(gint gold_num, const gint * bank)
 
 static void outputChromosome(void)
 {
-	int i, j;
-	for (i = 0; i <= 9; i++) {
-		for (j = 0; j <= 7; j++) {
-			printf("%.3f\t",
-			       thisChromosome.resourcesValueMatrix[i][j]);
-		}
-		printf("\n");
-	}
-	printf("%.3f\t%.3f\t%.3f\n", thisChromosome.depreciation_constant,
-	       thisChromosome.turn, thisChromosome.probability);
+	if (!ai_quiet)
+		chromosome_write(stdout, &thisChromosome);
+}
+
+/** Print the reasoning of the computer player, unless it should be quiet */
+void genetic_print(const char *format, ...)
+{
+	va_list ap;
+
+	if (ai_quiet)
+		return;
+	va_start(ap, format);
+	vprintf(format, ap);
+	va_end(ap);
 }
 
 static void genetic_game_over(gint player_num, G_GNUC_UNUSED gint points)
 {
 	if (player_num == my_player_num()) {
-		printf
+		genetic_print
 		    ("FINAL RESULT GENETIC: I won!  (%s) with %2d points using ",
 		     my_player_name(), player_get_score(my_player_num()));
 		if (default_chromosome_used) {
-			printf("DEFAULT\n");
+			genetic_print("DEFAULT\n");
 		} else
-			printf("%s\n", chromosomeFile);
+			genetic_print("%s\n", chromosomeFile);
 		outputChromosome();
 		/* AI chat when it wins */
 		ai_chat(N_("Yippie!"));
 	} else {
-		printf
+		genetic_print
 		    ("FINAL RESULT GENETIC: I lost! (%s) with %2d points using ",
 		     my_player_name(), player_get_score(my_player_num()));
 		if (default_chromosome_used) {
-			printf("DEFAULT\n");
+			genetic_print("DEFAULT\n");
 		} else
-			printf("%s\n", chromosomeFile);
+			genetic_print("%s\n", chromosomeFile);
 		outputChromosome();
 		/* AI chat when another player wins */
 		ai_chat(N_("My congratulations"));
@@ -2781,88 +2862,45 @@ static void genetic_game_over(gint player_num, G_GNUC_UNUSED gint points)
 
 static void genetic_init_game(void)
 {
-	int i, j;
 	struct chromosome_t tempChromosome;
 	FILE *chromFilePointer;
-	char line[80];
 
 	if (chromosomeFile == NULL) {
-		printf("No chromosome file specified, default used.\n");
+		genetic_print("No chromosome file specified, default used.\n");
 		return;
 	}
-	printf("Reading chromosome from file: %s\n", chromosomeFile);
+	genetic_print("Reading chromosome from file: %s\n", chromosomeFile);
 	if ((chromFilePointer = fopen(chromosomeFile, "r")) == NULL) {
-		printf
+		genetic_print
 		    ("Opening of chromosome file %s failed, default used\n",
 		     chromosomeFile);
 		return;
 	}
-	printf("Reading chromosome file: %s...\n", chromosomeFile);
-	for (i = 0; i <= 9; i++) {
-		if (fgets(line, 80, chromFilePointer) == NULL) {
-			printf
-			    ("Some values in the chromosome are missing! Using default then...\n");
-			fclose(chromFilePointer);
-			return;
-		}
-		if (sscanf
-		    (line, "%f %f %f %f %f %f %f %f",
-		     &tempChromosome.resourcesValueMatrix[i][0],
-		     &tempChromosome.resourcesValueMatrix[i][1],
-		     &tempChromosome.resourcesValueMatrix[i][2],
-		     &tempChromosome.resourcesValueMatrix[i][3],
-		     &tempChromosome.resourcesValueMatrix[i][4],
-		     &tempChromosome.resourcesValueMatrix[i][5],
-		     &tempChromosome.resourcesValueMatrix[i][6],
-		     &tempChromosome.resourcesValueMatrix[i][7]) != 8) {
-			printf
-			    ("Some values in the chromosome are missing! Using default then...\n");
-			fclose(chromFilePointer);
-			return;
-		}
-		printf("%s", line);
-	}
-	if (fgets(line, 80, chromFilePointer) == NULL) {
-		printf
+	genetic_print("Reading chromosome file: %s...\n", chromosomeFile);
+	if (!chromosome_read(chromFilePointer, &tempChromosome)) {
+		genetic_print
 		    ("Some values in the chromosome are missing! Using default then...\n");
 		fclose(chromFilePointer);
 		return;
 	}
-	if (sscanf
-	    (line, "%f %f %f", &(tempChromosome.depreciation_constant),
-	     &(tempChromosome.turn), &(tempChromosome.probability)) != 3) {
-		printf
-		    ("Some values in the chromosome are missing! Using default then...\n");
-		fclose(chromFilePointer);
-		return;
-	}
-	printf("%s", line);
-	printf("Finishing reading the chromosome\n");
+	genetic_print("Finishing reading the chromosome\n");
 	fclose(chromFilePointer);
 	default_chromosome_used = FALSE;
-	for (i = 0; i <= 9; i++) {
-		for (j = 0; j <= 7; j++) {
-			thisChromosome.resourcesValueMatrix[i][j] =
-			    tempChromosome.resourcesValueMatrix[i][j];
-		}
-	}
-	thisChromosome.depreciation_constant =
-	    tempChromosome.depreciation_constant;
-	thisChromosome.turn = tempChromosome.turn;
-	thisChromosome.probability = tempChromosome.probability;
-
-
-	return;
+	thisChromosome = tempChromosome;
+	outputChromosome();
 }
 
 void genetic_init(void)
 {
+	thisChromosome = default_chromosome;
+	default_chromosome_used = TRUE;
+
 	callbacks.setup = &genetic_setup;
 	callbacks.turn = &genetic_turn;
-	callbacks.robber = &genetic_place_robber;
+	callbacks.robber = &genetic_robber;
 	callbacks.steal_building = &genetic_steal_building;
 	callbacks.roadbuilding = &genetic_roadbuilding;
-	callbacks.plenty = &genetic_year_of_plenty;
+	callbacks.plenty = &genetic_plenty;
 	callbacks.monopoly = &genetic_monopoly;
 	callbacks.discard_add = &genetic_discard_add;
 	callbacks.quote_start = &genetic_quote_start;
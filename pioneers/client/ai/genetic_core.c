@@ -21,6 +21,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <math.h>
+#include <string.h>
 #include <glib.h>
 #include "genetic_core.h"
 
@@ -30,15 +31,6 @@ static float totalAverageResourceSupplyPerTurn(const struct gameState_t
 static float depreciateStrategyValue(int num_resources, int num_players,
 				     float ARSperTurn);
 static float depreciationFunction(float k, int actualARS, int port);
-static int enoughResources(int sim, int act,
-			   struct simulationsData_t *Data);
-static void updateSimulation(int sim, float probability,
-			     struct simulationsData_t *Data);
-static void updateConditionsMet(float probability,
-				struct simulationsData_t *Data);
-static void updateTurnsToAction(float probability, int currentTurn,
-				struct simulationsData_t *Data);
-//static void outputSims(int number, int turn, struct simulationsData_t *Data);
 static void set_timeCombinedAction(struct simulationsData_t *Data);
 static void numberOfTurnsForProbability(float probability,
 					struct simulationsData_t *Data,
@@ -49,7 +41,12 @@ static float strategyProfit(float time_a, float time_b, float turn,
 			    struct gameState_t myGameState, int myTurn,
 			    int num_players);
 
-static int resourcesNeededForAction[NUM_ACTIONS][5] = {
+/** Number of simulations that are run together */
+#define SIM_BLOCK 64
+/** The bits of conditionsMet when all actions can be performed */
+#define ALL_ACTIONS ((1u << NUM_ACTIONS) - 1)
+
+static const int resourcesNeededForAction[NUM_ACTIONS][5] = {
 /*Resources of every type needed to perform every action possible */
 	{ 1, 1, 0, 1, 1 },	/*SET */
 	{ 0, 2, 3, 0, 0 },	/*CIT */
@@ -202,19 +199,19 @@ void printAction(enum action oneAction)
 {
 	switch (oneAction) {
 	case 0:
-		printf("Settlement");
+		genetic_print("Settlement");
 		break;
 	case 1:
-		printf("City");
+		genetic_print("City");
 		break;
 	case 2:
-		printf("Development Card");
+		genetic_print("Development Card");
 		break;
 	case 3:
-		printf("Road to Settlement");
+		genetic_print("Road to Settlement");
 		break;
 	case 4:
-		printf("Long Road to Settlement");
+		genetic_print("Long Road to Settlement");
 		break;
 	}
 }
@@ -223,115 +220,23 @@ void printResource(int resource)
 {
 	switch (resource) {
 	case 0:
-		printf("Brick");
+		genetic_print("Brick");
 		break;
 	case 1:
-		printf("Grain");
+		genetic_print("Grain");
 		break;
 	case 2:
-		printf("Ore");
+		genetic_print("Ore");
 		break;
 	case 3:
-		printf("Wool");
+		genetic_print("Wool");
 		break;
 	case 4:
-		printf("Lumber");
+		genetic_print("Lumber");
 		break;
 	}
 }
 
-int enoughResources(int sim, int act, struct simulationsData_t *Data)
-{
-	/*Returns TRUE if there are enough resources in simulation sim to perform action action */
-	int resource;
-	for (resource = 0; resource < 5; resource++) {	/*Check for every type of resource */
-		if (Data->resourcesPool[sim][resource] <
-		    resourcesNeededForAction[act][resource])
-			return (0);
-	}
-	return (1);
-}
-
-void updateSimulation(int sim, float probability,
-		      struct simulationsData_t *Data)
-{
-	/*Checks resourcesPool to update conditionsMet for that simulation for every action and numberOfSimulationsOK */
-	int act;
-	for (act = 0; act < NUM_ACTIONS; act++) {
-		if ((Data->numberOfSimulationsOK[act] <
-		     (MAX_SIMS * probability))
-		    && (Data->conditionsMet[sim][act] != 1)) {
-			/*If there already are enough simulations OK for this action or conditions were already met it doesn't need to check again */
-			if (enoughResources(sim, act, Data)) {
-				Data->conditionsMet[sim][act] = 1;
-				Data->numberOfSimulationsOK[act]++;
-			}
-		}
-	}
-}
-
-void updateConditionsMet(float probability, struct simulationsData_t *Data)
-{
-	/*Update every simulation in conditionsMet */
-	/*We need probability in order to avoid checking for actions unnecessarily */
-	int sim;
-	for (sim = 0; sim < MAX_SIMS; sim++) {
-		updateSimulation(sim, probability, Data);
-	}
-	/*At this point numberOfSimulationsOK will hold, for every action, the number of simulations that, up to the turn calculated, meet the requirements to do it */
-}
-
-void updateTurnsToAction(float probability, int currentTurn,
-			 struct simulationsData_t *Data)
-{
-	/*If the percentage of simulations OK for an action is over probability will set turnsToAction for that action to turn */
-	int act;
-	for (act = 0; act < NUM_ACTIONS; act++) {
-		if ((Data->turnsToAction[act] == MAX_TURNS) &&	/*It will set only the first time it reaches probability */
-		    (Data->numberOfSimulationsOK[act] >=
-		     MAX_SIMS * probability))
-			Data->turnsToAction[act] = currentTurn;
-	}
-}
-
-#if 0
-
-/*This should be rewritten in order to take account of the order change in resources (Now it should go Br,Gr,Or,Wo and Lu)*/
-
-void outputSims(int number, int turn, struct simulationsData_t *Data)
-{
-	int resource, act, simulation;
-
-	//system("clear");
-	printf
-	    ("BRICK\tLUMBER\tGRAIN\tWOOL\tORE\t\tSET\tCIT\tDEV\tRSET\tRRSET\tS+SET\tS+CIT\tS+DEV\tS+RSET\tS+RRSET\tC+CIT\tC+DEV\tC+RSET\tC+RRSET\tD+DEV\tD+RSET\tD+RRSET\tR+RSET\tR+RRSET\tRR+RRSET\n");
-	for (simulation = 0; simulation < number; simulation++) {
-		for (resource = 0; resource < 5; resource++) {
-			printf("%d\t",
-			       Data->resourcesPool[simulation][resource]);
-		}
-		printf("\t");
-		for (act = 0; act < NUM_ACTIONS; act++) {
-			printf("%d\t",
-			       Data->conditionsMet[simulation][act]);
-		}
-		printf("\n");
-	}
-	printf
-	    ("BRICK\tLUMBER\tGRAIN\tWOOL\tORE\t\tSET\tCIT\tDEV\tRSET\tRRSET\tS+SET\tS+CIT\tS+DEV\tS+RSET\tS+RRSET\tC+CIT\tC+DEV\tC+RSET\tC+RRSET\tD+DEV\tD+RSET\tD+RRSET\tR+RSET\tR+RRSET\tRR+RRSET\n");
-	printf("\nNumber of Simulations OK for every action->");
-	for (act = 0; act < NUM_ACTIONS; act++) {
-		printf("\t%d", Data->numberOfSimulationsOK[act]);
-	}
-	printf("\nTurns to Action for every action->\t");
-	for (act = 0; act < NUM_ACTIONS; act++) {
-		printf("\t%d", Data->turnsToAction[act]);
-	}
-	printf("\n");
-	printf("Turn %d\n", turn);
-}
-#endif
-
 void set_timeCombinedAction(struct simulationsData_t *Data)
 {
 	/*      Puts the information of turnsToAction in a way that is easier to access from bestStrategy procedure
@@ -369,81 +274,151 @@ void set_timeCombinedAction(struct simulationsData_t *Data)
 	Data->timeCombinedAction[4][4] = Data->turnsToAction[19];
 }
 
+/** Random number generator of one simulation (xorshift) */
+static inline guint32 simulationRandom(guint32 * state)
+{
+	guint32 x = *state;
+
+	x ^= x << 13;
+	x ^= x >> 17;
+	x ^= x << 5;
+	*state = x;
+	return x;
+}
+
+static void simulateBlock(int num, struct simulationsData_t *Data,
+			  const struct gameState_t *myGameState,
+			  int firstTurn[NUM_ACTIONS][MAX_TURNS + 1])
+{
+	/* Simulates num games at the same time and counts in firstTurn, for every action, in which turn the resources to perform it were
+	 * collected for the first time. The resources are kept per type in a lane of num simulations, and conditionsMet holds one bit for
+	 * every action. As resources only increase, an action that can be performed once can be performed in all later turns. */
+	gint resourcesPool[5][SIM_BLOCK];
+	guint32 conditionsMet[SIM_BLOCK];
+	guint32 randomState[SIM_BLOCK];
+	guint8 dice_roll[SIM_BLOCK];
+	gint supply[11];
+	int simulation, resource, act, currentTurn, open;
+
+	for (simulation = 0; simulation < num; simulation++) {
+		/* xorshift must not start at 0 */
+		randomState[simulation] = g_rand_int(Data->rand) | 1u;
+		conditionsMet[simulation] = 0;
+	}
+	for (resource = 0; resource < 5; resource++)
+		for (simulation = 0; simulation < num; simulation++)
+			resourcesPool[resource][simulation] =
+			    myGameState->resourcesAlreadyHave[resource];
+
+	open = num;		/* Simulations in which not all actions can be performed yet */
+	for (currentTurn = 0; currentTurn <= MAX_TURNS && open > 0;
+	     currentTurn++) {
+		if (currentTurn > 0) {
+			/* Roll both dice with one random number, dice_roll is the index in resourcesSupply */
+			for (simulation = 0; simulation < num; simulation++) {
+				guint32 x =
+				    simulationRandom(&randomState
+						     [simulation]);
+				dice_roll[simulation] =
+				    (guint8) ((((x & 0xffff) * 6u) >> 16) +
+					      (((x >> 16) * 6u) >> 16));
+			}
+			for (resource = 0; resource < 5; resource++) {
+				for (act = 0; act < 11; act++)
+					supply[act] =
+					    myGameState->resourcesSupply
+					    [act][resource];
+				for (simulation = 0; simulation < num;
+				     simulation++)
+					resourcesPool[resource][simulation] +=
+					    supply[dice_roll[simulation]];
+			}
+		}
+		for (simulation = 0; simulation < num; simulation++) {
+			guint32 possible = 0;
+			guint32 newlyMet;
+
+			if (conditionsMet[simulation] == ALL_ACTIONS)
+				continue;
+			for (act = 0; act < NUM_ACTIONS; act++) {
+				const int *need = resourcesNeededForAction[act];
+				guint32 ok =
+				    (resourcesPool[0][simulation] >= need[0])
+				    & (resourcesPool[1][simulation] >=
+				       need[1])
+				    & (resourcesPool[2][simulation] >=
+				       need[2])
+				    & (resourcesPool[3][simulation] >=
+				       need[3])
+				    & (resourcesPool[4][simulation] >=
+				       need[4]);
+				possible |= ok << act;
+			}
+			newlyMet = possible & ~conditionsMet[simulation];
+			if (newlyMet == 0)
+				continue;
+			conditionsMet[simulation] |= newlyMet;
+			for (act = g_bit_nth_lsf(newlyMet, -1); act >= 0;
+			     act = g_bit_nth_lsf(newlyMet, act))
+				firstTurn[act][currentTurn]++;
+			if (conditionsMet[simulation] == ALL_ACTIONS)
+				open--;
+		}
+	}
+}
+
 void numberOfTurnsForProbability(float probability,
 				 struct simulationsData_t *Data,
 				 struct gameState_t myGameState,
 				 int showSimulation)
 {
 	/* Sets turnsToAction values to the number of turns needed to have a certain probability to get the resources needed to perform each NUM_ACTIONS possible actions
-	 * It does so by simulating MAX_SIMS times the dice outcomes of a single turn and checking how many of those simulations would fulfill the requirements of
-	 * resourcesNeededForAction of every action, and updating numberOfSimulationsOK and conditionsMet matrix consequently
+	 * It does so by simulating the dice outcomes of up to MAX_TURNS turns many times and counting how many of those simulations would fulfill the requirements of
+	 * resourcesNeededForAction of every action in every turn.
 	 * When the percentage of simulations that meet the requirements for a certain action is over probability, then it means that given that amount of turns,
 	 * then that percentage of simulations would fulfill those requirements, and it will set that number of turns for that action in turnsToAction.
 	 * At the end of the process turnsToAction will hold the number of turns needed for every possible action to be performed with the required probability.
-	 * The number of simulations MAX_SIMS could be easily increased in order to get a more accurate simulation process*/
-
-	int currentTurn = 0;
-	int simulation;
-	int dice_roll1, dice_roll2, dice_roll;
-	int i, j;
-
-	/*Initialize Data->resourcesPool to resourcesAlreadyHave[] for every resource and conditionsMet to FALSE for every action */
-	for (i = 0; i < MAX_SIMS; i++) {
-		for (j = 0; j < 5; j++) {
-			Data->resourcesPool[i][j] =
-			    myGameState.resourcesAlreadyHave[j];
-		}
-		for (j = 0; j < NUM_ACTIONS; j++) {
-			Data->conditionsMet[i][j] = 0;
+	 * The simulations are run in blocks of SIM_BLOCK, until Data->numberOfSimulations are run or, when it is set, Data->timeBudget has passed*/
+
+	int firstTurn[NUM_ACTIONS][MAX_TURNS + 1];
+	int wanted;
+	gint64 start;
+	int currentTurn, act, count;
+
+	memset(firstTurn, 0, sizeof(firstTurn));
+	wanted = Data->numberOfSimulations;
+	if (wanted < 1)
+		wanted = DEFAULT_SIMULATIONS;
+	start = g_get_monotonic_time();
+	Data->simulationsRun = 0;
+	do {
+		int num = SIM_BLOCK;
+
+		if (Data->timeBudget <= 0)
+			num = MIN(num, wanted - Data->simulationsRun);
+		simulateBlock(num, Data, &myGameState, firstTurn);
+		Data->simulationsRun += num;
+	} while (Data->timeBudget > 0 ?
+		 g_get_monotonic_time() - start <
+		 (gint64) Data->timeBudget * 1000 :
+		 Data->simulationsRun < wanted);
+
+	/*Check for every action when it is OK enough times and set turnsToAction for that action to that turn */
+	for (act = 0; act < NUM_ACTIONS; act++) {
+		Data->turnsToAction[act] = MAX_TURNS;
+		count = 0;
+		for (currentTurn = 0; currentTurn <= MAX_TURNS; currentTurn++) {
+			count += firstTurn[act][currentTurn];
+			if ((Data->turnsToAction[act] == MAX_TURNS)
+			    && (count >= Data->simulationsRun * probability))
+				Data->turnsToAction[act] = currentTurn;
 		}
+		Data->numberOfSimulationsOK[act] = count;
 	}
-	/*Init turnsToAction to the maximum and numberOfSimulationsOK to 0  */
-	for (i = 0; i < NUM_ACTIONS; i++) {
-		Data->turnsToAction[i] = MAX_TURNS;
-		Data->numberOfSimulationsOK[i] = 0;
-	}
-	updateConditionsMet(probability, Data);	/*Some conditions could already be met at the beginning */
-	updateTurnsToAction(probability, currentTurn, Data);
-	if (showSimulation) {
-		/*
-		   outputSims(30, currentTurn, Data);
-		   printf("Press any key to run the simulation");
-		   getchar();
-		 */
-	}
-
-	/*Just to avoid the warning */
-	/*srandom(time(NULL)); */
-	while (currentTurn < MAX_TURNS) {	/*It will simulate up to MAX_TURNS-1 for simplicity sake. */
-		/*Should it be optimized? What is the chance of being able to perform everything in a number of turns before the maximum? Maybe with a very low level of probability and under
-		 *certain circumstances, but very uncommon in any case.*/
-		currentTurn++;
-		for (simulation = 0; simulation < MAX_SIMS; simulation++) {
-			/* For every simulation it rolls the dice and increases its resources accordingly */
-			dice_roll1 = g_random_int_range(1, 7);	/*(random() % 6) + 1; */
-			dice_roll2 = g_random_int_range(1, 7);	/*(random() % 6) + 1; */
-			dice_roll = dice_roll1 + dice_roll2;
-			/*printf("\n(%d+%d)=%d\n ",dice_roll1,dice_roll2,dice_roll); */
-			/*updates resourcesPool for this simulation */
-			for (i = 0; i <= 4; i++) {
-				Data->resourcesPool[simulation][i] =
-				    Data->resourcesPool[simulation][i] +
-				    myGameState.resourcesSupply[dice_roll -
-								2][i];
-				/*printResource(i);printf("+%d=",resourcesSupply[dice_roll-2][i]);printf("%d ",Data->resourcesPool[simulation][i]); */
-			}
-		}
-		/*End of all the simulations for this turn, all simulations have their resourcesPool resources updated according to their dice rolls.
-		 *Now check for every simulation if conditions are met and update it, and numberOfSimulationsOK accordingly*/
-		updateConditionsMet(probability, Data);
-		/*Check for every action if it is OK enough times and update turnsToAction for that action to turn if needed */
-		updateTurnsToAction(probability, currentTurn, Data);
-		/*
-		   if (showSimulation) {
-		   outputSims(30, currentTurn, Data);
-
-		   } */
-	}			/*while */
+	if (showSimulation)
+		genetic_print("%d simulations in %.3f s\n",
+			      Data->simulationsRun,
+			      (g_get_monotonic_time() - start) / 1e6);
 	set_timeCombinedAction(Data);
 	return;
 }
@@ -479,24 +454,24 @@ float strategyProfit(float time_a, float time_b, float turn,
 					    num_players, ARSperTurn);
 
 #if 0
-		printf
+		genetic_print
 		    ("My estimation is that I WILL BUILD %d ROADS at this turn as part of the following strategy:\n",
 		     roadsWillBuild);
 		if (tooManyResDepreciation < 1) {
-			printf("Strategy waiting to do ");
+			genetic_print("Strategy waiting to do ");
 			printAction(oneStrategy[0]);
-			printf(" at turn %.2f and then ", time_a);
+			genetic_print(" at turn %.2f and then ", time_a);
 			printAction(oneStrategy[1]);
-			printf
+			genetic_print
 			    (" ends turn with too many resources (%d and ARSperTurn of %.2f), so suffers a depreciation of %.3f\n",
 			     endOfTurnResources, ARSperTurn,
 			     tooManyResDepreciation);
 		} else {
-			printf("Strategy waiting to do ");
+			genetic_print("Strategy waiting to do ");
 			printAction(oneStrategy[0]);
-			printf(" at turn %.2f and then ", time_a);
+			genetic_print(" at turn %.2f and then ", time_a);
 			printAction(oneStrategy[1]);
-			printf
+			genetic_print
 			    (" ends turn unaffected (%d and ARSperTurn of %.2f), so suffers no depreciation\n",
 			     endOfTurnResources, ARSperTurn);
 		}
@@ -639,3 +614,49 @@ int checkRoadNow(enum action firstAction, enum action secondAction,
 		return (0);
 	}
 }
+
+gboolean chromosome_read(FILE * stream, struct chromosome_t *chromosome)
+{
+	char line[80];
+	int i;
+
+	for (i = 0; i <= 9; i++) {
+		if (fgets(line, sizeof(line), stream) == NULL)
+			return FALSE;
+		if (sscanf
+		    (line, "%f %f %f %f %f %f %f %f",
+		     &chromosome->resourcesValueMatrix[i][0],
+		     &chromosome->resourcesValueMatrix[i][1],
+		     &chromosome->resourcesValueMatrix[i][2],
+		     &chromosome->resourcesValueMatrix[i][3],
+		     &chromosome->resourcesValueMatrix[i][4],
+		     &chromosome->resourcesValueMatrix[i][5],
+		     &chromosome->resourcesValueMatrix[i][6],
+		     &chromosome->resourcesValueMatrix[i][7]) != 8)
+			return FALSE;
+	}
+	if (fgets(line, sizeof(line), stream) == NULL)
+		return FALSE;
+	if (sscanf
+	    (line, "%f %f %f", &chromosome->depreciation_constant,
+	     &chromosome->turn, &chromosome->probability) != 3)
+		return FALSE;
+	return TRUE;
+}
+
+void chromosome_write(FILE * stream, const struct chromosome_t *chromosome)
+{
+	int i, j;
+
+	/* The lines must fit in the buffer of chromosome_read */
+	for (i = 0; i <= 9; i++) {
+		for (j = 0; j <= 7; j++) {
+			fprintf(stream, "%.4f%c",
+				chromosome->resourcesValueMatrix[i][j],
+				j < 7 ? '\t' : '\n');
+		}
+	}
+	fprintf(stream, "%.4f\t%.4f\t%.4f\n",
+		chromosome->depreciation_constant, chromosome->turn,
+		chromosome->probability);
+}
@@ -21,8 +21,11 @@
 #ifndef genetic_core_h
 #define genetic_core_h
 
-/** Number of simulations, could be raised to achieve better accuracy if computing time allows it*/
-#define MAX_SIMS 100
+#include <stdio.h>
+#include <glib.h>
+
+/** Default number of simulations, can be raised to achieve better accuracy if computing time allows it*/
+#define DEFAULT_SIMULATIONS 100
 /** Number of possible actions, single or paired -> 5 individual (SET,CIT,DEV, RSET RRSET) + 5*5 combined (SET+CIT,SET+DEV,etc) -10 of which are redundant (SET+CIT=CIT+SET) = 20 */
 #define NUM_ACTIONS 20
 #define MAX_TURNS 100
@@ -38,17 +41,17 @@ struct tradingMatrixes_t {
 	tradingMatrix_t genericResource;	/* 3:1 trade through generic port */
 };
 
-/** A structure of type simulationsData will be used to hold the data of the MAX_SIMS simulations*/
+/** A structure of type simulationsData will be used to hold the budget and the results of the simulations
+ * Possible actions are SET,CIT,DEV,RSET,RRSET, SET+SET,SET+CIT,SET+DEV...,CIT+SET,CIT+CIT,...RRSET+RSET,RRSET+RRSET
+ * 5 independent actions+15 combined pairs of actions, in the order of resourcesNeededForAction*/
 struct simulationsData_t {
-	int resourcesPool[MAX_SIMS][5];	/* Resources for every simulation */
-	int conditionsMet[MAX_SIMS][NUM_ACTIONS];
-	/* Boolean matrix that will hold true for every simulation that meets the requirements of certain action
-	 * Possible actions are SET,CIT,DEV,RSET,RRSET, SET+SET,SET+CIT,SET+DEV...,CIT+SET,CIT+CIT,...RRSET+RSET,RRSET+RRSET
-	 * 5 independent actions+15 combined pairs of actions.
-	 * It is important to note that the order in which actions are represented in conditionsMet should match the order they are in resourcesNeededForAction*/
-	int numberOfSimulationsOK[NUM_ACTIONS];	/* Number of simulations that meet the requirementS for every action */
+	int numberOfSimulations;	/* Number of simulations to run, when there is no timeBudget */
+	int timeBudget;		/* When positive, run simulations for this many milliseconds instead */
+	int simulationsRun;	/* Number of simulations that were run */
+	int numberOfSimulationsOK[NUM_ACTIONS];	/* Number of simulations that meet the requirements for every action within MAX_TURNS */
 	int turnsToAction[NUM_ACTIONS];	/* Number of turns needed for every action or pair of actions to reach the required probability of getting its resources */
 	int timeCombinedAction[5][5];	/* It will hold the data of turnsToAction regarding combined actions, it is for ease of access, this information is already hold in turnsToAction */
+	GRand *rand;		/* Random number generator for the dice rolls */
 };
 
 /** A structure of type gameState_t will hold the information of my actual state in the game
@@ -67,6 +70,26 @@ struct chromosome_t {
 	float probability;	/* it will calculate how many turns it needs to perform something with this level of confidence, 0<probability<1 */
 };
 
+/** The chromosome that is used when no chromosome file is given */
+extern const struct chromosome_t default_chromosome;
+
+/** Read a chromosome, in the format of chromosome_write.
+ * @param stream The file to read from
+ * @retval chromosome The chromosome that was read
+ * @return TRUE if all values were read
+ */
+gboolean chromosome_read(FILE * stream, struct chromosome_t *chromosome);
+/** Write a chromosome: one line with the resourcesValueMatrix for each
+ * number of victory points, then the depreciation constant, the turn and
+ * the probability on one line.
+ * @param stream The file to write to
+ * @param chromosome The chromosome
+ */
+void chromosome_write(FILE * stream, const struct chromosome_t *chromosome);
+
+/** Print the reasoning of the computer player, like printf */
+void genetic_print(const char *format, ...) G_GNUC_PRINTF(1, 2);
+
 int actualAverageResourcesSupply(int resource,
 				 const struct gameState_t *myGameState);
 float resourcesIncrementValue(int increment, int resource,
@@ -23,8 +23,10 @@
 #include "config.h"
 #include "ai.h"
 #include "cost.h"
+#include "node_cache.h"
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 /*
  * This is a rudimentary AI for Pioneers.
  *
@@ -42,7 +44,13 @@ typedef struct resource_values_s {
 	gint ports[NO_RESOURCE];
 } resource_values_t;
 
-static int quote_num;
+static THREAD_LOCAL int quote_num;
+/* The arguments of the callbacks, for the decisions after the delay */
+static THREAD_LOCAL gint setup_settlements;
+static THREAD_LOCAL gint setup_roads;
+static THREAD_LOCAL gint free_roads;
+static THREAD_LOCAL gint discard_count;
+static THREAD_LOCAL gint plenty_bank[NO_RESOURCE];
 
 /* things we can buy, in the order that we want them. */
 typedef enum {
@@ -77,37 +85,23 @@ static gint determine_monopoly_resource(void);
 
 typedef struct node_seen_set_s {
 
-	Node *seen[MAP_SIZE * MAP_SIZE];
-	int size;
+	guint32 seen[MAP_SET_WORDS(MAP_SIZE * MAP_SIZE * 6)];
 
 } node_seen_set_t;
 
 static void nodeset_reset(node_seen_set_t * set)
 {
-	set->size = 0;
+	memset(set->seen, 0, sizeof(set->seen));
 }
 
 static void nodeset_set(node_seen_set_t * set, Node * n)
 {
-	int i;
-
-	for (i = 0; i < set->size; i++)
-		if (set->seen[i] == n)
-			return;
-
-	set->seen[set->size] = n;
-	set->size++;
+	MAP_SET_ADD(set->seen, n->id);
 }
 
 static int nodeset_isset(node_seen_set_t * set, Node * n)
 {
-	int i;
-
-	for (i = 0; i < set->size; i++)
-		if (set->seen[i] == n)
-			return 1;
-
-	return 0;
+	return MAP_SET_TEST(set->seen, n->id);
 }
 
 typedef void iterate_node_func_t(Node * n, void *rock);
@@ -348,8 +342,8 @@ static void reevaluate_resources(resource_values_t * outval)
 	/*
 	 * Save the maritime info too so we know if we can do port trades
 	 */
-	map_maritime_info(callbacks.get_map(), &outval->info,
-			  my_player_num());
+	port_index_maritime_info(get_port_index(), &outval->info,
+				 my_player_num());
 
 	for (i = 0; i < NO_RESOURCE; i++) {
 		if (outval->info.specific_resource[i])
@@ -430,20 +424,25 @@ static float score_node(const Node * node, gboolean city,
 	/* if not a node, how did this happen? */
 	g_assert(node != NULL);
 
+	/* Besides the node and its neighbours, only the resource values
+	 * are used */
+	node_cache_set_inputs(resval, sizeof(*resval));
+	if (node_cache_lookup(node, city, &score))
+		return score;
+
 	/* if already occupied, in water, or too close to others  give a score of -1 */
 	if (is_node_on_land(node) == FALSE)
-		return -1;
-	if (is_node_spacing_ok(node) == FALSE)
-		return -1;
-	if (!city) {
-		if (node->owner != -1)
-			return -1;
-	}
-
-	for (i = 0; i < 3; i++) {
-		score += score_hex(node->hexes[i], resval);
-	}
+		score = -1;
+	else if (is_node_spacing_ok(node) == FALSE)
+		score = -1;
+	else if (!city && node->owner != -1)
+		score = -1;
+	else
+		for (i = 0; i < 3; i++) {
+			score += score_hex(node->hexes[i], resval);
+		}
 
+	node_cache_store(node, city, score);
 	return score;
 }
 
@@ -1156,44 +1155,13 @@ static gboolean will_play_development_card(DevelType cardtype)
 	return FALSE;
 }
 
-/*
- * What to do? what to do?
- *
- */
-
-static void greedy_turn(void)
+/** The part of the turn after the dice have been rolled */
+static void greedy_turn_rolled(void)
 {
 	resource_values_t resval;
 	guint i;
 	gint need[NO_RESOURCE], assets[NO_RESOURCE];
 
-	/* play soldier card before the turn when an own resource is blocked */
-	Hex *hex = map_robber_hex(callbacks.get_map());
-	if (hex && !have_rolled_dice() && can_play_any_develop()) {
-		const Deck *deck = get_devel_deck();
-		for (i = 0; i < deck_count(deck); i++) {
-			DevelType cardtype = deck_get_guint(deck, i);
-			if (cardtype == DEVEL_SOLDIER
-			    && can_play_develop(i)) {
-				int j;
-				for (j = 0; j < 6; j++) {
-					if (hex->nodes[j]->owner ==
-					    my_player_num()) {
-						cb_play_develop(i);
-						return;
-					}
-				}
-			}
-		}
-	}
-
-	if (!have_rolled_dice()) {
-		cb_roll();
-		return;
-	}
-
-	/* Don't wait before the dice roll, that will take too long */
-	ai_wait();
 	for (i = 0; i < NO_RESOURCE; ++i)
 		assets[i] = resource_asset(i);
 
@@ -1297,6 +1265,44 @@ static void greedy_turn(void)
 	cb_end_turn();
 }
 
+/*
+ * What to do? what to do?
+ *
+ */
+
+static void greedy_turn(void)
+{
+	guint i;
+
+	/* play soldier card before the turn when an own resource is blocked */
+	Hex *hex = map_robber_hex(callbacks.get_map());
+	if (hex && !have_rolled_dice() && can_play_any_develop()) {
+		const Deck *deck = get_devel_deck();
+		for (i = 0; i < deck_count(deck); i++) {
+			DevelType cardtype = deck_get_guint(deck, i);
+			if (cardtype == DEVEL_SOLDIER
+			    && can_play_develop(i)) {
+				int j;
+				for (j = 0; j < 6; j++) {
+					if (hex->nodes[j]->owner ==
+					    my_player_num()) {
+						cb_play_develop(i);
+						return;
+					}
+				}
+			}
+		}
+	}
+
+	if (!have_rolled_dice()) {
+		cb_roll();
+		return;
+	}
+
+	/* Don't wait before the dice roll, that will take too long */
+	ai_wait(greedy_turn_rolled);
+}
+
 static float score_node_hurt_opponents(Node * node)
 {
 	/* no building there */
@@ -1357,7 +1363,6 @@ static void greedy_place_robber(void)
 	Hex *besthex = NULL;
 	Map *map = callbacks.get_map();
 
-	ai_wait();
 	for (i = 0; i < map->x_size; i++) {
 		for (j = 0; j < map->y_size; j++) {
 			Hex *hex = map_hex(map, i, j);
@@ -1439,15 +1444,15 @@ static void greedy_free_road(void)
  * We played a year of plenty card. pick the two resources we most need
  */
 
-static void greedy_year_of_plenty(const gint bank[NO_RESOURCE])
+static void greedy_year_of_plenty(void)
 {
+	const gint *bank = plenty_bank;
 	gint want[NO_RESOURCE];
 	gint assets[NO_RESOURCE];
 	int i;
 	int r1, r2;
 	resource_values_t resval;
 
-	ai_wait();
 	for (i = 0; i < NO_RESOURCE; i++) {
 		want[i] = 0;
 		assets[i] = resource_asset(i);
@@ -1548,9 +1553,8 @@ static gint determine_monopoly_resource(void)
 	}
 }
 
-static void greedy_monopoly(void)
+static void greedy_choose_monopoly(void)
 {
-	ai_wait();
 	cb_choose_monopoly(determine_monopoly_resource());
 }
 
@@ -1794,35 +1798,67 @@ static void greedy_consider_quote(G_GNUC_UNUSED gint partner,
 	log_message(MSG_INFO, "Quoting.\n");
 }
 
-static void greedy_setup(gint num_settlements, gint num_roads)
+static void greedy_setup_next(void)
 {
-	ai_wait();
-	if (num_settlements > 0)
+	if (setup_settlements > 0)
 		greedy_setup_house();
-	else if (num_roads > 0)
+	else if (setup_roads > 0)
 		greedy_setup_road();
 	else
 		cb_end_turn();
 }
 
-static void greedy_roadbuilding(gint num_roads)
+static void greedy_setup(gint num_settlements, gint num_roads)
 {
-	ai_wait();
-	if (num_roads > 0)
+	setup_settlements = num_settlements;
+	setup_roads = num_roads;
+	ai_wait(greedy_setup_next);
+}
+
+static void greedy_roadbuilding_next(void)
+{
+	if (free_roads > 0)
 		greedy_free_road();
 	else
 		cb_end_turn();
 }
 
+static void greedy_roadbuilding(gint num_roads)
+{
+	free_roads = num_roads;
+	ai_wait(greedy_roadbuilding_next);
+}
+
+static void greedy_discard_own(void)
+{
+	greedy_discard(discard_count);
+}
+
 static void greedy_discard_add(gint player_num, gint discard_num)
 {
 	ai_chat_discard(player_num, discard_num);
 	if (player_num == my_player_num()) {
-		ai_wait();
-		greedy_discard(discard_num);
+		discard_count = discard_num;
+		ai_wait(greedy_discard_own);
 	}
 }
 
+static void greedy_robber(void)
+{
+	ai_wait(greedy_place_robber);
+}
+
+static void greedy_plenty(const gint bank[NO_RESOURCE])
+{
+	memcpy(plenty_bank, bank, sizeof(plenty_bank));
+	ai_wait(greedy_year_of_plenty);
+}
+
+static void greedy_monopoly(void)
+{
+	ai_wait(greedy_choose_monopoly);
+}
+
 static void greedy_gold_choose(gint gold_num, const gint * bank)
 {
 	resource_values_t resval;
@@ -1869,10 +1905,10 @@ void greedy_init(void)
 {
 	callbacks.setup = &greedy_setup;
 	callbacks.turn = &greedy_turn;
-	callbacks.robber = &greedy_place_robber;
+	callbacks.robber = &greedy_robber;
 	callbacks.steal_building = &greedy_steal_building;
 	callbacks.roadbuilding = &greedy_roadbuilding;
-	callbacks.plenty = &greedy_year_of_plenty;
+	callbacks.plenty = &greedy_plenty;
 	callbacks.monopoly = &greedy_monopoly;
 	callbacks.discard_add = &greedy_discard_add;
 	callbacks.quote_start = &greedy_quote_start;
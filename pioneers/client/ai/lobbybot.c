@@ -30,8 +30,8 @@
  * When used in other games, it will leave the game when it starts.
 */
 
-static GHashTable *players = NULL;
-static gboolean chatting = FALSE;
+static THREAD_LOCAL GHashTable *players = NULL;
+static THREAD_LOCAL gboolean chatting = FALSE;
 
 struct _PlayerInfo {
 	/** Name of the player */
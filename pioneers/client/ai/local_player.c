@@ -0,0 +1,140 @@
+/* Pioneers - Implementation of the excellent Settlers of Catan board game.
+ *   Go buy a copy.
+ *
+ * Copyright (C) 2026 The Pioneers developers
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include "config.h"
+#include <string.h>
+#include <time.h>
+#include "local_player.h"
+#include "ai.h"
+#include "client.h"
+
+struct _LocalPlayer {
+	GThread *thread;
+	Session *ses;
+	GMainContext *context;
+	GMainContext *owner; /**< Context of the thread that started it */
+	gint finished;
+	gchar **argv; /**< Shallow copy, the strings are owned by argv_data */
+	gchar **argv_data;
+	gdouble cpu_time;
+};
+
+static THREAD_LOCAL GMainLoop *loop;
+
+static void local_player_mainloop(void)
+{
+	loop = g_main_loop_new(g_main_context_get_thread_default(), FALSE);
+	g_main_loop_run(loop);
+	g_main_loop_unref(loop);
+	loop = NULL;
+}
+
+static void local_player_quit(void)
+{
+	if (loop != NULL) {
+		g_main_loop_quit(loop);
+	}
+	callbacks.mainloop = NULL;
+}
+
+gdouble local_player_thread_cpu_time(void)
+{
+#ifdef CLOCK_THREAD_CPUTIME_ID
+	struct timespec now;
+
+	if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &now) == 0)
+		return (gdouble) now.tv_sec + (gdouble) now.tv_nsec / 1e9;
+#endif
+	return 0.0;
+}
+
+static gpointer local_player_run(gpointer data)
+{
+	LocalPlayer *player = data;
+	gdouble start;
+
+	start = local_player_thread_cpu_time();
+	g_main_context_push_thread_default(player->context);
+
+	client_init();
+	callbacks.mainloop = &local_player_mainloop;
+	callbacks.quit = &local_player_quit;
+	frontend_set_callbacks();
+	client_use_session(player->ses);
+	/* The option parser removes the options it recognizes from argv */
+	client_start((int) g_strv_length(player->argv), player->argv);
+
+	if (callbacks.mainloop != NULL) {
+		callbacks.mainloop();
+	}
+	client_finish();
+	ai_finish();
+
+	/* Run the pending clean up of the session */
+	while (g_main_context_iteration(player->context, FALSE));
+	g_main_context_pop_thread_default(player->context);
+
+	player->cpu_time = local_player_thread_cpu_time() - start;
+	g_atomic_int_set(&player->finished, 1);
+	g_main_context_wakeup(player->owner);
+	return NULL;
+}
+
+LocalPlayer *local_player_start(Session * ses, GMainContext * context,
+				gchar ** argv)
+{
+	LocalPlayer *player;
+	guint len;
+
+	g_return_val_if_fail(ses != NULL, NULL);
+	g_return_val_if_fail(context != NULL, NULL);
+
+	player = g_malloc0(sizeof(*player));
+	player->ses = ses;
+	player->context = g_main_context_ref(context);
+	player->owner = g_main_context_ref_thread_default();
+	player->argv_data = g_strdupv(argv);
+	len = g_strv_length(argv);
+	player->argv = g_new(gchar *, len + 1);
+	memcpy(player->argv, player->argv_data,
+	       sizeof(gchar *) * (len + 1));
+	player->thread =
+	    g_thread_new("computer player", local_player_run, player);
+	return player;
+}
+
+gboolean local_player_is_finished(LocalPlayer * player)
+{
+	return g_atomic_int_get(&player->finished) != 0;
+}
+
+gdouble local_player_join(LocalPlayer * player)
+{
+	gdouble cpu_time;
+
+	g_thread_join(player->thread);
+	cpu_time = player->cpu_time;
+	g_main_context_unref(player->context);
+	g_main_context_unref(player->owner);
+	g_strfreev(player->argv_data);
+	g_free(player->argv);
+	g_free(player);
+	return cpu_time;
+}
@@ -0,0 +1,65 @@
+/* Pioneers - Implementation of the excellent Settlers of Catan board game.
+ *   Go buy a copy.
+ *
+ * Copyright (C) 2026 The Pioneers developers
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef _local_player_h
+#define _local_player_h
+
+/** @file local_player.h
+ * Run a computer player in a thread of the current process.
+ * The state of the client library is kept per thread, so any number of
+ * computer players can run side by side.
+ */
+
+#include <glib.h>
+#include "network.h"
+
+typedef struct _LocalPlayer LocalPlayer;
+
+/** Start a computer player in a new thread.
+ * @param ses A connected session, for example from net_connect_pair().
+ *            The player takes ownership.
+ * @param context The context of @p ses, the player takes a reference
+ * @param argv The command line of the player, like for pioneersai.
+ *             The server and port options are not used.
+ * @return The player, to be passed to local_player_join()
+ */
+LocalPlayer *local_player_start(Session * ses, GMainContext * context,
+				gchar ** argv);
+
+/** Check whether the player has left its game.
+ * The thread that started the player is woken up, by a wake up of its
+ * thread default context, when the player leaves.
+ * @param player A player from local_player_start()
+ * @return TRUE if local_player_join() will not block
+ */
+gboolean local_player_is_finished(LocalPlayer * player);
+
+/** Wait for the player to leave its game, and free it.
+ * @param player A player from local_player_start()
+ * @return The processor time used by the thread of the player, in seconds
+ */
+gdouble local_player_join(LocalPlayer * player);
+
+/** Processor time used by the current thread.
+ * @return The time in seconds, or 0 when it cannot be measured
+ */
+gdouble local_player_thread_cpu_time(void);
+
+#endif
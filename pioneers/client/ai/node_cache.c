@@ -0,0 +1,159 @@
+/* Pioneers - Implementation of the excellent Settlers of Catan board game.
+ *   Go buy a copy.
+ *
+ * Copyright (C) 2026 The Pioneers developers
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include "config.h"
+#include <string.h>
+
+#include "node_cache.h"
+#include "log.h"
+
+typedef struct {
+	/** The scores are valid when this equals cache_generation */
+	guint32 generation[2];
+	float score[2];
+} NodeScore;
+
+static THREAD_LOCAL const Map *cache_map = NULL;
+static THREAD_LOCAL NodeScore *scores = NULL;
+static THREAD_LOCAL gsize num_scores = 0;
+/** Dropping all scores is done by counting up */
+static THREAD_LOCAL guint32 cache_generation = 1;
+static THREAD_LOCAL GByteArray *cache_inputs = NULL;
+static THREAD_LOCAL guint64 hits = 0;
+static THREAD_LOCAL guint64 misses = 0;
+
+/** Drop all scores, but keep the entries */
+static void drop_scores(void)
+{
+	cache_generation++;
+	if (cache_generation == 0) {
+		/* Wrapped around, the old generations are not unique */
+		if (scores != NULL)
+			memset(scores, 0, num_scores * sizeof(*scores));
+		cache_generation = 1;
+	}
+}
+
+void node_cache_reset(void)
+{
+	/* A new map can have the address of the old one, and more nodes */
+	g_free(scores);
+	scores = NULL;
+	num_scores = 0;
+	cache_map = NULL;
+	drop_scores();
+}
+
+void node_cache_free(void)
+{
+	g_free(scores);
+	scores = NULL;
+	num_scores = 0;
+	cache_map = NULL;
+	if (cache_inputs != NULL) {
+		g_byte_array_free(cache_inputs, TRUE);
+		cache_inputs = NULL;
+	}
+	hits = 0;
+	misses = 0;
+}
+
+void node_cache_set_inputs(gconstpointer inputs, gsize size)
+{
+	if (cache_inputs == NULL)
+		cache_inputs = g_byte_array_new();
+	else if (cache_inputs->len == size
+		 && memcmp(cache_inputs->data, inputs, size) == 0)
+		return;
+	g_byte_array_set_size(cache_inputs, 0);
+	g_byte_array_append(cache_inputs, inputs, (guint) size);
+	drop_scores();
+}
+
+/** Find the entry of a node, allocate the entries for a new map */
+static NodeScore *find_entry(const Node * node)
+{
+	const Map *map = node->map;
+
+	if (map != cache_map) {
+		g_free(scores);
+		num_scores = map->num_nodes;
+		scores = g_new0(NodeScore, num_scores);
+		cache_map = map;
+	}
+	return &scores[node->id];
+}
+
+gboolean node_cache_lookup(const Node * node, gboolean city,
+			   float *score)
+{
+	NodeScore *entry = find_entry(node);
+	gint kind = city ? 1 : 0;
+
+	if (entry->generation[kind] != cache_generation) {
+		misses++;
+		return FALSE;
+	}
+	hits++;
+	*score = entry->score[kind];
+	return TRUE;
+}
+
+void node_cache_store(const Node * node, gboolean city, float score)
+{
+	NodeScore *entry = find_entry(node);
+	gint kind = city ? 1 : 0;
+
+	entry->generation[kind] = cache_generation;
+	entry->score[kind] = score;
+}
+
+void node_cache_node_changed(const Node * node)
+{
+	guint idx;
+
+	if (node->map != cache_map)
+		return;
+	/* The distance rule uses the neighbours */
+	memset(find_entry(node), 0, sizeof(NodeScore));
+	for (idx = 0; idx < G_N_ELEMENTS(node->edges); idx++) {
+		const Edge *edge = node->edges[idx];
+		guint idx2;
+
+		if (edge == NULL)
+			continue;
+		for (idx2 = 0; idx2 < G_N_ELEMENTS(edge->nodes); idx2++)
+			if (edge->nodes[idx2] != NULL)
+				memset(find_entry(edge->nodes[idx2]), 0,
+				       sizeof(NodeScore));
+	}
+}
+
+void node_cache_log_statistics(void)
+{
+	guint64 total = hits + misses;
+
+	if (total == 0)
+		return;
+	log_message(MSG_INFO,
+		    "Node score cache: %" G_GUINT64_FORMAT " hits, %"
+		    G_GUINT64_FORMAT " misses, %.1f%% hit rate\n", hits,
+		    misses, 100.0 * (gdouble) hits / (gdouble) total);
+}
@@ -0,0 +1,61 @@
+/* Pioneers - Implementation of the excellent Settlers of Catan board game.
+ *   Go buy a copy.
+ *
+ * Copyright (C) 2026 The Pioneers developers
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef _node_cache_h
+#define _node_cache_h
+
+/** @file node_cache.h
+ * Cache of the scores that a computer player gives to the nodes.
+ * A score depends on the node, its neighbours and its hexes, and on
+ * inputs that are the same for all nodes, like the value of the
+ * resources.  When a node changes, only the scores around it are
+ * dropped.  When the inputs change, all scores are dropped.
+ * The cache is kept per thread.
+ */
+
+#include <glib.h>
+#include "map.h"
+
+/** Drop all scores and their entries, because there is a new map. */
+void node_cache_reset(void);
+/** Release the memory of the cache. */
+void node_cache_free(void);
+/** Set the inputs of the scores that are the same for all nodes.
+ * The cache is emptied when they differ from the previous inputs.
+ * @param inputs The inputs, without uninitialised padding
+ * @param size The size of @p inputs
+ */
+void node_cache_set_inputs(gconstpointer inputs, gsize size);
+/** Look up the score of a node.
+ * @param node The node
+ * @param city The score for a city instead of a settlement
+ * @retval score The score, if it was found
+ * @return TRUE if the score was found
+ */
+gboolean node_cache_lookup(const Node * node, gboolean city,
+			   float *score);
+/** Store the score of a node, for the current inputs. */
+void node_cache_store(const Node * node, gboolean city, float score);
+/** Report a change of the owner or type of a node. */
+void node_cache_node_changed(const Node * node);
+/** Log the number of hits and misses of the cache. */
+void node_cache_log_statistics(void);
+
+#endif
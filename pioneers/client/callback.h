@@ -277,11 +277,11 @@ struct callbacks {
 	void (*quit)(void);
 };
 
-extern struct callbacks callbacks;
-extern enum callback_mode callback_mode;
+extern THREAD_LOCAL struct callbacks callbacks;
+extern THREAD_LOCAL enum callback_mode callback_mode;
 /* It seems this should be part of the gui, but it is in fact part of the log,
  * which is in common, and included by the client, not the gui. */
-extern gboolean color_chat_enabled;
+extern THREAD_LOCAL gboolean color_chat_enabled;
 
 /* functions for use by front ends */
 /* these functions do things for the frontends, they should be used to make
@@ -396,6 +396,10 @@ gboolean have_ships(void);
 gboolean have_bridges(void);
 gboolean have_city_walls(void);
 const GameParams *get_game_params(void);
+/** The buildings that produce on each dice roll, for the current map */
+const ProductionIndex *get_production_index(void);
+/** The ports that each player has a building on */
+const PortIndex *get_port_index(void);
 guint pirate_count_victims(const Hex * hex, gint * victim_list);
 guint robber_count_victims(const Hex * hex, gint * victim_list);
 const gint *get_bank(void);
@@ -30,9 +30,9 @@
 #include "log.h"
 #include "buildrec.h"
 
-static GList *build_list;
-static gboolean built;		/* have we build road / settlement / city? */
-static gint num_edges, num_settlements;
+static THREAD_LOCAL GList *build_list;
+static THREAD_LOCAL gboolean built;		/* have we build road / settlement / city? */
+static THREAD_LOCAL gint num_edges, num_settlements;
 
 void build_clear(void)
 {
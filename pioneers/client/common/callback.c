@@ -27,13 +27,21 @@
 
 /* callbacks is a pointer to an array of function pointers.
  * It is filled in by the front end. */
-struct callbacks callbacks;
+THREAD_LOCAL struct callbacks callbacks;
 
 /* current callback mode */
-enum callback_mode callback_mode;
+THREAD_LOCAL enum callback_mode callback_mode;
 
 /* is chat currently colourful? */
-gboolean color_chat_enabled;
+THREAD_LOCAL gboolean color_chat_enabled;
+
+/* session to use instead of connecting to a server */
+static THREAD_LOCAL Session *prepared_session;
+
+void client_use_session(Session * ses)
+{
+	prepared_session = ses;
+}
 
 void cb_connect(const gchar * server, const gchar * port,
 		gboolean spectator)
@@ -41,7 +49,11 @@ void cb_connect(const gchar * server, const gchar * port,
 	/* connect to a server */
 	g_assert(callback_mode == MODE_INIT);
 	requested_spectator = spectator;
-	if (sm_connect(SM(), server, port)) {
+	if (prepared_session != NULL) {
+		sm_set_session(SM(), prepared_session);
+		prepared_session = NULL;
+		sm_goto(SM(), mode_start);
+	} else if (sm_connect(SM(), server, port)) {
 		if (sm_is_connected(SM())) {
 			sm_goto(SM(), mode_start);
 		} else {
@@ -338,6 +350,16 @@ const GameParams *get_game_params(void)
 	return game_params;
 }
 
+const ProductionIndex *get_production_index(void)
+{
+	return production_index;
+}
+
+const PortIndex *get_port_index(void)
+{
+	return port_index;
+}
+
 gint game_resources(void)
 {
 	return game_params->resource_count;
@@ -379,21 +401,24 @@ gboolean road_building_can_build_road(void)
 {
 	return build_count_edges() < 2
 	    && stock_num_roads() > 0
-	    && map_can_place_road(callbacks.get_map(), my_player_num());
+	    && frontier_index_can_build(frontier_index, my_player_num(),
+					BUILD_ROAD);
 }
 
 gboolean road_building_can_build_ship(void)
 {
 	return build_count_edges() < 2
 	    && stock_num_ships() > 0
-	    && map_can_place_ship(callbacks.get_map(), my_player_num());
+	    && frontier_index_can_build(frontier_index, my_player_num(),
+					BUILD_SHIP);
 }
 
 gboolean road_building_can_build_bridge(void)
 {
 	return build_count_edges() < 2
 	    && stock_num_bridges() > 0
-	    && map_can_place_bridge(callbacks.get_map(), my_player_num());
+	    && frontier_index_can_build(frontier_index, my_player_num(),
+					BUILD_BRIDGE);
 }
 
 gboolean road_building_can_finish(void)
@@ -408,29 +433,32 @@ gboolean turn_can_build_road(void)
 {
 	return have_rolled_dice()
 	    && stock_num_roads() > 0 && can_afford(cost_road())
-	    && map_can_place_road(callbacks.get_map(), my_player_num());
+	    && frontier_index_can_build(frontier_index, my_player_num(),
+					BUILD_ROAD);
 }
 
 gboolean turn_can_build_ship(void)
 {
 	return have_rolled_dice()
 	    && stock_num_ships() > 0 && can_afford(cost_ship())
-	    && map_can_place_ship(callbacks.get_map(), my_player_num());
+	    && frontier_index_can_build(frontier_index, my_player_num(),
+					BUILD_SHIP);
 }
 
 gboolean turn_can_build_bridge(void)
 {
 	return have_rolled_dice()
 	    && stock_num_bridges() > 0 && can_afford(cost_bridge())
-	    && map_can_place_bridge(callbacks.get_map(), my_player_num());
+	    && frontier_index_can_build(frontier_index, my_player_num(),
+					BUILD_BRIDGE);
 }
 
 gboolean turn_can_build_settlement(void)
 {
 	return have_rolled_dice()
 	    && stock_num_settlements() > 0 && can_afford(cost_settlement())
-	    && map_can_place_settlement(callbacks.get_map(),
-					my_player_num());
+	    && frontier_index_can_build(frontier_index, my_player_num(),
+					BUILD_SETTLEMENT);
 }
 
 gboolean turn_can_build_city(void)
@@ -438,16 +466,16 @@ gboolean turn_can_build_city(void)
 	return have_rolled_dice()
 	    && stock_num_cities() > 0
 	    && can_afford(cost_upgrade_settlement())
-	    && map_can_upgrade_settlement(callbacks.get_map(),
-					  my_player_num());
+	    && frontier_index_can_build(frontier_index, my_player_num(),
+					BUILD_CITY);
 }
 
 gboolean turn_can_build_city_wall(void)
 {
 	return have_rolled_dice()
 	    && stock_num_city_walls() > 0 && can_afford(cost_city_wall())
-	    && map_can_place_city_wall(callbacks.get_map(),
-				       my_player_num());
+	    && frontier_index_can_build(frontier_index, my_player_num(),
+					BUILD_CITY_WALL);
 }
 
 gboolean turn_can_trade(void)
@@ -35,9 +35,12 @@
 #include "quoteinfo.h"
 #include "notifying-string.h"
 
-static enum callback_mode previous_mode;
-GameParams *game_params;
-static struct recovery_info_t {
+static THREAD_LOCAL enum callback_mode previous_mode;
+THREAD_LOCAL GameParams *game_params;
+THREAD_LOCAL ProductionIndex *production_index;
+THREAD_LOCAL FrontierIndex *frontier_index;
+THREAD_LOCAL PortIndex *port_index;
+static THREAD_LOCAL struct recovery_info_t {
 	gchar *prevstate;
 	gint turnnum;
 	gint playerturn;
@@ -49,9 +52,9 @@ static struct recovery_info_t {
 	gboolean ship_moved;
 } recovery_info;
 
-NotifyingString *requested_name = NULL;
-NotifyingString *requested_style = NULL;
-gboolean requested_spectator;
+THREAD_LOCAL NotifyingString *requested_name = NULL;
+THREAD_LOCAL NotifyingString *requested_style = NULL;
+THREAD_LOCAL gboolean requested_spectator;
 
 static gboolean global_unhandled(StateMachine * sm, gint event);
 static gboolean global_filter(StateMachine * sm, gint event);
@@ -82,9 +85,10 @@ static void recover_from_disconnect(StateMachine * sm,
 
 /* Create and/or return the client state machine.
  */
+static THREAD_LOCAL StateMachine *state_machine;
+
 StateMachine *SM(void)
 {
-	static StateMachine *state_machine;
 	if (state_machine == NULL) {
 		state_machine = sm_new(NULL);
 		sm_global_set(state_machine, global_filter);
@@ -505,6 +509,32 @@ void client_start(int argc, char **argv)
 	sm_goto(SM(), mode_offline);
 }
 
+void client_finish(void)
+{
+	if (game_params != NULL) {
+		callbacks.set_map(NULL);
+		production_index_free(production_index);
+		production_index = NULL;
+		frontier_index_free(frontier_index);
+		frontier_index = NULL;
+		port_index_free(port_index);
+		port_index = NULL;
+		params_free(game_params);
+		game_params = NULL;
+	}
+	player_reset();
+	build_clear();
+	if (state_machine != NULL) {
+		sm_close(state_machine);
+		sm_free(state_machine);
+		state_machine = NULL;
+	}
+	g_object_unref(requested_name);
+	requested_name = NULL;
+	g_object_unref(requested_style);
+	requested_style = NULL;
+}
+
 /*----------------------------------------------------------------------
  * The state machine API supports two global event handling callbacks.
  *
@@ -1038,6 +1068,12 @@ static gboolean mode_load_game(StateMachine * sm, gint event)
 	if (sm_recv(sm, "game")) {
 		if (game_params != NULL) {
 			callbacks.set_map(NULL);
+			production_index_free(production_index);
+			production_index = NULL;
+			frontier_index_free(frontier_index);
+			frontier_index = NULL;
+			port_index_free(port_index);
+			port_index = NULL;
 			params_free(game_params);
 		}
 		game_params = params_new();
@@ -1045,6 +1081,11 @@ static gboolean mode_load_game(StateMachine * sm, gint event)
 	}
 	if (sm_recv(sm, "end")) {
 		params_load_finish(game_params);
+		production_index = production_index_new(game_params->map);
+		frontier_index = frontier_index_new(game_params->map,
+						    game_params->num_players);
+		port_index = port_index_new(game_params->map,
+					    game_params->num_players);
 		callbacks.set_map(game_params->map);
 		stock_init();
 		develop_init();
@@ -1074,14 +1115,74 @@ static gboolean mode_load_game(StateMachine * sm, gint event)
 	return FALSE;
 }
 
+/* Add the buildings of a compact list of nodes, see pregame.c.
+ * @return FALSE if the list is malformed
+ */
+static gboolean load_board_nodes(const gchar * list)
+{
+	Map *map = callbacks.get_map();
+	guint id = 0;
+	guint delta, owner, kind;
+
+	while (*list != '\0') {
+		const Node *node;
+
+		if (!game_read_compact(&list, &delta)
+		    || !game_read_compact(&list, &owner)
+		    || !game_read_compact(&list, &kind))
+			return FALSE;
+		id += delta;
+		if (id >= map->num_nodes || owner >= game_params->num_players)
+			return FALSE;
+		node = map->nodes[id];
+		player_build_add((gint) owner,
+				 (kind & 1) ? BUILD_CITY : BUILD_SETTLEMENT,
+				 node->x, node->y, node->pos, FALSE);
+		if (kind & 2)
+			player_build_add((gint) owner, BUILD_CITY_WALL,
+					 node->x, node->y, node->pos, FALSE);
+	}
+	return TRUE;
+}
+
+/* Add the roads, ships and bridges of a compact list of edges.
+ * @return FALSE if the list is malformed
+ */
+static gboolean load_board_edges(const gchar * list)
+{
+	static const BuildType types[] = {
+		BUILD_ROAD, BUILD_SHIP, BUILD_BRIDGE
+	};
+	Map *map = callbacks.get_map();
+	guint id = 0;
+	guint delta, owner, type;
+
+	while (*list != '\0') {
+		const Edge *edge;
+
+		if (!game_read_compact(&list, &delta)
+		    || !game_read_compact(&list, &owner)
+		    || !game_read_compact(&list, &type))
+			return FALSE;
+		id += delta;
+		if (id >= map->num_edges || owner >= game_params->num_players
+		    || type >= G_N_ELEMENTS(types))
+			return FALSE;
+		edge = map->edges[id];
+		player_build_add((gint) owner, types[type], edge->x, edge->y,
+				 edge->pos, FALSE);
+	}
+	return TRUE;
+}
+
 /* Response to "gameinfo" command
  */
 static gboolean mode_load_gameinfo(StateMachine * sm, gint event)
 {
 	gint x, y, pos, owner;
-	static gboolean have_bank = FALSE;
-	static gint devcardidx = -1;
-	static gint numdevcards = -1;
+	static THREAD_LOCAL gboolean have_bank = FALSE;
+	static THREAD_LOCAL gint devcardidx = -1;
+	static THREAD_LOCAL gint numdevcards = -1;
 	gint num_roads, num_bridges, num_ships, num_settlements,
 	    num_cities, num_soldiers;
 	gint opnum, opnassets, opncards, opnsoldiers;
@@ -1089,6 +1190,7 @@ static gboolean mode_load_gameinfo(StateMachine * sm, gint event)
 	    plargestarmy;
 	gint point_id, point_points;
 	gchar *point_name;
+	gchar *str;
 	DevelType devcard;
 	gint devcardturnbought;
 	BuildType btype;
@@ -1316,6 +1418,20 @@ static gboolean mode_load_gameinfo(StateMachine * sm, gint event)
 		player_build_add(owner, BUILD_BRIDGE, x, y, pos, FALSE);
 		return TRUE;
 	}
+	if (sm_recv(sm, "board nodes %S", &str)) {
+		if (!load_board_nodes(str))
+			log_message(MSG_ERROR,
+				    _("Malformed buildings received.\n"));
+		g_free(str);
+		return TRUE;
+	}
+	if (sm_recv(sm, "board edges %S", &str)) {
+		if (!load_board_edges(str))
+			log_message(MSG_ERROR,
+				    _("Malformed buildings received.\n"));
+		g_free(str);
+		return TRUE;
+	}
 	return FALSE;
 }
 
@@ -2705,7 +2821,7 @@ gboolean can_trade_maritime(void)
 		return FALSE;
 	can_trade = FALSE;
 	/* Check if we can do a maritime trade */
-	map_maritime_info(callbacks.get_map(), &info, my_player_num());
+	port_index_maritime_info(port_index, &info, my_player_num());
 	for (idx = 0; idx < NO_RESOURCE; idx++)
 		if (info.specific_resource[idx]
 		    && resource_asset(idx) >= 2) {
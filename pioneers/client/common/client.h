@@ -28,15 +28,24 @@
 #include "notifying-string.h"
 
 /* variables */
-extern GameParams *game_params;
-extern NotifyingString *requested_name;
-extern NotifyingString *requested_style;
-extern gboolean requested_spectator;
+extern THREAD_LOCAL GameParams *game_params;
+extern THREAD_LOCAL ProductionIndex *production_index;
+extern THREAD_LOCAL FrontierIndex *frontier_index;
+extern THREAD_LOCAL PortIndex *port_index;
+extern THREAD_LOCAL NotifyingString *requested_name;
+extern THREAD_LOCAL NotifyingString *requested_style;
+extern THREAD_LOCAL gboolean requested_spectator;
 
 /********* client.c ***********/
 /* client initialization */
 void client_init(void);		/* before frontend initialization */
 void client_start(int argc, char **argv);	/* after frontend initialization */
+void client_finish(void);	/* after the main loop has stopped */
+
+/********* callback.c ***********/
+/* use an already connected session in the next cb_connect, instead of
+ * connecting to the server */
+void client_use_session(Session * ses);
 
 /* access the state machine (a client has only one state machine) */
 StateMachine *SM(void);
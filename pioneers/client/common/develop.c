@@ -32,12 +32,12 @@
 #include "state.h"
 #include "callback.h"
 
-static gboolean bought_develop;	/* have we bought a development card? */
-static guint num_playable_cards;	/* number of playable development cards */
+static THREAD_LOCAL gboolean bought_develop;	/* have we bought a development card? */
+static THREAD_LOCAL guint num_playable_cards;	/* number of playable development cards */
 
-static gboolean is_unique[NUM_DEVEL_TYPES];	/* is each card unique? */
+static THREAD_LOCAL gboolean is_unique[NUM_DEVEL_TYPES];	/* is each card unique? */
 
-static Deck *develop_deck;	/* our deck of development cards */
+static THREAD_LOCAL Deck *develop_deck;	/* our deck of development cards */
 
 void develop_init(void)
 {
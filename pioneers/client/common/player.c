@@ -30,12 +30,12 @@
 #include "log.h"
 #include "callback.h"
 
-static Player players[MAX_PLAYERS];
-static GList *spectators;
+static THREAD_LOCAL Player players[MAX_PLAYERS];
+static THREAD_LOCAL GList *spectators;
 
-static gint turn_player = -1;	/* whose turn is it */
-static gint my_player_id = -1;	/* what is my player number */
-static gint num_total_players = 4;	/* total number of players in the game */
+static THREAD_LOCAL gint turn_player = -1;	/* whose turn is it */
+static THREAD_LOCAL gint my_player_id = -1;	/* what is my player number */
+static THREAD_LOCAL gint num_total_players = 4;	/* total number of players in the game */
 
 /* this function is called when the game starts, to clean up from the
  * previous game. */
@@ -114,7 +114,7 @@ gint find_spectator_by_name(const gchar * name)
 
 const gchar *player_name(gint player_num, gboolean word_caps)
 {
-	static gchar buff[256];
+	static THREAD_LOCAL gchar buff[256];
 	if (player_num >= num_total_players) {
 		/* this is about a spectator */
 		Spectator *spectator = spectator_get(player_num);
@@ -477,6 +477,7 @@ void player_build_add(gint player_num,
 		edge = map_edge(callbacks.get_map(), x, y, pos);
 		edge->owner = player_num;
 		edge->type = BUILD_ROAD;
+		frontier_index_edge_changed(frontier_index, edge);
 		callbacks.draw_edge(edge);
 		if (log_changes) {
 			log_message(MSG_BUILD, _("%s built a road.\n"),
@@ -489,6 +490,7 @@ void player_build_add(gint player_num,
 		edge = map_edge(callbacks.get_map(), x, y, pos);
 		edge->owner = player_num;
 		edge->type = BUILD_SHIP;
+		frontier_index_edge_changed(frontier_index, edge);
 		callbacks.draw_edge(edge);
 		if (log_changes) {
 			log_message(MSG_BUILD, _("%s built a ship.\n"),
@@ -501,6 +503,9 @@ void player_build_add(gint player_num,
 		node = map_node(callbacks.get_map(), x, y, pos);
 		node->type = BUILD_SETTLEMENT;
 		node->owner = player_num;
+		production_index_node_changed(production_index, node);
+		frontier_index_node_changed(frontier_index, node);
+		port_index_node_changed(port_index, node);
 		callbacks.draw_node(node);
 		if (log_changes) {
 			log_message(MSG_BUILD,
@@ -521,6 +526,9 @@ void player_build_add(gint player_num,
 		}
 		node->type = BUILD_CITY;
 		node->owner = player_num;
+		production_index_node_changed(production_index, node);
+		frontier_index_node_changed(frontier_index, node);
+		port_index_node_changed(port_index, node);
 		callbacks.draw_node(node);
 		if (log_changes) {
 			log_message(MSG_BUILD, _("%s built a city.\n"),
@@ -534,6 +542,7 @@ void player_build_add(gint player_num,
 		node = map_node(callbacks.get_map(), x, y, pos);
 		node->city_wall = TRUE;
 		node->owner = player_num;
+		frontier_index_node_changed(frontier_index, node);
 		callbacks.draw_node(node);
 		if (log_changes) {
 			log_message(MSG_BUILD,
@@ -556,6 +565,7 @@ void player_build_add(gint player_num,
 		edge = map_edge(callbacks.get_map(), x, y, pos);
 		edge->owner = player_num;
 		edge->type = BUILD_BRIDGE;
+		frontier_index_edge_changed(frontier_index, edge);
 		callbacks.draw_edge(edge);
 		if (log_changes) {
 			log_message(MSG_BUILD, _("%s built a bridge.\n"),
@@ -584,6 +594,7 @@ void player_build_remove(gint player_num,
 		edge->owner = -1;
 		callbacks.draw_edge(edge);
 		edge->type = BUILD_NONE;
+		frontier_index_edge_changed(frontier_index, edge);
 		log_message(MSG_BUILD, _("%s removed a road.\n"),
 			    player_name(player_num, TRUE));
 		if (player_num == my_player_num())
@@ -594,6 +605,7 @@ void player_build_remove(gint player_num,
 		edge->owner = -1;
 		callbacks.draw_edge(edge);
 		edge->type = BUILD_NONE;
+		frontier_index_edge_changed(frontier_index, edge);
 		log_message(MSG_BUILD, _("%s removed a ship.\n"),
 			    player_name(player_num, TRUE));
 		if (player_num == my_player_num())
@@ -603,6 +615,9 @@ void player_build_remove(gint player_num,
 		node = map_node(callbacks.get_map(), x, y, pos);
 		node->type = BUILD_NONE;
 		node->owner = -1;
+		production_index_node_changed(production_index, node);
+		frontier_index_node_changed(frontier_index, node);
+		port_index_node_changed(port_index, node);
 		callbacks.draw_node(node);
 		log_message(MSG_BUILD, _("%s removed a settlement.\n"),
 			    player_name(player_num, TRUE));
@@ -614,6 +629,9 @@ void player_build_remove(gint player_num,
 		node = map_node(callbacks.get_map(), x, y, pos);
 		node->type = BUILD_SETTLEMENT;
 		node->owner = player_num;
+		production_index_node_changed(production_index, node);
+		frontier_index_node_changed(frontier_index, node);
+		port_index_node_changed(port_index, node);
 		callbacks.draw_node(node);
 		log_message(MSG_BUILD, _("%s removed a city.\n"),
 			    player_name(player_num, TRUE));
@@ -628,6 +646,7 @@ void player_build_remove(gint player_num,
 		node = map_node(callbacks.get_map(), x, y, pos);
 		node->city_wall = FALSE;
 		node->owner = player_num;
+		frontier_index_node_changed(frontier_index, node);
 		callbacks.draw_node(node);
 		log_message(MSG_BUILD, _("%s removed a city wall.\n"),
 			    player_name(player_num, TRUE));
@@ -648,6 +667,7 @@ void player_build_remove(gint player_num,
 		edge->owner = -1;
 		callbacks.draw_edge(edge);
 		edge->type = BUILD_NONE;
+		frontier_index_edge_changed(frontier_index, edge);
 		log_message(MSG_BUILD, _("%s removed a bridge.\n"),
 			    player_name(player_num, TRUE));
 		if (player_num == my_player_num())
@@ -676,6 +696,8 @@ void player_build_move(gint player_num, gint sx, gint sy, gint spos,
 	from->type = BUILD_NONE;
 	to->owner = player_num;
 	to->type = BUILD_SHIP;
+	frontier_index_edge_changed(frontier_index, from);
+	frontier_index_edge_changed(frontier_index, to);
 	callbacks.draw_edge(to);
 	if (isundo)
 		log_message(MSG_BUILD,
@@ -29,7 +29,7 @@
 #include "game.h"
 #include "map.h"
 
-static gint bank[NO_RESOURCE];
+static THREAD_LOCAL gint bank[NO_RESOURCE];
 
 static const gchar *resource_names[][2] = {
 	{ N_("brick"), N_("Brick") },
@@ -56,7 +56,7 @@ typedef enum {
 	RESOURCE_MULTICARD
 } ResourceListType;
 
-static gint my_assets[NO_RESOURCE];	/* my resources */
+static THREAD_LOCAL gint my_assets[NO_RESOURCE];	/* my resources */
 
 static const gchar *resource_list(Resource type, ResourceListType grammar)
 {
@@ -35,6 +35,7 @@ void robber_move_on_map(gint x, gint y)
 	Hex *old_robber = map_robber_hex(map);
 
 	map_move_robber(map, x, y);
+	production_index_robber_moved(production_index, old_robber, hex);
 
 	callbacks.draw_hex(old_robber);
 	callbacks.draw_hex(hex);
@@ -48,6 +49,7 @@ void pirate_move_on_map(gint x, gint y)
 	Hex *old_pirate = map_pirate_hex(map);
 
 	map_move_pirate(map, x, y);
+	frontier_index_pirate_moved(frontier_index, old_pirate, hex);
 
 	callbacks.draw_hex(old_pirate);
 	callbacks.draw_hex(hex);
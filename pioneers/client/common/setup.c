@@ -29,7 +29,7 @@
 #include "log.h"
 #include "client.h"
 
-static gboolean double_setup;
+static THREAD_LOCAL gboolean double_setup;
 
 gboolean is_setup_double(void)
 {
@@ -44,14 +44,16 @@ gboolean setup_can_build_road(void)
 		if (build_count_edges() == 2)
 			return FALSE;
 		return build_count_settlements() < 2
-		    || map_can_place_road(callbacks.get_map(),
-					  my_player_num());
+		    || frontier_index_can_build(frontier_index,
+						my_player_num(),
+						BUILD_ROAD);
 	} else {
 		if (build_count_edges() == 1)
 			return FALSE;
 		return build_count_settlements() < 1
-		    || map_can_place_road(callbacks.get_map(),
-					  my_player_num());
+		    || frontier_index_can_build(frontier_index,
+						my_player_num(),
+						BUILD_ROAD);
 	}
 }
 
@@ -63,14 +65,16 @@ gboolean setup_can_build_ship(void)
 		if (build_count_edges() == 2)
 			return FALSE;
 		return build_count_settlements() < 2
-		    || map_can_place_ship(callbacks.get_map(),
-					  my_player_num());
+		    || frontier_index_can_build(frontier_index,
+						my_player_num(),
+						BUILD_SHIP);
 	} else {
 		if (build_count_edges() == 1)
 			return FALSE;
 		return build_count_settlements() < 1
-		    || map_can_place_ship(callbacks.get_map(),
-					  my_player_num());
+		    || frontier_index_can_build(frontier_index,
+						my_player_num(),
+						BUILD_SHIP);
 	}
 }
 
@@ -82,14 +86,16 @@ gboolean setup_can_build_bridge(void)
 		if (build_count_edges() == 2)
 			return FALSE;
 		return build_count_settlements() < 2
-		    || map_can_place_bridge(callbacks.get_map(),
-					    my_player_num());
+		    || frontier_index_can_build(frontier_index,
+						my_player_num(),
+						BUILD_BRIDGE);
 	} else {
 		if (build_count_edges() == 1)
 			return FALSE;
 		return build_count_settlements() < 1
-		    || map_can_place_bridge(callbacks.get_map(),
-					    my_player_num());
+		    || frontier_index_can_build(frontier_index,
+						my_player_num(),
+						BUILD_BRIDGE);
 	}
 }
 
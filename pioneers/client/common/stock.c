@@ -28,13 +28,13 @@
 #include "client.h"
 #include "callback.h"
 
-static gint num_roads;		/* number of roads available */
-static gint num_ships;		/* number of ships available */
-static gint num_bridges;	/* number of bridges available */
-static gint num_settlements;	/* settlements available */
-static gint num_cities;		/* cities available */
-static gint num_city_walls;	/* city walls available */
-static guint num_develop;	/* development cards left */
+static THREAD_LOCAL gint num_roads;		/* number of roads available */
+static THREAD_LOCAL gint num_ships;		/* number of ships available */
+static THREAD_LOCAL gint num_bridges;	/* number of bridges available */
+static THREAD_LOCAL gint num_settlements;	/* settlements available */
+static THREAD_LOCAL gint num_cities;		/* cities available */
+static THREAD_LOCAL gint num_city_walls;	/* city walls available */
+static THREAD_LOCAL guint num_develop;	/* development cards left */
 
 void stock_init(void)
 {
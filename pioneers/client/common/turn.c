@@ -26,8 +26,8 @@
 #include "client.h"
 #include "callback.h"
 
-static gboolean rolled_dice;	/* have we rolled the dice? */
-static gint current_turn;
+static THREAD_LOCAL gboolean rolled_dice;	/* have we rolled the dice? */
+static THREAD_LOCAL gint current_turn;
 
 void turn_rolled_dice(gint player_num, gint die1, gint die2)
 {
@@ -279,16 +279,26 @@ void frontend_quote_monitor(void)
 {
 }
 
+/* Is the edge or node in the frontier of the player? */
+static gboolean in_frontier(gint owner, BuildType type, gint id)
+{
+	const guint32 *set;
+	guint count;
+
+	set = frontier_index_lookup(frontier_index, owner, type, &count);
+	return set != NULL && MAP_SET_TEST(set, id);
+}
+
 static gboolean check_road(MapElement element, gint owner,
 			   G_GNUC_UNUSED MapElement extra)
 {
-	return can_road_be_built(element.edge, owner);
+	return in_frontier(owner, BUILD_ROAD, element.edge->id);
 }
 
 static gboolean check_ship(MapElement element, gint owner,
 			   G_GNUC_UNUSED MapElement extra)
 {
-	return can_ship_be_built(element.edge, owner);
+	return in_frontier(owner, BUILD_SHIP, element.edge->id);
 }
 
 static gboolean check_ship_move(MapElement element, gint owner,
@@ -300,25 +310,25 @@ static gboolean check_ship_move(MapElement element, gint owner,
 static gboolean check_bridge(MapElement element, gint owner,
 			     G_GNUC_UNUSED MapElement extra)
 {
-	return can_bridge_be_built(element.edge, owner);
+	return in_frontier(owner, BUILD_BRIDGE, element.edge->id);
 }
 
 static gboolean check_settlement(MapElement element, gint owner,
 				 G_GNUC_UNUSED MapElement extra)
 {
-	return can_settlement_be_built(element.node, owner);
+	return in_frontier(owner, BUILD_SETTLEMENT, element.node->id);
 }
 
 static gboolean check_city(MapElement element, gint owner,
 			   G_GNUC_UNUSED MapElement extra)
 {
-	return can_settlement_be_upgraded(element.node, owner);
+	return in_frontier(owner, BUILD_CITY, element.node->id);
 }
 
 static gboolean check_city_wall(MapElement element, gint owner,
 				G_GNUC_UNUSED MapElement extra)
 {
-	return can_city_wall_be_built(element.node, owner);
+	return in_frontier(owner, BUILD_CITY_WALL, element.node->id);
 }
 
 /* turn */
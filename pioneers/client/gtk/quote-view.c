@@ -620,8 +620,9 @@ void quote_view_begin(QuoteView * qv)
 {
 	quotelist_new(&qv->quote_list);
 	if (qv->with_maritime) {
-		map_maritime_info(callbacks.get_map(), &qv->maritime_info,
-				  my_player_num());
+		port_index_maritime_info(get_port_index(),
+					 &qv->maritime_info,
+					 my_player_num());
 	}
 
 	gtk_list_store_clear(qv->store);
@@ -0,0 +1,344 @@
+/* Pioneers - Implementation of the excellent Settlers of Catan board game.
+ *   Go buy a copy.
+ *
+ * Copyright (C) 2026 The Pioneers developers
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+#include "config.h"
+#include <string.h>
+#include <glib.h>
+
+#include "cost.h"
+#include "map.h"
+#include "board_state.h"
+
+typedef enum {
+	CHANGE_NODE,
+	CHANGE_EDGE,
+	CHANGE_ROBBER,
+	CHANGE_PIRATE
+} ChangeKind;
+
+/** A recorded change, with everything needed to undo it */
+typedef struct {
+	ChangeKind kind;
+	gint id;		/* node, edge or hex id */
+	gint owner;		/* previous owner */
+	BuildType type;		/* previous type */
+	gboolean city_wall;	/* previous city wall */
+	gint player;		/* player that paid, -1 == nobody */
+	const gint *cost;	/* what the player paid */
+} BoardChange;
+
+struct _BoardState {
+	Map *map;		/* private copy of the board */
+	guint num_players;
+	gint (*resources)[NO_RESOURCE];	/* resources of each player */
+	GArray *changes;	/* BoardChange, the last one is undone first */
+};
+
+BoardState *board_state_new(const Map * map, guint num_players)
+{
+	BoardState *state;
+
+	g_return_val_if_fail(map != NULL, NULL);
+
+	state = g_malloc0(sizeof(*state));
+	state->map = map_copy(map);
+	state->num_players = num_players;
+	state->resources =
+	    g_malloc0_n(num_players, sizeof(*state->resources));
+	state->changes = g_array_new(FALSE, FALSE, sizeof(BoardChange));
+	board_state_sync(state, map);
+	return state;
+}
+
+void board_state_free(BoardState * state)
+{
+	if (state == NULL)
+		return;
+	map_free(state->map);
+	g_free(state->resources);
+	g_array_free(state->changes, TRUE);
+	g_free(state);
+}
+
+/* Put the robber on a hex, -1 for none */
+static void place_robber(Map * map, gint hex_id)
+{
+	if (hex_id < 0) {
+		if (map->robber_hex != NULL)
+			map->robber_hex->robber = FALSE;
+		map->robber_hex = NULL;
+	} else
+		map_move_robber(map, map->hexes[hex_id]->x,
+				map->hexes[hex_id]->y);
+}
+
+/* Put the pirate on a hex, -1 for none */
+static void place_pirate(Map * map, gint hex_id)
+{
+	map->pirate_hex = hex_id < 0 ? NULL : map->hexes[hex_id];
+}
+
+void board_state_sync(BoardState * state, const Map * map)
+{
+	Map *copy;
+	guint idx;
+
+	g_return_if_fail(state != NULL);
+	g_return_if_fail(map != NULL);
+	copy = state->map;
+	g_return_if_fail(map->num_nodes == copy->num_nodes);
+	g_return_if_fail(map->num_edges == copy->num_edges);
+
+	for (idx = 0; idx < map->num_nodes; idx++) {
+		const Node *node = map->nodes[idx];
+		copy->nodes[idx]->owner = node->owner;
+		copy->nodes[idx]->type = node->type;
+		copy->nodes[idx]->city_wall = node->city_wall;
+	}
+	for (idx = 0; idx < map->num_edges; idx++) {
+		const Edge *edge = map->edges[idx];
+		copy->edges[idx]->owner = edge->owner;
+		copy->edges[idx]->type = edge->type;
+	}
+	place_robber(copy,
+		     map->robber_hex != NULL ? map->robber_hex->id : -1);
+	place_pirate(copy,
+		     map->pirate_hex != NULL ? map->pirate_hex->id : -1);
+	g_array_set_size(state->changes, 0);
+}
+
+const Map *board_state_map(const BoardState * state)
+{
+	g_return_val_if_fail(state != NULL, NULL);
+	return state->map;
+}
+
+void board_state_set_resources(BoardState * state, gint player,
+			       const gint * resources)
+{
+	g_return_if_fail(state != NULL);
+	g_return_if_fail(player >= 0
+			 && (guint) player < state->num_players);
+	memcpy(state->resources[player], resources,
+	       sizeof(state->resources[player]));
+}
+
+const gint *board_state_resources(const BoardState * state, gint player)
+{
+	g_return_val_if_fail(state != NULL, NULL);
+	g_return_val_if_fail(player >= 0
+			     && (guint) player < state->num_players, NULL);
+	return state->resources[player];
+}
+
+/* Is the location legal, and what does it cost? */
+static gboolean build_allowed(const BoardState * state, gint owner,
+			      BuildType type, gint id, gboolean setup,
+			      const gint ** cost)
+{
+	const Map *map = state->map;
+	const Node *node = NULL;
+	const Edge *edge = NULL;
+
+	switch (type) {
+	case BUILD_ROAD:
+	case BUILD_SHIP:
+	case BUILD_BRIDGE:
+		if (id < 0 || (guint) id >= map->num_edges)
+			return FALSE;
+		edge = map->edges[id];
+		break;
+	case BUILD_SETTLEMENT:
+	case BUILD_CITY:
+	case BUILD_CITY_WALL:
+		if (id < 0 || (guint) id >= map->num_nodes)
+			return FALSE;
+		node = map->nodes[id];
+		break;
+	default:
+		return FALSE;
+	}
+
+	switch (type) {
+	case BUILD_ROAD:
+		*cost = cost_road();
+		return setup ? can_road_be_setup(edge)
+		    : can_road_be_built(edge, owner);
+	case BUILD_SHIP:
+		*cost = cost_ship();
+		return setup ? can_ship_be_setup(edge)
+		    : can_ship_be_built(edge, owner);
+	case BUILD_BRIDGE:
+		*cost = cost_bridge();
+		return setup ? can_bridge_be_setup(edge)
+		    : can_bridge_be_built(edge, owner);
+	case BUILD_SETTLEMENT:
+		*cost = cost_settlement();
+		return setup ? can_settlement_be_setup(node)
+		    : can_settlement_be_built(node, owner);
+	case BUILD_CITY:
+		if (setup) {
+			*cost = cost_city();
+			return can_settlement_be_setup(node);
+		}
+		*cost = can_settlement_be_upgraded(node, owner) ?
+		    cost_upgrade_settlement() : cost_city();
+		return can_city_be_built(node, owner);
+	case BUILD_CITY_WALL:
+		*cost = cost_city_wall();
+		return !setup && can_city_wall_be_built(node, owner);
+	default:
+		return FALSE;
+	}
+}
+
+gboolean board_state_can_build(const BoardState * state, gint owner,
+			       BuildType type, gint id, gboolean setup)
+{
+	const gint *cost;
+
+	g_return_val_if_fail(state != NULL, FALSE);
+	g_return_val_if_fail(owner >= 0
+			     && (guint) owner < state->num_players, FALSE);
+
+	if (!build_allowed(state, owner, type, id, setup, &cost))
+		return FALSE;
+	return setup || cost_can_afford(cost, state->resources[owner]);
+}
+
+gboolean board_state_build(BoardState * state, gint owner,
+			   BuildType type, gint id, gboolean setup)
+{
+	BoardChange change;
+	const gint *cost;
+
+	g_return_val_if_fail(state != NULL, FALSE);
+	g_return_val_if_fail(owner >= 0
+			     && (guint) owner < state->num_players, FALSE);
+
+	if (!build_allowed(state, owner, type, id, setup, &cost))
+		return FALSE;
+	if (!setup && !cost_can_afford(cost, state->resources[owner]))
+		return FALSE;
+
+	change.id = id;
+	change.player = setup ? -1 : owner;
+	change.cost = cost;
+	if (type == BUILD_ROAD || type == BUILD_SHIP
+	    || type == BUILD_BRIDGE) {
+		Edge *edge = state->map->edges[id];
+
+		change.kind = CHANGE_EDGE;
+		change.owner = edge->owner;
+		change.type = edge->type;
+		change.city_wall = FALSE;
+		edge->owner = owner;
+		edge->type = type;
+	} else {
+		Node *node = state->map->nodes[id];
+
+		change.kind = CHANGE_NODE;
+		change.owner = node->owner;
+		change.type = node->type;
+		change.city_wall = node->city_wall;
+		if (type == BUILD_CITY_WALL)
+			node->city_wall = TRUE;
+		else {
+			node->owner = owner;
+			node->type = type;
+		}
+	}
+	if (!setup)
+		cost_buy(cost, state->resources[owner]);
+	g_array_append_val(state->changes, change);
+	return TRUE;
+}
+
+gboolean board_state_move_robber(BoardState * state, gint hex_id)
+{
+	Map *map;
+	Hex *hex;
+	BoardChange change;
+
+	g_return_val_if_fail(state != NULL, FALSE);
+	map = state->map;
+	if (hex_id < 0 || (guint) hex_id >= map->num_hexes)
+		return FALSE;
+	hex = map->hexes[hex_id];
+	if (!can_robber_or_pirate_be_moved(hex))
+		return FALSE;
+
+	memset(&change, 0, sizeof(change));
+	change.player = -1;
+	if (hex->terrain == SEA_TERRAIN) {
+		change.kind = CHANGE_PIRATE;
+		change.id = map->pirate_hex != NULL ? map->pirate_hex->id : -1;
+		place_pirate(map, hex_id);
+	} else {
+		change.kind = CHANGE_ROBBER;
+		change.id = map->robber_hex != NULL ? map->robber_hex->id : -1;
+		place_robber(map, hex_id);
+	}
+	g_array_append_val(state->changes, change);
+	return TRUE;
+}
+
+guint board_state_mark(const BoardState * state)
+{
+	g_return_val_if_fail(state != NULL, 0);
+	return state->changes->len;
+}
+
+void board_state_revert(BoardState * state, guint mark)
+{
+	g_return_if_fail(state != NULL);
+	g_return_if_fail(mark <= state->changes->len);
+
+	while (state->changes->len > mark) {
+		const BoardChange *change =
+		    &g_array_index(state->changes, BoardChange,
+				   state->changes->len - 1);
+		Node *node;
+		Edge *edge;
+
+		switch (change->kind) {
+		case CHANGE_NODE:
+			node = state->map->nodes[change->id];
+			node->owner = change->owner;
+			node->type = change->type;
+			node->city_wall = change->city_wall;
+			break;
+		case CHANGE_EDGE:
+			edge = state->map->edges[change->id];
+			edge->owner = change->owner;
+			edge->type = change->type;
+			break;
+		case CHANGE_ROBBER:
+			place_robber(state->map, change->id);
+			break;
+		case CHANGE_PIRATE:
+			place_pirate(state->map, change->id);
+			break;
+		}
+		if (change->player >= 0)
+			cost_refund(change->cost,
+				    state->resources[change->player]);
+		g_array_set_size(state->changes, state->changes->len - 1);
+	}
+}
@@ -0,0 +1,89 @@
+/* Pioneers - Implementation of the excellent Settlers of Catan board game.
+ *   Go buy a copy.
+ *
+ * Copyright (C) 2026 The Pioneers developers
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+#ifndef __board_state_h
+#define __board_state_h
+
+/** @file board_state.h
+ * A snapshot of the board that can be changed without touching the game.
+ * It holds its own copy of the map, with the buildings, the robber and
+ * the pirate, and the resources of each player.  Every change is
+ * recorded, so a player can try a sequence of moves, evaluate the board
+ * with the usual map queries, and revert to an earlier mark.
+ */
+
+#include <glib.h>
+#include "map.h"
+
+typedef struct _BoardState BoardState;
+
+/** Create a snapshot of a map.
+ * @param map The board to copy, with its buildings
+ * @param num_players The number of players
+ * @return The snapshot, free with board_state_free
+ */
+BoardState *board_state_new(const Map * map, guint num_players);
+void board_state_free(BoardState * state);
+/** Take the buildings, the robber and the pirate from a map again.
+ * The map must have the layout of the original map.  The list of
+ * changes is emptied.
+ */
+void board_state_sync(BoardState * state, const Map * map);
+/** The board of the snapshot, for the queries of map.h.
+ * Its nodes and edges have the same ids as those of the original map.
+ */
+const Map *board_state_map(const BoardState * state);
+
+/** Set the resources of a player, without recording a change. */
+void board_state_set_resources(BoardState * state, gint player,
+			       const gint * resources);
+/** The resources of a player, valid until the next change */
+const gint *board_state_resources(const BoardState * state, gint player);
+
+/** Can the player build?
+ * @param state The snapshot
+ * @param owner The player
+ * @param type BUILD_ROAD, BUILD_SHIP, BUILD_BRIDGE, BUILD_SETTLEMENT,
+ *             BUILD_CITY or BUILD_CITY_WALL
+ * @param id The id of the edge or node
+ * @param setup Use the rules of the setup phase, which are free
+ * @return TRUE if the location is legal and the player can pay for it
+ */
+gboolean board_state_can_build(const BoardState * state, gint owner,
+			       BuildType type, gint id, gboolean setup);
+/** Build, and pay for it when it is not the setup phase.
+ * @return FALSE if board_state_can_build does not allow it
+ */
+gboolean board_state_build(BoardState * state, gint owner,
+			   BuildType type, gint id, gboolean setup);
+/** Move the robber or the pirate to a hex.
+ * The robber moves to a land hex, the pirate to a sea hex.
+ * @return FALSE if it cannot be moved to the hex
+ */
+gboolean board_state_move_robber(BoardState * state, gint hex_id);
+
+/** The current position in the list of changes */
+guint board_state_mark(const BoardState * state);
+/** Undo the changes after a mark.
+ * @param state The snapshot
+ * @param mark A result of board_state_mark
+ */
+void board_state_revert(BoardState * state, guint mark);
+
+#endif
@@ -828,6 +828,7 @@ static struct ClientVersionTypeConversion {
 	ClientVersionType type;
 	const gchar *string;
 } client_version_type_conversions[] = {
+	{ V16, "16" },
 	{ V15, "15" },
 	{ V14, "14" },
 	{ V0_12, "0.12" },
@@ -1183,13 +1184,6 @@ ssize_t game_vscanf(const gchar * line, const gchar * fmt, va_list ap)
 	return offset;
 }
 
-#define buff_append(result, format, value) \
-	do { \
-		gchar *old = result; \
-		result = g_strdup_printf("%s" format, result, value); \
-		g_free(old); \
-	} while (0)
-
 gchar *game_printf(const gchar * fmt, ...)
 {
 	va_list ap;
@@ -1204,21 +1198,32 @@ gchar *game_printf(const gchar * fmt, ...)
 
 gchar *game_vprintf(const gchar * fmt, va_list ap)
 {
-	/* initialize result to an allocated empty string */
-	gchar *result = g_strdup("");
+	GString *buffer = g_string_sized_new(64);
+
+	game_vprintf_into(buffer, fmt, ap);
+	return g_string_free(buffer, FALSE);
+}
+
+void game_printf_into(GString * buffer, const gchar * fmt, ...)
+{
+	va_list ap;
+
+	va_start(ap, fmt);
+	game_vprintf_into(buffer, fmt, ap);
+	va_end(ap);
+}
 
+void game_vprintf_into(GString * buffer, const gchar * fmt, va_list ap)
+{
 	while (*fmt != '\0') {
-		gchar *pos = strchr(fmt, '%');
-		gchar *text_without_format;
+		const gchar *pos = strchr(fmt, '%');
 
 		if (pos == NULL) {
-			buff_append(result, "%s", fmt);
+			g_string_append(buffer, fmt);
 			break;
 		}
 		/* add format until next % to result */
-		text_without_format = g_strndup(fmt, (gsize) (pos - fmt));
-		buff_append(result, "%s", text_without_format);
-		g_free(text_without_format);
+		g_string_append_len(buffer, fmt, pos - fmt);
 		fmt = pos + 1;
 
 		switch (*fmt++) {
@@ -1226,35 +1231,37 @@ gchar *game_vprintf(const gchar * fmt, va_list ap)
 			const gint *num;
 			gint idx;
 		case 's':	/* string */
-			buff_append(result, "%s", va_arg(ap, gchar *));
+			g_string_append(buffer, va_arg(ap, gchar *));
 			break;
 		case 'd':	/* integer */
 		case 'D':	/* development card type */
-			buff_append(result, "%d", va_arg(ap, gint));
+			g_string_append_printf(buffer, "%d",
+					       va_arg(ap, gint));
 			break;
 		case 'u':	/* unsigned integer */
-			buff_append(result, "%u", va_arg(ap, guint));
+			g_string_append_printf(buffer, "%u",
+					       va_arg(ap, guint));
 			break;
 		case 'B':	/* build type */
 			build_type = va_arg(ap, BuildType);
 			switch (build_type) {
 			case BUILD_ROAD:
-				buff_append(result, "%s", "road");
+				g_string_append(buffer, "road");
 				break;
 			case BUILD_BRIDGE:
-				buff_append(result, "%s", "bridge");
+				g_string_append(buffer, "bridge");
 				break;
 			case BUILD_SHIP:
-				buff_append(result, "%s", "ship");
+				g_string_append(buffer, "ship");
 				break;
 			case BUILD_SETTLEMENT:
-				buff_append(result, "%s", "settlement");
+				g_string_append(buffer, "settlement");
 				break;
 			case BUILD_CITY:
-				buff_append(result, "%s", "city");
+				g_string_append(buffer, "city");
 				break;
 			case BUILD_CITY_WALL:
-				buff_append(result, "%s", "city_wall");
+				g_string_append(buffer, "city_wall");
 				break;
 			case BUILD_NONE:
 				g_error
@@ -1270,18 +1277,63 @@ gchar *game_vprintf(const gchar * fmt, va_list ap)
 			num = va_arg(ap, gint *);
 			for (idx = 0; idx < NO_RESOURCE; idx++) {
 				if (idx > 0)
-					buff_append(result, " %d",
-						    num[idx]);
-				else
-					buff_append(result, "%d",
-						    num[idx]);
+					g_string_append_c(buffer, ' ');
+				g_string_append_printf(buffer, "%d",
+						       num[idx]);
 			}
 			break;
 		case 'r':	/* resource type */
-			buff_append(result, "%s",
-				    resource_types[va_arg(ap, Resource)]);
+			g_string_append(buffer,
+					resource_types[va_arg
+						       (ap, Resource)]);
 			break;
 		}
 	}
-	return result;
+}
+
+/* The digits of the compact number lists */
+static const gchar compact_last[] = "0123456789abcdefghijklmnopqrstuv";
+static const gchar compact_more[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZ+-=_.~";
+
+void game_append_compact(GString * buffer, guint value)
+{
+	while (value >= 32) {
+		g_string_append_c(buffer, compact_more[value % 32]);
+		value /= 32;
+	}
+	g_string_append_c(buffer, compact_last[value]);
+}
+
+gboolean game_read_compact(const gchar ** text, guint * value)
+{
+	const gchar *pos = *text;
+	const gchar *digit;
+	guint shift = 0;
+	guint bits;
+	gboolean last;
+
+	*value = 0;
+	while (*pos != '\0' && shift < 32) {
+		digit = strchr(compact_last, *pos);
+		last = digit != NULL;
+		if (last)
+			bits = (guint) (digit - compact_last);
+		else {
+			digit = strchr(compact_more, *pos);
+			if (digit == NULL)
+				return FALSE;
+			bits = (guint) (digit - compact_more);
+		}
+		/* Only 2 bits are left for the digit at shift 30 */
+		if (shift > 32 - 5 && bits >> (32 - shift) != 0)
+			return FALSE;
+		*value |= bits << shift;
+		shift += 5;
+		pos++;
+		if (last) {
+			*text = pos;
+			return TRUE;
+		}
+	}
+	return FALSE;
 }
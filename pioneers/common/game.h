@@ -63,8 +63,9 @@ typedef enum {
 	V0_12, /**< Trade protocol simplified */
 	V14, /**< More rules */
 	V15, /**< Dice deck */
+	V16, /**< Compact board in gameinfo */
 	FIRST_VERSION = V0_10,
-	LATEST_VERSION = V15
+	LATEST_VERSION = V16
 } ClientVersionType;
 
 /** Convert to a ClientVersionType.
@@ -231,6 +232,39 @@ gchar *game_vprintf(const gchar * fmt, va_list ap);
  * @return A string (you must use g_free to free the string)
 */
 gchar *game_printf(const gchar * fmt, ...);
+/** Append a printed line to a buffer.
+ * The buffer is grown in place, so repeated directives cost linear time
+ * in the length of the result.
+ * @param buffer Buffer to append to
+ * @param fmt Format of the line, see communication format
+ * @param ap Arguments to the format
+*/
+void game_vprintf_into(GString * buffer, const gchar * fmt, va_list ap);
+/** Append a printed line to a buffer.
+ * @param buffer Buffer to append to
+ * @param fmt Format of the line, see communication format
+*/
+void game_printf_into(GString * buffer, const gchar * fmt, ...);
+
+/* Compact number lists
+ *
+ * Long lists of small numbers are sent as one word.  Each number is
+ * written in base 32, the lowest digit first.  The last digit of a
+ * number is one of '0'..'9' and 'a'..'v', the other digits are one of
+ * 'A'..'Z' and '+', '-', '=', '_', '.', '~'.
+ */
+/** Append a number to a compact list.
+ * @param buffer Buffer to append to
+ * @param value The number
+ */
+void game_append_compact(GString * buffer, guint value);
+/** Read the next number of a compact list.
+ * @param text The position in the list, it is moved past the number
+ * @retval value The number
+ * @return FALSE at the end of the list, when the list is malformed, or
+ *         when the number does not fit in 32 bits
+ */
+gboolean game_read_compact(const gchar ** text, guint * value);
 
 /** Convert a string to an array of integers.
  * @param str A comma separated list of integers
@@ -542,6 +542,405 @@ static gboolean connect_network(Hex * hex, G_GNUC_UNUSED gpointer closure)
 	return FALSE;
 }
 
+/* Count the hexes, and the nodes and edges owned by them
+ */
+static gboolean count_network(Hex * hex, gpointer closure)
+{
+	Map *map = closure;
+	gint idx;
+
+	hex->id = (gint) map->num_hexes++;
+	for (idx = 0; idx < 6; idx++) {
+		Node *node = hex->nodes[idx];
+		Edge *edge = hex->edges[idx];
+
+		if (node->x == hex->x && node->y == hex->y)
+			node->id = (gint) map->num_nodes++;
+		if (edge->x == hex->x && edge->y == hex->y)
+			edge->id = (gint) map->num_edges++;
+	}
+	return FALSE;
+}
+
+/* Fill the arrays with the hexes, nodes and edges owned by a hex
+ */
+static gboolean index_network(Hex * hex, gpointer closure)
+{
+	Map *map = closure;
+	gint idx;
+	gint side;
+
+	map->hexes[hex->id] = hex;
+	for (idx = 0; idx < 6; idx++) {
+		Node *node = hex->nodes[idx];
+		Edge *edge = hex->edges[idx];
+
+		if (node->x == hex->x && node->y == hex->y) {
+			map->nodes[node->id] = node;
+			for (side = 0; side < 3; side++)
+				map->node_edges[node->id][side] =
+				    node->edges[side] != NULL ?
+				    node->edges[side]->id : -1;
+		}
+		if (edge->x == hex->x && edge->y == hex->y) {
+			map->edges[edge->id] = edge;
+			for (side = 0; side < 2; side++)
+				map->edge_nodes[edge->id][side] =
+				    edge->nodes[side] != NULL ?
+				    edge->nodes[side]->id : -1;
+		}
+	}
+	return FALSE;
+}
+
+/* Forget the islands of a map
+ */
+static void map_free_islands(Map * map)
+{
+	g_free(map->island_start);
+	map->island_start = NULL;
+	map->island_nodes = NULL;
+	map->num_islands = 0;
+}
+
+/* Forget the numbering of a map
+ */
+static void map_free_numbering(Map * map)
+{
+	map_free_islands(map);
+	g_free(map->numbering);
+	map->numbering = NULL;
+	map->hexes = NULL;
+	map->nodes = NULL;
+	map->edges = NULL;
+	map->node_edges = NULL;
+	map->edge_nodes = NULL;
+	map->num_hexes = 0;
+	map->num_nodes = 0;
+	map->num_edges = 0;
+}
+
+/* Size of the block with the numbering arrays
+ */
+static gsize numbering_size(const Map * map)
+{
+	return map->num_hexes * sizeof(*map->hexes)
+	    + map->num_nodes * sizeof(*map->nodes)
+	    + map->num_edges * sizeof(*map->edges)
+	    + map->num_nodes * sizeof(*map->node_edges)
+	    + map->num_edges * sizeof(*map->edge_nodes);
+}
+
+/* Allocate the block with the numbering arrays, for the current counts.
+ * The pointers come first, so each array is aligned.
+ */
+static void numbering_alloc(Map * map)
+{
+	gchar *block;
+
+	block = g_malloc(numbering_size(map));
+	map->numbering = block;
+	map->hexes = (Hex **) block;
+	block += map->num_hexes * sizeof(*map->hexes);
+	map->nodes = (Node **) block;
+	block += map->num_nodes * sizeof(*map->nodes);
+	map->edges = (Edge **) block;
+	block += map->num_edges * sizeof(*map->edges);
+	map->node_edges = (gint(*)[3]) block;
+	block += map->num_nodes * sizeof(*map->node_edges);
+	map->edge_nodes = (gint(*)[2]) block;
+}
+
+void map_number(Map * map)
+{
+	map_free_numbering(map);
+	map_traverse(map, count_network, map);
+	numbering_alloc(map);
+	map_traverse(map, index_network, map);
+	map->packed = FALSE;
+	map_label_islands(map);
+}
+
+/* Find the root of a node in the union-find forest, and halve the path
+ */
+static gint island_root(gint * parent, gint id)
+{
+	while (parent[id] != id) {
+		parent[id] = parent[parent[id]];
+		id = parent[id];
+	}
+	return id;
+}
+
+/* Size of the block with the island arrays
+ */
+static gsize islands_size(const Map * map)
+{
+	return (map->num_islands + 1) * sizeof(*map->island_start)
+	    + map->num_nodes * sizeof(*map->island_nodes);
+}
+
+/* Allocate the block with the island arrays, for the current counts.
+ */
+static void islands_alloc(Map * map)
+{
+	map->island_start = g_malloc(islands_size(map));
+	map->island_nodes =
+	    (gint *) (map->island_start + map->num_islands + 1);
+}
+
+/* Two nodes are on the same island when an edge on land joins them.
+ * Nodes that only touch the sea are not on an island.
+ */
+void map_label_islands(Map * map)
+{
+	gint *parent;
+	guint idx;
+	guint island;
+
+	map_free_islands(map);
+	parent = g_new(gint, MAX(map->num_nodes, 1));
+	for (idx = 0; idx < map->num_nodes; idx++)
+		parent[idx] = (gint) idx;
+	for (idx = 0; idx < map->num_edges; idx++) {
+		const gint *nodes = map->edge_nodes[idx];
+		gint root0, root1;
+
+		if (nodes[0] < 0 || nodes[1] < 0
+		    || !is_edge_on_land(map->edges[idx]))
+			continue;
+		root0 = island_root(parent, nodes[0]);
+		root1 = island_root(parent, nodes[1]);
+		/* The lowest id is the root, so the islands are in the
+		 * order of the grid */
+		if (root0 < root1)
+			parent[root1] = root0;
+		else
+			parent[root0] = root1;
+	}
+
+	/* Number the roots, and count the nodes of each island */
+	for (idx = 0; idx < map->num_nodes; idx++) {
+		Node *node = map->nodes[idx];
+
+		if (!is_node_on_land(node))
+			node->island = -1;
+		else if (island_root(parent, (gint) idx) == (gint) idx)
+			node->island = (gint) map->num_islands++;
+		else
+			node->island =
+			    map->nodes[island_root(parent, (gint) idx)]->
+			    island;
+	}
+	g_free(parent);
+
+	islands_alloc(map);
+	memset(map->island_start, 0,
+	       (map->num_islands + 1) * sizeof(*map->island_start));
+	for (idx = 0; idx < map->num_nodes; idx++)
+		if (map->nodes[idx]->island >= 0)
+			map->island_start[map->nodes[idx]->island + 1]++;
+	for (island = 0; island < map->num_islands; island++)
+		map->island_start[island + 1] += map->island_start[island];
+
+	/* Fill the islands, using the start of each island as the
+	 * position to fill, and shift the starts back afterwards */
+	for (idx = 0; idx < map->num_nodes; idx++) {
+		gint node_island = map->nodes[idx]->island;
+
+		if (node_island >= 0)
+			map->island_nodes[map->island_start
+					  [node_island]++] = (gint) idx;
+	}
+	for (island = map->num_islands; island > 0; island--)
+		map->island_start[island] = map->island_start[island - 1];
+	map->island_start[0] = 0;
+}
+
+/* The arena holds all hexes, then all nodes, then all edges */
+#define ARENA_HEXES(map) ((Hex *) (map)->arena)
+#define ARENA_NODES(map) ((Node *) (ARENA_HEXES(map) + (map)->num_hexes))
+#define ARENA_EDGES(map) ((Edge *) (ARENA_NODES(map) + (map)->num_nodes))
+
+/* Is the element allocated in the arena of the map?
+ */
+static gboolean map_owns(const Map * map, gconstpointer element)
+{
+	const gchar *start = map->arena;
+	const gchar *ptr = element;
+
+	return start != NULL && ptr >= start
+	    && ptr < start + map->arena_size;
+}
+
+/* Give the copy the numbering of the map, and an arena of the same size.
+ */
+static void arena_alloc(Map * copy, const Map * map)
+{
+	copy->num_hexes = map->num_hexes;
+	copy->num_nodes = map->num_nodes;
+	copy->num_edges = map->num_edges;
+	numbering_alloc(copy);
+	memcpy(copy->node_edges, map->node_edges,
+	       map->num_nodes * sizeof(*map->node_edges));
+	memcpy(copy->edge_nodes, map->edge_nodes,
+	       map->num_edges * sizeof(*map->edge_nodes));
+
+	copy->arena_size = map->num_hexes * sizeof(Hex)
+	    + map->num_nodes * sizeof(Node)
+	    + map->num_edges * sizeof(Edge);
+	copy->arena = g_malloc(copy->arena_size);
+}
+
+/* Move a pointer from the arena of the map to the arena of the copy */
+#define ARENA_RELOCATE(copy, map, ptr) \
+	((ptr) == NULL ? NULL : \
+	 (gpointer) ((gchar *) (copy)->arena + \
+		     ((const gchar *) (ptr) - (const gchar *) (map)->arena)))
+
+/* Fill the arena of the copy from a packed map: one memcpy, and then
+ * move the links to the arena of the copy.
+ */
+static void arena_relocate(Map * copy, const Map * map)
+{
+	Hex *hexes = ARENA_HEXES(copy);
+	Node *nodes = ARENA_NODES(copy);
+	Edge *edges = ARENA_EDGES(copy);
+	guint idx;
+	guint side;
+
+	memcpy(copy->arena, map->arena, copy->arena_size);
+	for (idx = 0; idx < copy->num_hexes; idx++)
+		for (side = 0; side < 6; side++) {
+			hexes[idx].nodes[side] =
+			    ARENA_RELOCATE(copy, map,
+					   hexes[idx].nodes[side]);
+			hexes[idx].edges[side] =
+			    ARENA_RELOCATE(copy, map,
+					   hexes[idx].edges[side]);
+		}
+	for (idx = 0; idx < copy->num_nodes; idx++)
+		for (side = 0; side < 3; side++) {
+			nodes[idx].hexes[side] =
+			    ARENA_RELOCATE(copy, map,
+					   nodes[idx].hexes[side]);
+			nodes[idx].edges[side] =
+			    ARENA_RELOCATE(copy, map,
+					   nodes[idx].edges[side]);
+		}
+	for (idx = 0; idx < copy->num_edges; idx++)
+		for (side = 0; side < 2; side++) {
+			edges[idx].hexes[side] =
+			    ARENA_RELOCATE(copy, map,
+					   edges[idx].hexes[side]);
+			edges[idx].nodes[side] =
+			    ARENA_RELOCATE(copy, map,
+					   edges[idx].nodes[side]);
+		}
+}
+
+/* The element with the same id in the arena */
+#define ARENA_LINK(array, element) \
+	((element) == NULL ? NULL : &(array)[(element)->id])
+
+/* Fill the arena of the copy from a map that is not packed: gather the
+ * elements by id, and link them by id.
+ */
+static void arena_gather(Map * copy, const Map * map)
+{
+	Hex *hexes = ARENA_HEXES(copy);
+	Node *nodes = ARENA_NODES(copy);
+	Edge *edges = ARENA_EDGES(copy);
+	guint idx;
+	guint side;
+
+	for (idx = 0; idx < copy->num_hexes; idx++) {
+		const Hex *hex = map->hexes[idx];
+
+		hexes[idx] = *hex;
+		for (side = 0; side < 6; side++) {
+			hexes[idx].nodes[side] =
+			    ARENA_LINK(nodes, hex->nodes[side]);
+			hexes[idx].edges[side] =
+			    ARENA_LINK(edges, hex->edges[side]);
+		}
+	}
+	for (idx = 0; idx < copy->num_nodes; idx++) {
+		const Node *node = map->nodes[idx];
+
+		nodes[idx] = *node;
+		for (side = 0; side < 3; side++) {
+			nodes[idx].hexes[side] =
+			    ARENA_LINK(hexes, node->hexes[side]);
+			nodes[idx].edges[side] =
+			    ARENA_LINK(edges, node->edges[side]);
+		}
+	}
+	for (idx = 0; idx < copy->num_edges; idx++) {
+		const Edge *edge = map->edges[idx];
+
+		edges[idx] = *edge;
+		for (side = 0; side < 2; side++) {
+			edges[idx].hexes[side] =
+			    ARENA_LINK(hexes, edge->hexes[side]);
+			edges[idx].nodes[side] =
+			    ARENA_LINK(nodes, edge->nodes[side]);
+		}
+	}
+}
+
+/* Point the copy to the elements in its arena.
+ */
+static void arena_finish(Map * copy, const Map * map)
+{
+	Hex *hexes = ARENA_HEXES(copy);
+	Node *nodes = ARENA_NODES(copy);
+	Edge *edges = ARENA_EDGES(copy);
+	guint idx;
+
+	memset(copy->grid, 0, sizeof(copy->grid));
+	for (idx = 0; idx < copy->num_hexes; idx++) {
+		hexes[idx].map = copy;
+		copy->hexes[idx] = &hexes[idx];
+		copy->grid[hexes[idx].y][hexes[idx].x] = &hexes[idx];
+	}
+	for (idx = 0; idx < copy->num_nodes; idx++) {
+		nodes[idx].map = copy;
+		copy->nodes[idx] = &nodes[idx];
+	}
+	for (idx = 0; idx < copy->num_edges; idx++) {
+		edges[idx].map = copy;
+		copy->edges[idx] = &edges[idx];
+	}
+	copy->robber_hex = ARENA_LINK(hexes, map->robber_hex);
+	copy->pirate_hex = ARENA_LINK(hexes, map->pirate_hex);
+	copy->packed = TRUE;
+}
+
+/* Move the elements of a numbered map into a new arena.
+ */
+static void map_pack(Map * map)
+{
+	Map old = *map;
+	guint idx;
+
+	arena_alloc(map, &old);
+	arena_gather(map, &old);
+	arena_finish(map, &old);
+
+	for (idx = 0; idx < old.num_hexes; idx++)
+		if (!map_owns(&old, old.hexes[idx]))
+			g_free(old.hexes[idx]);
+	for (idx = 0; idx < old.num_nodes; idx++)
+		if (!map_owns(&old, old.nodes[idx]))
+			g_free(old.nodes[idx]);
+	for (idx = 0; idx < old.num_edges; idx++)
+		if (!map_owns(&old, old.edges[idx]))
+			g_free(old.edges[idx]);
+	g_free(old.arena);
+	g_free(old.numbering);
+}
+
 /* Layout the dice chits on the map according to the order specified.
  * When laying out the chits, we do not place one on the desert hex.
  * The maps only specify the layout sequence. When loading the map,
@@ -641,8 +1040,9 @@ static gboolean layout_chits(Map * map)
 /* Randomise a map.  We do this by shuffling all of the land hexes,
  * and randomly reassigning port types.  This is the procedure
  * described in the board game rules.
+ * The random numbers are taken from rand_ctx.
  */
-void map_shuffle_terrain(Map * map)
+void map_shuffle_terrain(Map * map, GRand * rand_ctx)
 {
 	gint terrain_count[LAST_TERRAIN];
 	gint port_count[ANY_RESOURCE + 1];
@@ -693,7 +1093,8 @@ void map_shuffle_terrain(Map * map)
 			if (hex->terrain == SEA_TERRAIN) {
 				if (hex->resource == NO_RESOURCE)
 					continue;
-				num = random_guint(num_port);
+				num = random_guint_context(rand_ctx,
+							   num_port);
 				for (idx = 0;
 				     idx < G_N_ELEMENTS(port_count);
 				     idx++) {
@@ -705,7 +1106,8 @@ void map_shuffle_terrain(Map * map)
 				num_port--;
 				hex->resource = idx;
 			} else {
-				num = random_guint(num_terrain);
+				num = random_guint_context(rand_ctx,
+							   num_terrain);
 				for (idx = 0;
 				     idx < G_N_ELEMENTS(terrain_count);
 				     idx++) {
@@ -723,6 +1125,7 @@ void map_shuffle_terrain(Map * map)
 	/* Fix the chits - the desert probably moved
 	 */
 	layout_chits(map);
+	map_label_islands(map);
 }
 
 Hex *map_robber_hex(Map * map)
@@ -778,51 +1181,6 @@ static Hex *hex_new(Map * map, gint x, gint y)
 	return hex;
 }
 
-/** Copy a hex.
- * @param map The new owner
- * @param hex The original hex
- * @return A copy of the original hex, with the new owner.
- *         The copy is not connected (nodes and edges are NULL)
-*/
-static Hex *copy_hex(Map * map, const Hex * hex)
-{
-	Hex *copy;
-
-	if (hex == NULL)
-		return NULL;
-	copy = g_malloc0(sizeof(*copy));
-	copy->map = map;
-	copy->y = hex->y;
-	copy->x = hex->x;
-	copy->terrain = hex->terrain;
-	copy->resource = hex->resource;
-	copy->facing = hex->facing;
-	copy->chit_pos = hex->chit_pos;
-	copy->roll = hex->roll;
-	copy->robber = hex->robber;
-	copy->shuffle = hex->shuffle;
-
-	return copy;
-}
-
-static gboolean set_nosetup_nodes(const Hex * hex, gpointer closure)
-{
-	guint idx;
-	Map *copy = closure;
-	for (idx = 0; idx < G_N_ELEMENTS(hex->nodes); ++idx) {
-		const Node *node = hex->nodes[idx];
-		/* only handle nodes which are owned by the hex, to
-		 * prevent doing every node three times */
-		if (hex->x != node->x || hex->y != node->y)
-			continue;
-		g_assert(map_node(copy, node->x, node->y, node->pos) !=
-			 NULL);
-		map_node(copy, node->x, node->y, node->pos)->no_setup =
-		    node->no_setup;
-	}
-	return FALSE;
-}
-
 static GArray *copy_int_list(GArray * array)
 {
 	GArray *copy;
@@ -838,32 +1196,37 @@ static GArray *copy_int_list(GArray * array)
 	return copy;
 }
 
-/* Make a copy of an existing map
+/* Make a copy of an existing map.
+ * The layout is copied, the buildings are not.
  */
 Map *map_copy(const Map * map)
 {
 	Map *copy = map_new();
-	int x, y;
+	guint idx;
 
 	copy->y = map->y;
 	copy->x_size = map->x_size;
 	copy->y_size = map->y_size;
-	for (y = 0; y < MAP_SIZE; y++)
-		for (x = 0; x < MAP_SIZE; x++)
-			copy->grid[y][x] = copy_hex(copy, map->grid[y][x]);
-	map_traverse(copy, build_network, NULL);
-	map_traverse(copy, connect_network, NULL);
-	map_traverse_const(map, set_nosetup_nodes, copy);
-	if (map->robber_hex == NULL)
-		copy->robber_hex = NULL;
-	else
-		copy->robber_hex =
-		    copy->grid[map->robber_hex->y][map->robber_hex->x];
-	if (map->pirate_hex == NULL)
-		copy->pirate_hex = NULL;
+	arena_alloc(copy, map);
+	if (map->packed)
+		arena_relocate(copy, map);
 	else
-		copy->pirate_hex =
-		    copy->grid[map->pirate_hex->y][map->pirate_hex->x];
+		arena_gather(copy, map);
+	arena_finish(copy, map);
+	copy->num_islands = map->num_islands;
+	islands_alloc(copy);
+	memcpy(copy->island_start, map->island_start, islands_size(map));
+	for (idx = 0; idx < copy->num_nodes; idx++) {
+		Node *node = copy->nodes[idx];
+		node->owner = -1;
+		node->type = BUILD_NONE;
+		node->city_wall = FALSE;
+	}
+	for (idx = 0; idx < copy->num_edges; idx++) {
+		Edge *edge = copy->edges[idx];
+		edge->owner = -1;
+		edge->type = BUILD_NONE;
+	}
 	copy->shrink_left = map->shrink_left;
 	copy->shrink_right = map->shrink_right;
 	copy->has_moved_ship = map->has_moved_ship;
@@ -1138,6 +1501,8 @@ gboolean map_parse_finish(Map * map)
 			map->shrink_right = FALSE;
 			break;
 		}
+	map_number(map);
+	map_pack(map);
 	return success;
 }
 
@@ -1163,7 +1528,8 @@ static void hex_free(Hex * hex)
 			} else {
 				set_cc_node_edge(hex, idx, NULL);
 				set_cw_node_edge(hex, idx, NULL);
-				g_free(edge);
+				if (!map_owns(hex->map, edge))
+					g_free(edge);
 				continue;
 			}
 		}
@@ -1185,7 +1551,8 @@ static void hex_free(Hex * hex)
 				node->y = get_cw_hex(hex, idx)->y;
 				node->pos = (node->pos + 2) % 6;
 			} else {
-				g_free(node);
+				if (!map_owns(hex->map, node))
+					g_free(node);
 				continue;
 			}
 		}
@@ -1194,7 +1561,8 @@ static void hex_free(Hex * hex)
 	/* Remove from the grid */
 	if (hex->map->grid[hex->y][hex->x] == hex)
 		hex->map->grid[hex->y][hex->x] = NULL;
-	g_free(hex);
+	if (!map_owns(hex->map, hex))
+		g_free(hex);
 }
 
 
@@ -1211,7 +1579,11 @@ void map_free(Map * map)
 	if (map == NULL) {
 		return;
 	}
-	map_traverse(map, free_hex, NULL);
+	/* A packed map has no separately allocated elements */
+	if (!map->packed)
+		map_traverse(map, free_hex, NULL);
+	map_free_numbering(map);
+	g_free(map->arena);
 	if (map->chits != NULL) {
 		g_array_free(map->chits, TRUE);
 	}
@@ -1232,6 +1604,7 @@ void map_reset_hex(Map * map, gint x, gint y)
 	if (!hex) {
 		/* Create a new hex on the previously empty place */
 		hex = hex_new(map, x, y);
+		map_number(map);
 	}
 
 	g_return_if_fail(hex != NULL);
@@ -1252,6 +1625,7 @@ void map_reset_hex(Map * map, gint x, gint y)
 			adjacent->facing = 0;
 		};
 	};
+	map_label_islands(map);
 }
 
 void map_modify_row_count(Map * map, MapModify type,
@@ -1393,6 +1767,7 @@ void map_modify_row_count(Map * map, MapModify type,
 		};
 		map->y_size--;
 	}
+	map_number(map);
 }
 
 void map_modify_column_count(Map * map, MapModify type,
@@ -1468,6 +1843,7 @@ void map_modify_column_count(Map * map, MapModify type,
 		};
 		map->shrink_right = !map->shrink_right;
 	}
+	map_number(map);
 }
 
 /** Move a hex in the given direction.
@@ -110,6 +110,8 @@ struct _Hex {
 	gint roll;		/* 2..12 number allocated to hex */
 	gboolean robber;	/* is the robber here */
 	gboolean shuffle;	/* can the hex be shuffled? */
+
+	gint id;		/* index in map->hexes */
 };
 
 struct _Node {
@@ -123,9 +125,11 @@ struct _Node {
 	gint owner;		/* building owner, -1 == no building */
 	BuildType type;		/* type of node (if owner defined) */
 
-	gboolean visited;	/* used for longest road */
 	gboolean no_setup;	/* setup is not allowed on this node */
 	gboolean city_wall;	/* has city wall */
+
+	gint id;		/* index in map->nodes */
+	gint island;		/* island of the node, -1 == at sea */
 };
 
 struct _Edge {
@@ -139,7 +143,7 @@ struct _Edge {
 	gint owner;		/* road owner, -1 == no road */
 	BuildType type;		/* type of edge (if owner defined) */
 
-	gboolean visited;	/* used for longest road */
+	gint id;		/* index in map->edges */
 };
 
 /* All of the hexes are stored in a 2 dimensional array laid out as
@@ -162,8 +166,39 @@ struct _Map {
 	gboolean shrink_left;	/* shrink left x-margin? */
 	gboolean shrink_right;	/* shrink right x-margin? */
 	GArray *chits;		/* chit number sequence */
+
+	/* The hexes, nodes and edges numbered 0..num-1, see map_number */
+	guint num_hexes;
+	guint num_nodes;
+	guint num_edges;
+	Hex **hexes;		/* hex by id */
+	Node **nodes;		/* node by id */
+	Edge **edges;		/* edge by id */
+	gint (*node_edges)[3];	/* edges of a node by id, -1 == none */
+	gint (*edge_nodes)[2];	/* nodes of an edge by id, -1 == none */
+	gpointer numbering;	/* the block that holds the arrays above */
+
+	/* The islands numbered 0..num_islands-1, see map_label_islands */
+	guint num_islands;
+	guint *island_start;	/* first entry in island_nodes, by island */
+	gint *island_nodes;	/* ids of the nodes, grouped by island */
+
+	/* The hexes, nodes and edges of a parsed or copied map are
+	 * allocated in one block.  Changes to the layout allocate the
+	 * new elements separately. */
+	gpointer arena;		/* hexes, then nodes, then edges */
+	gsize arena_size;	/* size of the arena in bytes */
+	gboolean packed;	/* all elements are in the arena, by id */
 };
 
+/** A set of ids of the hexes, nodes or edges of a map.
+ * It is an array of MAP_SET_WORDS(num) guint32.
+ */
+#define MAP_SET_WORDS(num) (((num) + 31) / 32)
+#define MAP_SET_TEST(set, id) (((set)[(id) / 32] >> ((id) % 32)) & 1)
+#define MAP_SET_ADD(set, id) ((set)[(id) / 32] |= 1u << ((id) % 32))
+#define MAP_SET_REMOVE(set, id) ((set)[(id) / 32] &= ~(1u << ((id) % 32)))
+
 typedef struct {
 	gint owner;
 	gboolean any_resource;
@@ -194,7 +229,7 @@ gboolean map_traverse(Map * map, HexFunc func, gpointer closure);
 typedef gboolean(*ConstHexFunc) (const Hex * hex, gpointer closure);
 gboolean map_traverse_const(const Map * map, ConstHexFunc func,
 			    gpointer closure);
-void map_shuffle_terrain(Map * map);
+void map_shuffle_terrain(Map * map, GRand * rand_ctx);
 Hex *map_robber_hex(Map * map);
 Hex *map_pirate_hex(Map * map);
 void map_move_robber(Map * map, gint x, gint y);
@@ -205,6 +240,21 @@ Map *map_copy(const Map * map);
 gchar *map_format_line(Map * map, gboolean write_secrets, gint y);
 gboolean map_parse_line(Map * map, const gchar * line);
 gboolean map_parse_finish(Map * map);
+/** Number the hexes, nodes and edges of a map, in the order of the grid.
+ * It is done by map_parse_finish and map_copy, and by the functions that
+ * change the layout of a map.  The ids are valid until the layout
+ * changes again.  Hexes, nodes and edges that are not in the arena of
+ * the map must have been allocated with g_malloc.
+ * @param map The map
+ */
+void map_number(Map * map);
+/** Find the islands of a map, and set the island of each node.
+ * It is done by map_number and map_shuffle_terrain, and must be done
+ * again when the terrain of a hex changes.  The nodes of island i are
+ * island_nodes[island_start[i]] .. island_nodes[island_start[i + 1] - 1].
+ * @param map The map
+ */
+void map_label_islands(Map * map);
 void map_free(Map * map);
 
 typedef enum {
@@ -296,8 +346,143 @@ gboolean map_bridge_connect_ok(const Map * map, gint owner, gint x, gint y,
 			       gint pos);
 /* information gathering */
 void map_longest_road(Map * map, guint * lengths, guint num_players);
+
+/** Index of the road networks on a map.
+ * It finds the longest roads like map_longest_road, but only searches
+ * again the networks that have changed.
+ */
+typedef struct _RoadIndex RoadIndex;
+
+/** Create the index for a map.
+ * The layout of the map must not change while the index exists.
+ * @param map The map
+ * @return The index, free with road_index_free
+ */
+RoadIndex *road_index_new(Map * map);
+void road_index_free(RoadIndex * index);
+/** Report a change of the owner or type of an edge. */
+void road_index_edge_changed(RoadIndex * index, const Edge * edge);
+/** Report a change of the owner or type of a node. */
+void road_index_node_changed(RoadIndex * index, const Node * node);
+/** Find the longest road of each player.
+ * @param index The index
+ * @retval lengths The length for each player
+ * @param num_players The number of players
+ */
+void road_index_longest_road(RoadIndex * index, guint * lengths,
+			     guint num_players);
+
+/** A building that produces resources on a dice roll. */
+typedef struct {
+	const Hex *hex;		/* the producing hex */
+	const Node *node;	/* the building */
+	gint owner;		/* owner of the building */
+	gint amount;		/* 1 for a settlement, 2 for a city */
+} Production;
+
+/** Index of the production of the buildings, by dice roll.
+ * Hexes with the robber are left out.
+ */
+typedef struct _ProductionIndex ProductionIndex;
+
+/** Create the production index of a map.
+ * @param map The map
+ * @return The index, free with production_index_free
+ */
+ProductionIndex *production_index_new(const Map * map);
+void production_index_free(ProductionIndex * index);
+/** Report a change of the building on a node. */
+void production_index_node_changed(ProductionIndex * index,
+				   const Node * node);
+/** Report a move of the robber.
+ * @param index The index
+ * @param old_hex The previous location, or NULL
+ * @param new_hex The new location, or NULL
+ */
+void production_index_robber_moved(ProductionIndex * index,
+				   const Hex * old_hex,
+				   const Hex * new_hex);
+/** Get the buildings that produce on a roll.
+ * @param index The index
+ * @param roll The dice roll
+ * @retval num_entries The number of entries
+ * @return The entries, valid until the index changes
+ */
+const Production *production_index_lookup(const ProductionIndex * index,
+					  gint roll, guint * num_entries);
+
+/** Index of the legal building locations of each player.
+ * It answers the same questions as map_can_place_road and the other
+ * map_can_* queries, but only checks again the edges and nodes around
+ * the changes.
+ */
+typedef struct _FrontierIndex FrontierIndex;
+
+/** Create the index for a map.
+ * The layout of the map must not change while the index exists.
+ * @param map The map
+ * @param num_players The number of players
+ * @return The index, free with frontier_index_free
+ */
+FrontierIndex *frontier_index_new(const Map * map, guint num_players);
+void frontier_index_free(FrontierIndex * index);
+/** Report a change of the owner or type of an edge. */
+void frontier_index_edge_changed(FrontierIndex * index,
+				 const Edge * edge);
+/** Report a change of the owner, type or city wall of a node. */
+void frontier_index_node_changed(FrontierIndex * index,
+				 const Node * node);
+/** Report a move of the pirate.
+ * @param index The index
+ * @param old_hex The previous location, or NULL
+ * @param new_hex The new location, or NULL
+ */
+void frontier_index_pirate_moved(FrontierIndex * index,
+				 const Hex * old_hex, const Hex * new_hex);
+/** Get the locations where a player can build.
+ * BUILD_CITY means the upgrade of a settlement, as in
+ * map_can_upgrade_settlement.
+ * @param index The index
+ * @param owner The player
+ * @param type The type of building
+ * @retval count The number of locations
+ * @return The ids of the edges or nodes as a set (see MAP_SET_TEST),
+ *         valid until the next change, or NULL for an unknown player
+ */
+const guint32 *frontier_index_lookup(FrontierIndex * index, gint owner,
+				     BuildType type, guint * count);
+/** Is there any location where a player can build? */
+gboolean frontier_index_can_build(FrontierIndex * index, gint owner,
+				  BuildType type);
+/** Has the player built anything on the island of the node?
+ * It uses the labels of map_label_islands.
+ */
 gboolean map_is_island_discovered(Map * map, Node * node, gint owner);
+/** Find the ports of a player by looking at all hexes.
+ * During a game, port_index_maritime_info gives the same answer.
+ */
 void map_maritime_info(const Map * map, MaritimeInfo * info, gint owner);
+
+/** Index of the ports that each player has a building on.
+ */
+typedef struct _PortIndex PortIndex;
+
+/** Create the index for a map.
+ * The layout of the map must not change while the index exists.
+ * @param map The map
+ * @param num_players The number of players
+ * @return The index, free with port_index_free
+ */
+PortIndex *port_index_new(const Map * map, guint num_players);
+void port_index_free(PortIndex * index);
+/** Report a change of the building on a node. */
+void port_index_node_changed(PortIndex * index, const Node * node);
+/** Determine the maritime trading capacity of a player, as
+ * map_maritime_info does.
+ */
+void port_index_maritime_info(const PortIndex * index,
+			      MaritimeInfo * info, gint owner);
+/** The number of islands, as found by map_label_islands */
 guint map_count_islands(const Map * map);
 
 #endif
@@ -916,8 +916,15 @@ static BuildType bridge_as_road(BuildType type)
 		return type;
 }
 
+typedef struct {
+	gint *lengths;		/* longest road of each player */
+	guint32 *edge_visited;	/* edges on the current road */
+	guint32 *node_visited;	/* nodes on the current road */
+} LongestRoad;
+
 /* calculate the longest road */
-static gint find_longest_road_recursive(Edge * edge)
+static gint find_longest_road_recursive(LongestRoad * road,
+					const Edge * edge)
 {
 	gint len = 0;
 	guint nodeidx;
@@ -925,24 +932,25 @@ static gint find_longest_road_recursive(Edge * edge)
 
 	g_return_val_if_fail(edge != NULL, 0);
 
-	edge->visited = TRUE;
+	MAP_SET_ADD(road->edge_visited, edge->id);
 	/* check all nodes to see which one make the longer road. */
 	for (nodeidx = 0; nodeidx < G_N_ELEMENTS(edge->nodes); nodeidx++) {
-		Node *node = edge->nodes[nodeidx];
+		const Node *node = edge->nodes[nodeidx];
 		/* don't go back to where we came from */
-		if (node->visited)
+		if (MAP_SET_TEST(road->node_visited, node->id))
 			continue;
 		/* don't continue counting if someone else's building is on
 		 * the node. */
 		if (node->type != BUILD_NONE && node->owner != edge->owner)
 			continue;
 		/* don't let other go back here */
-		node->visited = TRUE;
+		MAP_SET_ADD(road->node_visited, node->id);
 		/* try all edges */
 		for (edgeidx = 0; edgeidx < G_N_ELEMENTS(node->edges);
 		     edgeidx++) {
-			Edge *here = node->edges[edgeidx];
-			if (here && !here->visited
+			const Edge *here = node->edges[edgeidx];
+			if (here
+			    && !MAP_SET_TEST(road->edge_visited, here->id)
 			    && here->owner == edge->owner) {
 				/* don't allow ships to extend roads, except
 				 * if there is a construction in between */
@@ -952,7 +960,7 @@ static gint find_longest_road_recursive(Edge * edge)
 				    bridge_as_road(edge->type)) {
 					gint thislen =
 					    find_longest_road_recursive
-					    (here);
+					    (road, here);
 					/* take the maximum of all paths */
 					if (thislen > len)
 						len = thislen;
@@ -960,18 +968,18 @@ static gint find_longest_road_recursive(Edge * edge)
 			}
 		}
 		/* Allow other roads to use this node again. */
-		node->visited = FALSE;
+		MAP_SET_REMOVE(road->node_visited, node->id);
 	}
-	edge->visited = FALSE;
+	MAP_SET_REMOVE(road->edge_visited, edge->id);
 	return len + 1;
 }
 
 static gboolean find_longest_road(Hex * hex, gpointer closure)
 {
 	guint idx;
-	gint *lengths = closure;
+	LongestRoad *road = closure;
 	g_return_val_if_fail(hex != NULL, FALSE);
-	g_return_val_if_fail(lengths != NULL, FALSE);
+	g_return_val_if_fail(road != NULL, FALSE);
 	for (idx = 0; idx < G_N_ELEMENTS(hex->edges); idx++) {
 		Edge *edge = hex->edges[idx];
 		gint len;
@@ -980,110 +988,758 @@ static gboolean find_longest_road(Hex * hex, gpointer closure)
 		if (edge->owner < 0 || edge->x != hex->x
 		    || edge->y != hex->y)
 			continue;
-		len = find_longest_road_recursive(edge);
-		if (len > lengths[edge->owner])
-			lengths[edge->owner] = len;
+		len = find_longest_road_recursive(road, edge);
+		if (len > road->lengths[edge->owner])
+			road->lengths[edge->owner] = len;
 	}
 	return FALSE;
 }
 
-/* Zero the visited attribute for all edges and nodes.
+/* Finding the longest road:
+ * 1 - start with empty sets of visited edges and nodes
+ * 2 - for every edge, find the longest road using this one as a tail
  */
-static gboolean zero_visited(Hex * hex, G_GNUC_UNUSED gpointer closure)
+void map_longest_road(Map * map, guint * lengths, guint num_players)
+{
+	LongestRoad road;
+
+	g_return_if_fail(map != NULL);
+	g_return_if_fail(lengths != NULL);
+	g_return_if_fail(num_players > 0);
+
+	memset(lengths, 0, num_players * sizeof(*lengths));
+	road.lengths = (gint *) lengths;
+	road.edge_visited = g_new0(guint32, MAP_SET_WORDS(map->num_edges));
+	road.node_visited = g_new0(guint32, MAP_SET_WORDS(map->num_nodes));
+	map_traverse(map, find_longest_road, &road);
+	g_free(road.edge_visited);
+	g_free(road.node_visited);
+}
+
+/* Incremental longest road
+ *
+ * The index works on the ids and the adjacency arrays of the map (see
+ * map_number).  The owned edges of each player are grouped into
+ * connected components.  When an edge or node changes, only the
+ * components that touch it are marked, and only those are searched
+ * again.  The search itself is the same as find_longest_road_recursive.
+ */
+
+typedef struct {
+	gint owner;		/* owner of all edges, -1 for a free slot */
+	guint length;		/* longest road in this component */
+	gboolean dirty;		/* length must be computed again */
+	GArray *edges;		/* indices of the edges */
+} RoadComponent;
+
+struct _RoadIndex {
+	/* The numbering of the map, see map_number */
+	guint num_edges;
+	guint num_nodes;
+	Edge *const *edges;
+	Node *const *nodes;
+	gint (*edge_nodes)[2];
+	gint (*node_edges)[3];
+
+	gint *edge_component;	/* component of an edge, -1 == not owned */
+	GArray *components;	/* all RoadComponent, including free slots */
+	GArray *changed_edges;	/* edges changed since the last query */
+	GArray *changed_nodes;	/* nodes changed since the last query */
+
+	guint32 *edge_visited;	/* visited set of the search */
+	guint32 *node_visited;	/* visited set of the search */
+};
+
+RoadIndex *road_index_new(Map * map)
 {
+	RoadIndex *index;
 	guint idx;
 
-	g_return_val_if_fail(hex != NULL, FALSE);
-	for (idx = 0; idx < G_N_ELEMENTS(hex->edges); idx++) {
-		Edge *edge = hex->edges[idx];
-		edge->visited = FALSE;
+	g_return_val_if_fail(map != NULL, NULL);
+
+	index = g_malloc0(sizeof(*index));
+	index->num_edges = map->num_edges;
+	index->num_nodes = map->num_nodes;
+	index->edges = map->edges;
+	index->nodes = map->nodes;
+	index->edge_nodes = map->edge_nodes;
+	index->node_edges = map->node_edges;
+
+	index->edge_component = g_new(gint, index->num_edges);
+	index->components = g_array_new(FALSE, FALSE,
+					sizeof(RoadComponent));
+	index->changed_edges = g_array_new(FALSE, FALSE, sizeof(gint));
+	index->changed_nodes = g_array_new(FALSE, FALSE, sizeof(gint));
+	index->edge_visited = g_new0(guint32,
+				     MAP_SET_WORDS(index->num_edges));
+	index->node_visited = g_new0(guint32,
+				     MAP_SET_WORDS(index->num_nodes));
+
+	/* The map can already contain roads */
+	for (idx = 0; idx < index->num_edges; idx++) {
+		index->edge_component[idx] = -1;
+		g_array_append_val(index->changed_edges, idx);
 	}
-	for (idx = 0; idx < G_N_ELEMENTS(hex->nodes); idx++) {
-		Node *node = hex->nodes[idx];
-		node->visited = FALSE;
+	return index;
+}
+
+void road_index_free(RoadIndex * index)
+{
+	guint idx;
+
+	if (index == NULL)
+		return;
+
+	for (idx = 0; idx < index->components->len; idx++) {
+		RoadComponent *component =
+		    &g_array_index(index->components, RoadComponent, idx);
+		if (component->edges != NULL)
+			g_array_free(component->edges, TRUE);
 	}
+	g_array_free(index->components, TRUE);
+	g_array_free(index->changed_edges, TRUE);
+	g_array_free(index->changed_nodes, TRUE);
+	g_free(index->edge_component);
+	g_free(index->edge_visited);
+	g_free(index->node_visited);
+	g_free(index);
+}
 
-	return FALSE;
+void road_index_edge_changed(RoadIndex * index, const Edge * edge)
+{
+	gint id;
+
+	g_return_if_fail(index != NULL);
+	g_return_if_fail(edge != NULL);
+
+	id = edge->id;
+	g_return_if_fail(id >= 0 && (guint) id < index->num_edges);
+	g_array_append_val(index->changed_edges, id);
 }
 
-/* Finding the longest road:
- * 1 - set the visited attribute of all edges and nodes to FALSE
- * 2 - for every edge, find the longest road using this one as a tail
- */
-void map_longest_road(Map * map, guint * lengths, guint num_players)
+void road_index_node_changed(RoadIndex * index, const Node * node)
 {
-	g_return_if_fail(map != NULL);
+	gint id;
+
+	g_return_if_fail(index != NULL);
+	g_return_if_fail(node != NULL);
+
+	id = node->id;
+	g_return_if_fail(id >= 0 && (guint) id < index->num_nodes);
+	g_array_append_val(index->changed_nodes, id);
+}
+
+/* Release a component, its edges are added to seeds */
+static void road_index_release(RoadIndex * index, gint component_id,
+			       GArray * seeds)
+{
+	RoadComponent *component =
+	    &g_array_index(index->components, RoadComponent, component_id);
+	guint idx;
+
+	for (idx = 0; idx < component->edges->len; idx++) {
+		gint edge_id = g_array_index(component->edges, gint, idx);
+		index->edge_component[edge_id] = -1;
+		if (seeds != NULL)
+			g_array_append_val(seeds, edge_id);
+	}
+	g_array_set_size(component->edges, 0);
+	component->owner = -1;
+}
+
+static gint road_index_new_component(RoadIndex * index, gint owner)
+{
+	RoadComponent *component;
+	guint idx;
+
+	for (idx = 0; idx < index->components->len; idx++) {
+		component =
+		    &g_array_index(index->components, RoadComponent, idx);
+		if (component->owner < 0)
+			break;
+	}
+	if (idx == index->components->len) {
+		g_array_set_size(index->components, idx + 1);
+		component =
+		    &g_array_index(index->components, RoadComponent, idx);
+		component->edges =
+		    g_array_new(FALSE, FALSE, sizeof(gint));
+	}
+	component->owner = owner;
+	component->length = 0;
+	component->dirty = TRUE;
+	return (gint) idx;
+}
+
+/* Collect all owned edges that are connected to the seed in a new
+ * component.  Components that are reached are merged into it. */
+static void road_index_flood(RoadIndex * index, gint seed)
+{
+	gint owner = index->edges[seed]->owner;
+	gint component_id = road_index_new_component(index, owner);
+	GArray *stack = g_array_new(FALSE, FALSE, sizeof(gint));
+
+	index->edge_component[seed] = component_id;
+	g_array_append_val(stack, seed);
+	while (stack->len > 0) {
+		gint edge_id = g_array_index(stack, gint, stack->len - 1);
+		guint side;
+
+		g_array_set_size(stack, stack->len - 1);
+		g_array_append_val(g_array_index
+				   (index->components, RoadComponent,
+				    component_id).edges, edge_id);
+		for (side = 0; side < 2; side++) {
+			gint node_id = index->edge_nodes[edge_id][side];
+			guint idx;
+
+			for (idx = 0; idx < 3; idx++) {
+				gint next = index->node_edges[node_id][idx];
+				if (next < 0
+				    || index->edges[next]->owner != owner
+				    || index->edge_component[next] ==
+				    component_id)
+					continue;
+				if (index->edge_component[next] >= 0)
+					road_index_release(index,
+							   index->edge_component
+							   [next], NULL);
+				index->edge_component[next] = component_id;
+				g_array_append_val(stack, next);
+			}
+		}
+	}
+	g_array_free(stack, TRUE);
+}
+
+/* The same search as find_longest_road_recursive */
+static guint road_index_search(RoadIndex * index, gint edge_id)
+{
+	const Edge *edge = index->edges[edge_id];
+	guint len = 0;
+	guint side;
+
+	MAP_SET_ADD(index->edge_visited, edge_id);
+	for (side = 0; side < 2; side++) {
+		gint node_id = index->edge_nodes[edge_id][side];
+		const Node *node = index->nodes[node_id];
+		guint idx;
+
+		/* don't go back to where we came from */
+		if (MAP_SET_TEST(index->node_visited, node_id))
+			continue;
+		/* don't continue counting if someone else's building is on
+		 * the node. */
+		if (node->type != BUILD_NONE && node->owner != edge->owner)
+			continue;
+		MAP_SET_ADD(index->node_visited, node_id);
+		for (idx = 0; idx < 3; idx++) {
+			gint next = index->node_edges[node_id][idx];
+			const Edge *here;
+
+			if (next < 0
+			    || MAP_SET_TEST(index->edge_visited, next))
+				continue;
+			here = index->edges[next];
+			if (here->owner != edge->owner)
+				continue;
+			/* ships only extend roads through a construction,
+			 * bridges are treated as roads */
+			if (node->type != BUILD_NONE ||
+			    bridge_as_road(here->type) ==
+			    bridge_as_road(edge->type)) {
+				guint thislen =
+				    road_index_search(index, next);
+				if (thislen > len)
+					len = thislen;
+			}
+		}
+		MAP_SET_REMOVE(index->node_visited, node_id);
+	}
+	MAP_SET_REMOVE(index->edge_visited, edge_id);
+	return len + 1;
+}
+
+/* Bring the components up to date with the changes */
+static void road_index_update(RoadIndex * index)
+{
+	GArray *seeds;
+	guint idx;
+
+	seeds = g_array_new(FALSE, FALSE, sizeof(gint));
+	for (idx = 0; idx < index->changed_edges->len; idx++) {
+		gint edge_id = g_array_index(index->changed_edges, gint,
+					     idx);
+		/* the old component can be split or have another owner */
+		if (index->edge_component[edge_id] >= 0)
+			road_index_release(index,
+					   index->edge_component[edge_id],
+					   seeds);
+		g_array_append_val(seeds, edge_id);
+	}
+	g_array_set_size(index->changed_edges, 0);
+
+	for (idx = 0; idx < seeds->len; idx++) {
+		gint edge_id = g_array_index(seeds, gint, idx);
+		if (index->edges[edge_id]->owner >= 0
+		    && index->edge_component[edge_id] < 0)
+			road_index_flood(index, edge_id);
+	}
+	g_array_free(seeds, TRUE);
+
+	/* A building can cut or join roads of every player */
+	for (idx = 0; idx < index->changed_nodes->len; idx++) {
+		gint node_id = g_array_index(index->changed_nodes, gint,
+					     idx);
+		guint side;
+
+		for (side = 0; side < 3; side++) {
+			gint edge_id = index->node_edges[node_id][side];
+			if (edge_id >= 0
+			    && index->edge_component[edge_id] >= 0)
+				g_array_index(index->components,
+					      RoadComponent,
+					      index->edge_component
+					      [edge_id]).dirty = TRUE;
+		}
+	}
+	g_array_set_size(index->changed_nodes, 0);
+
+	for (idx = 0; idx < index->components->len; idx++) {
+		RoadComponent *component =
+		    &g_array_index(index->components, RoadComponent, idx);
+		guint edge_idx;
+
+		if (component->owner < 0 || !component->dirty)
+			continue;
+		component->length = 0;
+		for (edge_idx = 0; edge_idx < component->edges->len;
+		     edge_idx++) {
+			guint len = road_index_search(index,
+						      g_array_index
+						      (component->edges,
+						       gint, edge_idx));
+			if (len > component->length)
+				component->length = len;
+		}
+		component->dirty = FALSE;
+	}
+}
+
+void road_index_longest_road(RoadIndex * index, guint * lengths,
+			     guint num_players)
+{
+	guint idx;
+
+	g_return_if_fail(index != NULL);
 	g_return_if_fail(lengths != NULL);
 	g_return_if_fail(num_players > 0);
 
-	map_traverse(map, zero_visited, NULL);
+	road_index_update(index);
+
 	memset(lengths, 0, num_players * sizeof(*lengths));
-	map_traverse(map, find_longest_road, lengths);
+	for (idx = 0; idx < index->components->len; idx++) {
+		const RoadComponent *component =
+		    &g_array_index(index->components, RoadComponent, idx);
+		if (component->owner < 0
+		    || (guint) component->owner >= num_players)
+			continue;
+		if (component->length > lengths[component->owner])
+			lengths[component->owner] = component->length;
+	}
 }
 
-static gboolean map_island_recursive(Map * map, Node * node, gint owner)
+/* Production index
+ *
+ * For each dice roll, the buildings that produce on that roll.  The
+ * entries of a hex are replaced whenever a building next to it changes,
+ * or the robber enters or leaves it.
+ */
+
+#define PRODUCTION_MIN_ROLL 2
+#define PRODUCTION_MAX_ROLL 12
+
+struct _ProductionIndex {
+	/* Production entries, by roll */
+	GArray *rolls[PRODUCTION_MAX_ROLL + 1];
+};
+
+/* Remove the entries of the hex, and add them again for the current
+ * buildings */
+static void production_index_update_hex(ProductionIndex * index,
+					const Hex * hex)
 {
+	GArray *entries;
 	guint idx;
-	gboolean discovered;
 
-	g_return_val_if_fail(map != NULL, FALSE);
+	if (hex->roll < PRODUCTION_MIN_ROLL
+	    || hex->roll > PRODUCTION_MAX_ROLL)
+		return;
 
-	if (node == NULL)
-		return FALSE;
-	if (node->owner == owner)
-		return TRUE;	/* Already discovered */
-	if (node->visited)
-		return FALSE;	/* Not discovered */
-	node->visited = TRUE;
-
-	discovered = FALSE;
-	for (idx = 0; idx < G_N_ELEMENTS(node->edges) && !discovered;
-	     idx++) {
-		gint num_sea;
-		guint idx2;
-		Edge *edge = node->edges[idx];
-		if (edge == NULL)
+	entries = index->rolls[hex->roll];
+	idx = 0;
+	while (idx < entries->len) {
+		if (g_array_index(entries, Production, idx).hex == hex)
+			g_array_remove_index_fast(entries, idx);
+		else
+			idx++;
+	}
+
+	if (hex->robber)
+		return;
+	for (idx = 0; idx < G_N_ELEMENTS(hex->nodes); idx++) {
+		const Node *node = hex->nodes[idx];
+		Production entry;
+
+		if (node == NULL || node->type == BUILD_NONE)
 			continue;
-		if (edge->visited)
+		entry.hex = hex;
+		entry.node = node;
+		entry.owner = node->owner;
+		entry.amount = (node->type == BUILD_CITY) ? 2 : 1;
+		g_array_append_val(entries, entry);
+	}
+}
+
+static gboolean production_index_add_hex(const Hex * hex,
+					 gpointer closure)
+{
+	production_index_update_hex(closure, hex);
+	return FALSE;
+}
+
+ProductionIndex *production_index_new(const Map * map)
+{
+	ProductionIndex *index;
+	guint roll;
+
+	g_return_val_if_fail(map != NULL, NULL);
+
+	index = g_malloc0(sizeof(*index));
+	for (roll = PRODUCTION_MIN_ROLL; roll <= PRODUCTION_MAX_ROLL; roll++)
+		index->rolls[roll] =
+		    g_array_new(FALSE, FALSE, sizeof(Production));
+	map_traverse_const(map, production_index_add_hex, index);
+	return index;
+}
+
+void production_index_free(ProductionIndex * index)
+{
+	guint roll;
+
+	if (index == NULL)
+		return;
+
+	for (roll = PRODUCTION_MIN_ROLL; roll <= PRODUCTION_MAX_ROLL; roll++)
+		g_array_free(index->rolls[roll], TRUE);
+	g_free(index);
+}
+
+void production_index_node_changed(ProductionIndex * index,
+				   const Node * node)
+{
+	guint idx;
+
+	g_return_if_fail(index != NULL);
+	g_return_if_fail(node != NULL);
+
+	for (idx = 0; idx < G_N_ELEMENTS(node->hexes); idx++) {
+		if (node->hexes[idx] != NULL)
+			production_index_update_hex(index,
+						    node->hexes[idx]);
+	}
+}
+
+void production_index_robber_moved(ProductionIndex * index,
+				   const Hex * old_hex,
+				   const Hex * new_hex)
+{
+	g_return_if_fail(index != NULL);
+
+	if (old_hex != NULL)
+		production_index_update_hex(index, old_hex);
+	if (new_hex != NULL && new_hex != old_hex)
+		production_index_update_hex(index, new_hex);
+}
+
+const Production *production_index_lookup(const ProductionIndex * index,
+					  gint roll, guint * num_entries)
+{
+	g_return_val_if_fail(index != NULL, NULL);
+	g_return_val_if_fail(num_entries != NULL, NULL);
+
+	if (roll < PRODUCTION_MIN_ROLL || roll > PRODUCTION_MAX_ROLL) {
+		*num_entries = 0;
+		return NULL;
+	}
+	*num_entries = index->rolls[roll]->len;
+	return (const Production *) index->rolls[roll]->data;
+}
+
+/* Legal building locations
+ *
+ * The frontier of a player is the set of edges and nodes where the
+ * player can build, for each type, with its size.  A change of an edge
+ * or a node can only change the legality of the edges and nodes around
+ * it, so only those are checked again.  The changes are collected, and
+ * handled by the next query.
+ */
+
+struct _FrontierIndex {
+	const Map *map;
+	guint num_players;
+	guint32 *sets[NUM_BUILD_TYPES];	/* per player, ids of legal spots */
+	guint *counts[NUM_BUILD_TYPES];	/* per player, size of the set */
+	guint words[NUM_BUILD_TYPES];	/* size of a set of one player */
+	GArray *changed_edges;	/* edges changed since the last query */
+	GArray *changed_nodes;	/* nodes changed since the last query */
+};
+
+static const BuildType frontier_edge_types[] = {
+	BUILD_ROAD, BUILD_SHIP, BUILD_BRIDGE
+};
+
+static const BuildType frontier_node_types[] = {
+	BUILD_SETTLEMENT, BUILD_CITY, BUILD_CITY_WALL
+};
+
+static gboolean frontier_is_legal(const Map * map, BuildType type,
+				  gint id, gint owner)
+{
+	switch (type) {
+	case BUILD_ROAD:
+		return can_road_be_built(map->edges[id], owner);
+	case BUILD_SHIP:
+		return can_ship_be_built(map->edges[id], owner);
+	case BUILD_BRIDGE:
+		return can_bridge_be_built(map->edges[id], owner);
+	case BUILD_SETTLEMENT:
+		return can_settlement_be_built(map->nodes[id], owner);
+	case BUILD_CITY:
+		return can_settlement_be_upgraded(map->nodes[id], owner);
+	case BUILD_CITY_WALL:
+		return can_city_wall_be_built(map->nodes[id], owner);
+	default:
+		return FALSE;
+	}
+}
+
+/* Check one spot again for all players */
+static void frontier_update(FrontierIndex * index, BuildType type,
+			    gint id)
+{
+	guint owner;
+
+	for (owner = 0; owner < index->num_players; owner++) {
+		guint32 *set =
+		    index->sets[type] + owner * index->words[type];
+		gboolean legal =
+		    frontier_is_legal(index->map, type, id, (gint) owner);
+
+		if (legal == (gboolean) MAP_SET_TEST(set, id))
 			continue;
-		edge->visited = TRUE;
-
-		/* If the edge points into the sea, or along the border,
-		 * don't follow it */
-		num_sea = 0;
-		for (idx2 = 0; idx2 < G_N_ELEMENTS(edge->hexes); idx2++) {
-			const Hex *hex = edge->hexes[idx2];
-			if (hex == NULL) {
-				num_sea++;
+		if (legal) {
+			MAP_SET_ADD(set, id);
+			index->counts[type][owner]++;
+		} else {
+			MAP_SET_REMOVE(set, id);
+			index->counts[type][owner]--;
+		}
+	}
+}
+
+static void frontier_update_edge(FrontierIndex * index, const Edge * edge)
+{
+	guint idx;
+
+	for (idx = 0; idx < G_N_ELEMENTS(frontier_edge_types); idx++)
+		frontier_update(index, frontier_edge_types[idx], edge->id);
+}
+
+static void frontier_update_node(FrontierIndex * index, const Node * node)
+{
+	guint idx;
+
+	for (idx = 0; idx < G_N_ELEMENTS(frontier_node_types); idx++)
+		frontier_update(index, frontier_node_types[idx], node->id);
+}
+
+/* An edge depends on its nodes, and on the edges of those nodes.
+ * A node depends on its edges, and on its neighbours.
+ */
+static void frontier_flush(FrontierIndex * index)
+{
+	const Map *map = index->map;
+	guint idx;
+	guint side;
+	guint side2;
+
+	for (idx = 0; idx < index->changed_edges->len; idx++) {
+		const Edge *edge =
+		    map->edges[g_array_index(index->changed_edges, gint,
+					     idx)];
+
+		frontier_update_edge(index, edge);
+		for (side = 0; side < G_N_ELEMENTS(edge->nodes); side++) {
+			const Node *node = edge->nodes[side];
+
+			if (node == NULL)
 				continue;
-			}
-			if (hex->terrain == SEA_TERRAIN)
-				num_sea++;
+			frontier_update_node(index, node);
+			for (side2 = 0; side2 < G_N_ELEMENTS(node->edges);
+			     side2++)
+				if (node->edges[side2] != NULL
+				    && node->edges[side2] != edge)
+					frontier_update_edge(index,
+							     node->edges
+							     [side2]);
 		}
-		if (num_sea == G_N_ELEMENTS(edge->hexes))
-			continue;
+	}
+	g_array_set_size(index->changed_edges, 0);
+
+	for (idx = 0; idx < index->changed_nodes->len; idx++) {
+		const Node *node =
+		    map->nodes[g_array_index(index->changed_nodes, gint,
+					     idx)];
+
+		frontier_update_node(index, node);
+		for (side = 0; side < G_N_ELEMENTS(node->edges); side++) {
+			const Edge *edge = node->edges[side];
 
-		/* Follow the other node */
-		for (idx2 = 0;
-		     idx2 < G_N_ELEMENTS(edge->nodes) && !discovered;
-		     ++idx2) {
-			Node *node2 = edge->nodes[idx2];
-			if (node == node2)
+			if (edge == NULL)
 				continue;
-			discovered |=
-			    map_island_recursive(map, node2, owner);
+			frontier_update_edge(index, edge);
+			for (side2 = 0; side2 < G_N_ELEMENTS(edge->nodes);
+			     side2++)
+				if (edge->nodes[side2] != NULL
+				    && edge->nodes[side2] != node)
+					frontier_update_node(index,
+							     edge->nodes
+							     [side2]);
 		}
 	}
-	return discovered;
+	g_array_set_size(index->changed_nodes, 0);
+}
+
+FrontierIndex *frontier_index_new(const Map * map, guint num_players)
+{
+	FrontierIndex *index;
+	guint idx;
+
+	g_return_val_if_fail(map != NULL, NULL);
+
+	index = g_malloc0(sizeof(*index));
+	index->map = map;
+	index->num_players = num_players;
+	for (idx = 0; idx < G_N_ELEMENTS(frontier_edge_types); idx++)
+		index->words[frontier_edge_types[idx]] =
+		    MAP_SET_WORDS(map->num_edges);
+	for (idx = 0; idx < G_N_ELEMENTS(frontier_node_types); idx++)
+		index->words[frontier_node_types[idx]] =
+		    MAP_SET_WORDS(map->num_nodes);
+	for (idx = 0; idx < NUM_BUILD_TYPES; idx++) {
+		index->sets[idx] =
+		    g_new0(guint32, index->words[idx] * num_players);
+		index->counts[idx] = g_new0(guint, num_players);
+	}
+	index->changed_edges = g_array_new(FALSE, FALSE, sizeof(gint));
+	index->changed_nodes = g_array_new(FALSE, FALSE, sizeof(gint));
+
+	for (idx = 0; idx < map->num_edges; idx++)
+		frontier_update_edge(index, map->edges[idx]);
+	for (idx = 0; idx < map->num_nodes; idx++)
+		frontier_update_node(index, map->nodes[idx]);
+	return index;
+}
+
+void frontier_index_free(FrontierIndex * index)
+{
+	guint idx;
+
+	if (index == NULL)
+		return;
+
+	for (idx = 0; idx < NUM_BUILD_TYPES; idx++) {
+		g_free(index->sets[idx]);
+		g_free(index->counts[idx]);
+	}
+	g_array_free(index->changed_edges, TRUE);
+	g_array_free(index->changed_nodes, TRUE);
+	g_free(index);
+}
+
+void frontier_index_edge_changed(FrontierIndex * index, const Edge * edge)
+{
+	g_return_if_fail(index != NULL);
+	g_return_if_fail(edge != NULL);
+	g_array_append_val(index->changed_edges, edge->id);
+}
+
+void frontier_index_node_changed(FrontierIndex * index, const Node * node)
+{
+	g_return_if_fail(index != NULL);
+	g_return_if_fail(node != NULL);
+	g_array_append_val(index->changed_nodes, node->id);
+}
+
+void frontier_index_pirate_moved(FrontierIndex * index,
+				 const Hex * old_hex, const Hex * new_hex)
+{
+	guint idx;
+
+	g_return_if_fail(index != NULL);
+
+	/* Ships cannot be built next to the pirate */
+	for (idx = 0; idx < 6; idx++) {
+		if (old_hex != NULL)
+			g_array_append_val(index->changed_edges,
+					   old_hex->edges[idx]->id);
+		if (new_hex != NULL)
+			g_array_append_val(index->changed_edges,
+					   new_hex->edges[idx]->id);
+	}
+}
+
+const guint32 *frontier_index_lookup(FrontierIndex * index, gint owner,
+				     BuildType type, guint * count)
+{
+	g_return_val_if_fail(index != NULL, NULL);
+	g_return_val_if_fail(type < NUM_BUILD_TYPES, NULL);
+
+	if (owner < 0 || (guint) owner >= index->num_players
+	    || index->sets[type] == NULL || index->words[type] == 0) {
+		*count = 0;
+		return NULL;
+	}
+	frontier_flush(index);
+	*count = index->counts[type][owner];
+	return index->sets[type] + (guint) owner * index->words[type];
+}
+
+gboolean frontier_index_can_build(FrontierIndex * index, gint owner,
+				  BuildType type)
+{
+	guint count;
+
+	frontier_index_lookup(index, owner, type, &count);
+	return count > 0;
 }
 
 /* Has anything be built by this player on this island */
 gboolean map_is_island_discovered(Map * map, Node * node, gint owner)
 {
+	guint idx;
+
 	g_return_val_if_fail(map != NULL, FALSE);
 	g_return_val_if_fail(node != NULL, FALSE);
-	map_traverse(map, zero_visited, NULL);
-	return map_island_recursive(map, node, owner);
+
+	if (node->island < 0)
+		return node->owner == owner;
+	for (idx = map->island_start[node->island];
+	     idx < map->island_start[node->island + 1]; idx++)
+		if (map->nodes[map->island_nodes[idx]]->owner == owner)
+			return TRUE;
+	return FALSE;
 }
 
 /* Determine the maritime trading capabilities for the specified player
@@ -1121,50 +1777,122 @@ void map_maritime_info(const Map * map, MaritimeInfo * info, gint owner)
 	map_traverse_const(map, find_maritime, info);
 }
 
-typedef struct {
-	gboolean visited[MAP_SIZE][MAP_SIZE];
-	guint count;
-	guint recursion_level;
-} IslandCount;
+/* The port index keeps the ports of each node, and counts the buildings
+ * of each player by kind of port.  A kind is a Resource, ANY_RESOURCE
+ * for the 3:1 ports.
+ */
+
+#define PORT_KINDS (ANY_RESOURCE + 1)
 
-static gboolean count_islands(const Hex * hex, gpointer info)
+struct _PortIndex {
+	guint num_players;
+	guint *node_ports;	/* kinds of port of a node, one bit each */
+	gint *node_owner;	/* owner of the node, as counted */
+	guint *counts;		/* buildings by player, then kind of port */
+};
+
+/* Count a building on the ports of a node, or stop counting it */
+static void port_index_count(PortIndex * index, guint ports, gint owner,
+			     gboolean add)
 {
-	IslandCount *count = info;
-	HexDirection direction;
+	guint *counts;
+	guint kind;
+
+	if (owner < 0 || (guint) owner >= index->num_players)
+		return;
+	counts = index->counts + (guint) owner * PORT_KINDS;
+	for (kind = 0; kind < PORT_KINDS; kind++)
+		if (ports & (1u << kind)) {
+			if (add)
+				counts[kind]++;
+			else
+				counts[kind]--;
+		}
+}
 
-	if (hex == NULL)
-		return FALSE;
+PortIndex *port_index_new(const Map * map, guint num_players)
+{
+	PortIndex *index;
+	guint idx;
 
-	g_return_val_if_fail(hex->map != NULL, FALSE);
+	g_return_val_if_fail(map != NULL, NULL);
 
-	if (count->visited[hex->y][hex->x])
-		return FALSE;
+	index = g_malloc0(sizeof(*index));
+	index->num_players = num_players;
+	index->node_ports = g_new0(guint, MAX(map->num_nodes, 1));
+	index->node_owner = g_new(gint, MAX(map->num_nodes, 1));
+	index->counts = g_new0(guint, MAX(num_players, 1) * PORT_KINDS);
 
-	if (hex->terrain == SEA_TERRAIN)
-		return FALSE;
+	/* A port can be used from the two nodes next to its facing */
+	for (idx = 0; idx < map->num_hexes; idx++) {
+		const Hex *hex = map->hexes[idx];
+		const Node *node;
 
-	count->visited[hex->y][hex->x] = TRUE;
-	count->recursion_level++;
-	for (direction = 0; direction < 6; direction++) {
-		count_islands(hex_in_direction(hex, direction), count);
+		if (hex->terrain != SEA_TERRAIN
+		    || hex->resource == NO_RESOURCE)
+			continue;
+		node = hex->nodes[hex->facing];
+		if (node != NULL)
+			index->node_ports[node->id] |= 1u << hex->resource;
+		node = hex->nodes[(hex->facing + 5) % 6];
+		if (node != NULL)
+			index->node_ports[node->id] |= 1u << hex->resource;
 	}
-	count->recursion_level--;
-	if (count->recursion_level == 0)
-		count->count++;
-	return FALSE;
+	for (idx = 0; idx < map->num_nodes; idx++) {
+		index->node_owner[idx] = -1;
+		port_index_node_changed(index, map->nodes[idx]);
+	}
+	return index;
 }
 
-guint map_count_islands(const Map * map)
+void port_index_free(PortIndex * index)
 {
-	IslandCount island_count;
+	if (index == NULL)
+		return;
 
-	g_return_val_if_fail(map != NULL, 0u);
+	g_free(index->node_ports);
+	g_free(index->node_owner);
+	g_free(index->counts);
+	g_free(index);
+}
+
+void port_index_node_changed(PortIndex * index, const Node * node)
+{
+	guint ports;
+
+	g_return_if_fail(index != NULL);
+	g_return_if_fail(node != NULL);
+
+	if (index->node_owner[node->id] == node->owner)
+		return;
+	ports = index->node_ports[node->id];
+	port_index_count(index, ports, index->node_owner[node->id], FALSE);
+	port_index_count(index, ports, node->owner, TRUE);
+	index->node_owner[node->id] = node->owner;
+}
+
+void port_index_maritime_info(const PortIndex * index,
+			      MaritimeInfo * info, gint owner)
+{
+	const guint *counts;
+	guint kind;
 
-	memset(island_count.visited, 0, sizeof(island_count.visited));
-	island_count.count = 0;
-	island_count.recursion_level = 0;
+	g_return_if_fail(index != NULL);
+	g_return_if_fail(info != NULL);
+	memset(info, 0, sizeof(*info));
+	info->owner = owner;
+	if (owner < 0 || (guint) owner >= index->num_players)
+		return;
+
+	counts = index->counts + (guint) owner * PORT_KINDS;
+	for (kind = 0; kind < NO_RESOURCE; kind++)
+		info->specific_resource[kind] = counts[kind] > 0;
+	info->any_resource = counts[ANY_RESOURCE] > 0;
+}
 
-	map_traverse_const(map, count_islands, &island_count);
+guint map_count_islands(const Map * map)
+{
+	g_return_val_if_fail(map != NULL, 0u);
 
-	return island_count.count;
+	return map->num_islands;
 }
@@ -24,6 +24,12 @@
 #include "config.h"
 #include <stdlib.h>
 #include <gio/gio.h>
+#ifdef G_OS_UNIX
+#include <errno.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/socket.h>
+#endif
 
 #include "network.h"
 #include "log.h"
@@ -40,8 +46,14 @@ struct _Service {
 	gpointer user_data;
 	GSList *sessions;
 	gboolean delayed_free;
+	GMainContext *context; /**< Context that accepts connections */
+	GMainContext *session_context; /**< Context for new sessions */
 };
 
+/* Bytes of input that fit in a session without allocating a buffer,
+ * enough for most lines of the protocol */
+#define NET_READ_INLINE_SIZE 512
+
 struct _Session {
 	GSocketConnection *connection;
 	GCancellable *input_cancel;
@@ -53,25 +65,69 @@ struct _Session {
 
 	gchar *host;
 	guint16 port;
+	gboolean local; /**< Connected by net_connect_pair */
 
-	char read_buff[16 * 1024];
+	gchar read_inline[NET_READ_INLINE_SIZE]; /**< Used while idle */
+	gchar *read_buff; /**< read_inline, or a grown buffer */
+	size_t read_size; /**< Size of read_buff */
+	size_t read_limit; /**< read_buff does not grow beyond this */
 	size_t read_len;
+	size_t read_start; /**< First byte that is not processed yet */
+	size_t read_scan; /**< No newline between read_start and this */
 	gboolean entered;
 
 	NetNotifyFunc notify_func;
 	guint period; /**< Period in s for keep-alive checks */
+	GMainContext *context; /**< Context that dispatches the sources */
+
+	GQueue write_queue; /**< Chunks (GBytes) waiting to be sent */
+	gsize write_offset; /**< Bytes of the first chunk already sent */
+	gsize write_queued; /**< Bytes in the queue not yet sent */
+	gsize write_peak; /**< Largest value of write_queued */
+	gsize high_water_mark; /**< Report backpressure above this */
+	GSource *output_source; /**< Active while the queue is not empty */
 };
 
+/* Processed input is only moved out of the read buffer when at least
+ * this many bytes can be reclaimed, or when the buffer is full */
+#define READ_COMPACT_THRESHOLD (4 * 1024)
+
+/* Close the session when the queue grows beyond this many times the
+ * high-water mark */
+#define WRITE_QUEUE_LIMIT_FACTOR 16
+
 static void notify(Session * ses, NetEvent event, const gchar * line)
 {
 	if (ses->notify_func != NULL)
 		ses->notify_func(ses, event, line, ses->user_data);
 }
 
+static gboolean net_flush_queue(Session * ses);
+
+static void net_clear_queue(Session * ses)
+{
+	if (ses->output_source != NULL) {
+		g_source_destroy(ses->output_source);
+		g_source_unref(ses->output_source);
+		ses->output_source = NULL;
+	}
+	while (!g_queue_is_empty(&ses->write_queue)) {
+		g_bytes_unref(g_queue_pop_head(&ses->write_queue));
+	}
+	ses->write_offset = 0;
+	ses->write_queued = 0;
+}
+
 static gboolean net_close_internal(Session * ses)
 {
+	if (ses->connection != NULL) {
+		/* Send what can be sent without blocking */
+		net_flush_queue(ses);
+	}
+	net_clear_queue(ses);
+
 	if (ses->timer_id != 0) {
-		g_source_remove(ses->timer_id);
+		net_source_remove(ses->context, ses->timer_id);
 		ses->timer_id = 0;
 	}
 
@@ -115,13 +171,14 @@ static gboolean ping_function(gpointer s)
 		 * Send a ping (but don't update activity time).  */
 		net_write(ses, "hello\n");
 		ses->timer_id =
-		    g_timeout_add(ses->period * 1000, ping_function, s);
+		    net_timeout_add(ses->context, ses->period * 1000,
+				    ping_function, s);
 	} else {
 		/* Everything is fine.  Reschedule this check.  */
-		ses->timer_id = g_timeout_add((guint)
-					      ((ses->period -
-						interval) * 1000),
-					      ping_function, s);
+		ses->timer_id = net_timeout_add(ses->context, (guint)
+						((ses->period -
+						  interval) * 1000),
+						ping_function, s);
 	}
 	/* Return FALSE to not reschedule this timeout.  If it needed to be
 	 * rescheduled, it has been done explicitly above (with a different
@@ -129,39 +186,210 @@ static gboolean ping_function(gpointer s)
 	return FALSE;
 }
 
-void net_write(Session * ses, const gchar * data)
+/** Write as much data as the socket accepts without blocking.
+ * @return The number of bytes written (0 when the socket is full),
+ *         or -1 on error.
+ */
+static gssize write_nonblocking(Session * ses, const gchar * data,
+				gsize len)
 {
-	g_return_if_fail(ses != NULL);
-	if (ses->connection != NULL) {
-		size_t len;
-		gssize num;
-		GError *error;
+	gssize num;
+	GError *error;
 
-		len = strlen(data);
-		error = NULL;
-		num =
-		    g_output_stream_write(g_io_stream_get_output_stream
-					  (G_IO_STREAM(ses->connection)),
-					  data, len, NULL, &error);
-		if (num < 0) {
-			log_message(MSG_ERROR,
-				    _("Error writing to socket: %s\n"),
-				    error->message);
+	error = NULL;
+	num =
+	    g_pollable_output_stream_write_nonblocking
+	    (G_POLLABLE_OUTPUT_STREAM
+	     (g_io_stream_get_output_stream(G_IO_STREAM(ses->connection))),
+	     data, len, NULL, &error);
+	if (num < 0) {
+		if (g_error_matches
+		    (error, G_IO_ERROR, G_IO_ERROR_WOULD_BLOCK)) {
 			g_error_free(error);
-			net_close(ses);
-			return;
+			return 0;
 		}
-		if (strcmp(data, "yes\n") && strcmp(data, "hello\n")) {
-			debug("(%p) --> %s", ses->connection, data);
+		log_message(MSG_ERROR, _("Error writing to socket: %s\n"),
+			    error->message);
+		g_error_free(error);
+		return -1;
+	}
+	return num;
+}
+
+/** Send the queued data, until the queue is empty or the socket is full.
+ * @return FALSE on a write error
+ */
+static gboolean net_flush_queue(Session * ses)
+{
+	while (!g_queue_is_empty(&ses->write_queue)) {
+		GBytes *chunk = g_queue_peek_head(&ses->write_queue);
+		gsize len;
+		const gchar *data = g_bytes_get_data(chunk, &len);
+		gssize num;
+
+		num =
+		    write_nonblocking(ses, data + ses->write_offset,
+				      len - ses->write_offset);
+		if (num < 0)
+			return FALSE;
+		if (num == 0)
+			break;
+		ses->write_offset += (gsize) num;
+		ses->write_queued -= (gsize) num;
+		if (ses->write_offset == len) {
+			g_queue_pop_head(&ses->write_queue);
+			g_bytes_unref(chunk);
+			ses->write_offset = 0;
 		}
-		if ((size_t) num != len) {
-			log_message(MSG_ERROR,
-				    _("Could not send all data\n"));
+	}
+	return TRUE;
+}
+
+static gboolean output_ready(G_GNUC_UNUSED GObject * pollable_stream,
+			     gpointer user_data)
+{
+	Session *ses = (Session *) user_data;
+
+	if (!net_flush_queue(ses)) {
+		net_close(ses);
+		return FALSE;
+	}
+	if (g_queue_is_empty(&ses->write_queue)) {
+		g_source_unref(ses->output_source);
+		ses->output_source = NULL;
+		return FALSE;
+	}
+	return TRUE;
+}
+
+/** Queue a chunk of data for sending.
+ * @param ses    The session
+ * @param chunk  The data, the queue takes over the reference
+ * @param offset Bytes of the chunk that are already sent
+ * @return FALSE when the queue has grown above the high-water mark
+ */
+static gboolean net_queue_chunk(Session * ses, GBytes * chunk,
+				gsize offset)
+{
+	if (g_queue_is_empty(&ses->write_queue))
+		ses->write_offset = offset;
+	g_queue_push_tail(&ses->write_queue, chunk);
+	ses->write_queued += g_bytes_get_size(chunk) - offset;
+	if (ses->write_queued > ses->write_peak)
+		ses->write_peak = ses->write_queued;
+
+	if (ses->write_queued >
+	    WRITE_QUEUE_LIMIT_FACTOR * ses->high_water_mark) {
+		/* The peer does not read the data anymore.
+		 * Assume something has gone wrong and disconnect.  */
+		log_message(MSG_ERROR,
+			    _("Write buffer overflow - disconnecting\n"));
+		net_clear_queue(ses);
+		net_close(ses);
+		return FALSE;
+	}
+
+	if (ses->output_source == NULL) {
+		ses->output_source =
+		    g_pollable_output_stream_create_source
+		    (G_POLLABLE_OUTPUT_STREAM
+		     (g_io_stream_get_output_stream
+		      (G_IO_STREAM(ses->connection))), NULL);
+		g_source_set_callback(ses->output_source,
+				      G_SOURCE_FUNC(output_ready), ses,
+				      NULL);
+		g_source_attach(ses->output_source, ses->context);
+	}
+	return ses->write_queued <= ses->high_water_mark;
+}
+
+/** Send data right away if nothing is queued, queue the rest.
+ * @param ses   The session
+ * @param data  The data
+ * @param len   The length of the data
+ * @param bytes The data as a buffer that may be queued, or NULL to
+ *              copy the unsent part
+ * @return As net_write
+ */
+static gboolean net_write_real(Session * ses, const gchar * data,
+			       gsize len, GBytes * bytes)
+{
+	gssize num;
+
+	if (ses->connection == NULL)
+		return FALSE;
+
+	if (!(len == 4 && memcmp(data, "yes\n", len) == 0)
+	    && !(len == 6 && memcmp(data, "hello\n", len) == 0)) {
+		debug("(%p) --> %.*s", ses->connection, (int) len, data);
+	}
+
+	num = 0;
+	if (g_queue_is_empty(&ses->write_queue)) {
+		/* Nothing is waiting, try to send it right away */
+		num = write_nonblocking(ses, data, len);
+		if (num < 0) {
 			net_close(ses);
-			return;
+			return FALSE;
 		}
-		return;
+		if ((gsize) num == len)
+			return TRUE;
 	}
+	if (bytes != NULL)
+		return net_queue_chunk(ses, g_bytes_ref(bytes),
+				       (gsize) num);
+	return net_queue_chunk(ses,
+			       g_bytes_new(data + num, len - (gsize) num),
+			       0);
+}
+
+gboolean net_write(Session * ses, const gchar * data)
+{
+	g_return_val_if_fail(ses != NULL, FALSE);
+	return net_write_real(ses, data, strlen(data), NULL);
+}
+
+gboolean net_write_bytes(Session * ses, GBytes * bytes)
+{
+	gsize len;
+	const gchar *data;
+
+	g_return_val_if_fail(ses != NULL, FALSE);
+	data = g_bytes_get_data(bytes, &len);
+	return net_write_real(ses, data, len, bytes);
+}
+
+void net_set_high_water_mark(Session * ses, gsize high_water_mark)
+{
+	g_return_if_fail(ses != NULL);
+	ses->high_water_mark = high_water_mark;
+}
+
+gsize net_get_queued_bytes(const Session * ses)
+{
+	return ses->write_queued;
+}
+
+gsize net_get_peak_queued_bytes(const Session * ses)
+{
+	return ses->write_peak;
+}
+
+void net_set_read_limit(Session * ses, gsize read_limit)
+{
+	g_return_if_fail(ses != NULL);
+	ses->read_limit = MAX(read_limit, sizeof(ses->read_inline));
+}
+
+gsize net_get_read_buffer_size(const Session * ses)
+{
+	return ses->read_buff != ses->read_inline ? ses->read_size : 0;
+}
+
+gsize net_get_memory_use(const Session * ses)
+{
+	return sizeof(*ses) + net_get_read_buffer_size(ses)
+	    + ses->write_queued;
 }
 
 void net_printf(Session * ses, const gchar * fmt, ...)
@@ -177,14 +405,55 @@ void net_printf(Session * ses, const gchar * fmt, ...)
 	g_free(buff);
 }
 
-static ssize_t find_line(char *buff, size_t len)
+/** Move the unprocessed input to the start of the read buffer.
+ * @param ses The session
+ */
+static void compact_read_buffer(Session * ses)
+{
+	if (ses->read_start == 0)
+		return;
+	memmove(ses->read_buff, ses->read_buff + ses->read_start,
+		ses->read_len - ses->read_start);
+	ses->read_len -= ses->read_start;
+	ses->read_scan -= ses->read_start;
+	ses->read_start = 0;
+}
+
+/** Make room in the read buffer.
+ * @param ses The session
+ * @return FALSE when the buffer is full and may not grow
+ */
+static gboolean grow_read_buffer(Session * ses)
 {
-	size_t idx;
+	size_t size;
 
-	for (idx = 0; idx < len; idx++)
-		if (buff[idx] == '\n')
-			return (ssize_t) idx;
-	return -1;
+	compact_read_buffer(ses);
+	if (ses->read_len < ses->read_size)
+		return TRUE;
+	if (ses->read_size >= ses->read_limit)
+		return FALSE;
+
+	size = MIN(ses->read_size * 2, ses->read_limit);
+	if (ses->read_buff == ses->read_inline) {
+		ses->read_buff = g_malloc(size);
+		memcpy(ses->read_buff, ses->read_inline, ses->read_len);
+	} else
+		ses->read_buff = g_realloc(ses->read_buff, size);
+	ses->read_size = size;
+	return TRUE;
+}
+
+/** Return to the inline read buffer.
+ * @param ses The session, all its input must be processed
+ */
+static void shrink_read_buffer(Session * ses)
+{
+	g_assert(ses->read_len == 0);
+	if (ses->read_buff != ses->read_inline) {
+		g_free(ses->read_buff);
+		ses->read_buff = ses->read_inline;
+		ses->read_size = sizeof(ses->read_inline);
+	}
 }
 
 static gboolean input_ready(GObject * pollable_stream, gpointer user_data)
@@ -192,16 +461,18 @@ static gboolean input_ready(GObject * pollable_stream, gpointer user_data)
 	Session *ses = (Session *) user_data;
 	gssize num;
 	size_t offset;
+	size_t scan;
 	GError *error;
 
 	/* There is data from this connection: record the time.  */
 	ses->last_response = time(NULL);
 
-	if (ses->read_len == sizeof(ses->read_buff)) {
+	if (ses->read_len == ses->read_size
+	    && (ses->entered || !grow_read_buffer(ses))) {
 		/* We are in trouble now - the application has not
 		 * been processing the data we have been
-		 * reading. Assume something has gone wrong and
-		 * disconnect
+		 * reading, or a line is longer than the limit.
+		 * Assume something has gone wrong and disconnect
 		 */
 		log_message(MSG_ERROR,
 			    _("Read buffer overflow - disconnecting\n"));
@@ -214,7 +485,7 @@ static gboolean input_ready(GObject * pollable_stream, gpointer user_data)
 	    g_pollable_input_stream_read_nonblocking
 	    (G_POLLABLE_INPUT_STREAM(pollable_stream),
 	     ses->read_buff + ses->read_len,
-	     sizeof(ses->read_buff) - ses->read_len, ses->input_cancel,
+	     ses->read_size - ses->read_len, ses->input_cancel,
 	     &error);
 
 	if (g_cancellable_is_cancelled(ses->input_cancel)) {
@@ -242,15 +513,22 @@ static gboolean input_ready(GObject * pollable_stream, gpointer user_data)
 	}
 	ses->entered = TRUE;
 
-	offset = 0;
+	/* Lines are terminated in place and passed on without copying.
+	 * They stay valid until this function returns. */
+	offset = ses->read_start;
+	scan = MAX(ses->read_scan, offset);
 	while (ses->connection != NULL && offset < ses->read_len) {
 		gchar *line = ses->read_buff + offset;
-		ssize_t len = find_line(line, ses->read_len - offset);
+		gchar *end = memchr(ses->read_buff + scan, '\n',
+				    ses->read_len - scan);
 
-		if (len < 0)
+		if (end == NULL) {
+			scan = ses->read_len;
 			break;
-		line[len] = '\0';
-		offset += (size_t) (len + 1);
+		}
+		*end = '\0';
+		offset = (size_t) (end - ses->read_buff) + 1;
+		scan = offset;
 
 		if (!strcmp(line, "hello")) {
 			net_write(ses, "yes\n");
@@ -265,18 +543,21 @@ static gboolean input_ready(GObject * pollable_stream, gpointer user_data)
 		notify(ses, NET_READ, line);
 	}
 
-	if (offset < ses->read_len) {
-		/* Did not process all data in buffer - discard
-		 * processed data and copy remaining data to beginning
-		 * of buffer until next time
-		 */
-		memmove(ses->read_buff, ses->read_buff + offset,
-			ses->read_len - offset);
-		ses->read_len -= offset;
-	} else
-		/* Processed all data in buffer, discard it
-		 */
+	if (offset >= ses->read_len) {
+		/* Processed all data in buffer, discard it, and give
+		 * back the memory of a grown buffer */
 		ses->read_len = 0;
+		ses->read_start = 0;
+		ses->read_scan = 0;
+		shrink_read_buffer(ses);
+	} else {
+		/* Keep the remaining data until next time, and only
+		 * move it when enough space can be reclaimed */
+		ses->read_start = offset;
+		ses->read_scan = scan;
+		if (offset >= READ_COMPACT_THRESHOLD)
+			compact_read_buffer(ses);
+	}
 
 	ses->entered = FALSE;
 	if (ses->connection == NULL) {
@@ -294,10 +575,68 @@ Session *net_new(NetNotifyFunc notify_func, gpointer user_data)
 	ses->user_data = user_data;
 	ses->connection = NULL;
 	ses->timed_out = FALSE;
+	g_queue_init(&ses->write_queue);
+	ses->high_water_mark = NET_DEFAULT_HIGH_WATER_MARK;
+	ses->read_buff = ses->read_inline;
+	ses->read_size = sizeof(ses->read_inline);
+	ses->read_limit = NET_DEFAULT_READ_LIMIT;
+	ses->context = g_main_context_ref_thread_default();
 
 	return ses;
 }
 
+void net_set_context(Session * ses, GMainContext * context)
+{
+	g_return_if_fail(ses != NULL);
+	g_return_if_fail(ses->connection == NULL);
+
+	if (context == NULL)
+		context = g_main_context_default();
+	g_main_context_ref(context);
+	g_main_context_unref(ses->context);
+	ses->context = context;
+}
+
+GMainContext *net_get_context(const Session * ses)
+{
+	return ses->context;
+}
+
+guint net_timeout_add(GMainContext * context, guint interval,
+		      GSourceFunc func, gpointer data)
+{
+	GSource *source;
+	guint id;
+
+	source = g_timeout_source_new(interval);
+	g_source_set_callback(source, func, data, NULL);
+	id = g_source_attach(source, context);
+	g_source_unref(source);
+	return id;
+}
+
+guint net_idle_add(GMainContext * context, GSourceFunc func,
+		   gpointer data)
+{
+	GSource *source;
+	guint id;
+
+	source = g_idle_source_new();
+	g_source_set_callback(source, func, data, NULL);
+	id = g_source_attach(source, context);
+	g_source_unref(source);
+	return id;
+}
+
+void net_source_remove(GMainContext * context, guint id)
+{
+	GSource *source;
+
+	source = g_main_context_find_source_by_id(context, id);
+	if (source != NULL)
+		g_source_destroy(source);
+}
+
 void net_set_user_data(Session * ses, gpointer user_data)
 {
 	g_return_if_fail(ses != NULL);
@@ -320,13 +659,14 @@ void net_set_check_connection_alive(Session * ses, guint period)
 	if (period > 0) {
 		ses->last_response = time(NULL);
 		if (ses->timer_id != 0) {
-			g_source_remove(ses->timer_id);
+			net_source_remove(ses->context, ses->timer_id);
 		}
 		ses->timer_id =
-		    g_timeout_add(period * 1000, ping_function, ses);
+		    net_timeout_add(ses->context, period * 1000,
+				    ping_function, ses);
 	} else {
 		if (ses->timer_id != 0) {
-			g_source_remove(ses->timer_id);
+			net_source_remove(ses->context, ses->timer_id);
 			ses->timer_id = 0;
 		}
 	}
@@ -358,7 +698,7 @@ static void net_start_listening(Session * ses)
 						  ses->input_cancel);
 	g_source_set_callback(input_source, G_SOURCE_FUNC(input_ready),
 			      ses, NULL);
-	g_source_attach(input_source, NULL);
+	g_source_attach(input_source, ses->context);
 	g_source_unref(input_source);
 }
 
@@ -389,13 +729,88 @@ gboolean net_connect(Session * ses, const gchar * host, const gchar * port)
 	return TRUE;
 }
 
+/** Wrap one end of a socket pair in a connection.
+ * @param fd The file descriptor, it is closed on failure
+ * @return The connection, or NULL
+ */
+static GSocketConnection *net_connection_from_fd(gint fd)
+{
+	GSocket *socket;
+	GSocketConnection *connection;
+	GError *error = NULL;
+
+	socket = g_socket_new_from_fd(fd, &error);
+	if (socket == NULL) {
+		log_message(MSG_ERROR, _("Error connecting to %s: %s\n"),
+			    "localhost", error->message);
+		g_error_free(error);
+		close(fd);
+		return NULL;
+	}
+	connection = g_socket_connection_factory_create_connection(socket);
+	g_object_unref(socket);
+	return connection;
+}
+
+static gboolean net_session_handoff(gpointer user_data);
+
+gboolean net_connect_pair(Session * accepted, Session * connecting)
+{
+#ifdef G_OS_UNIX
+	gint fds[2];
+
+	g_return_val_if_fail(accepted->connection == NULL, FALSE);
+	g_return_val_if_fail(connecting->connection == NULL, FALSE);
+
+	if (socketpair(AF_UNIX, SOCK_STREAM, 0, fds) != 0) {
+		log_message(MSG_ERROR, _("Error connecting to %s: %s\n"),
+			    "localhost", g_strerror(errno));
+		return FALSE;
+	}
+	connecting->connection = net_connection_from_fd(fds[1]);
+	if (connecting->connection == NULL) {
+		close(fds[0]);
+		return FALSE;
+	}
+	accepted->connection = net_connection_from_fd(fds[0]);
+	if (accepted->connection == NULL) {
+		g_object_unref(connecting->connection);
+		connecting->connection = NULL;
+		return FALSE;
+	}
+	accepted->local = TRUE;
+	connecting->local = TRUE;
+
+	net_start_listening(connecting);
+	/* The accepting side learns about the connection like a session
+	 * that was accepted by a service */
+	net_idle_add(accepted->context, net_session_handoff, accepted);
+	return TRUE;
+#else
+	log_message(MSG_ERROR, _("Error connecting to %s: %s\n"),
+		    "localhost", "socket pairs are not supported");
+	return FALSE;
+#endif
+}
+
 static gboolean net_delayed_free(gpointer user_data)
 {
 	Session *ses = user_data;
+	g_main_context_unref(ses->context);
+	if (ses->read_buff != ses->read_inline)
+		g_free(ses->read_buff);
 	g_free(ses);
 	return FALSE;
 }
 
+static void net_service_release(Service * service)
+{
+	g_main_context_unref(service->context);
+	if (service->session_context != NULL)
+		g_main_context_unref(service->session_context);
+	g_free(service);
+}
+
 /* Free and NULL-ify the session *ses */
 void net_free(Session ** ses)
 {
@@ -413,7 +828,7 @@ void net_free(Session ** ses)
 		service->sessions =
 		    g_slist_remove(service->sessions, *ses);
 		if (service->delayed_free && service->sessions == NULL) {
-			g_free(service);
+			net_service_release(service);
 		}
 	}
 
@@ -421,8 +836,11 @@ void net_free(Session ** ses)
 
 	if ((*ses)->input_cancel != NULL) {
 		g_object_unref((*ses)->input_cancel);
-		g_idle_add(net_delayed_free, *ses);
+		net_idle_add((*ses)->context, net_delayed_free, *ses);
 	} else {
+		g_main_context_unref((*ses)->context);
+		if ((*ses)->read_buff != (*ses)->read_inline)
+			g_free((*ses)->read_buff);
 		g_free(*ses);
 	}
 	*ses = NULL;
@@ -455,6 +873,18 @@ const gchar *get_pioneers_dir(void)
 	return pioneers_dir;
 }
 
+/** Start a session that was accepted by a service.
+ * This runs in the context of the session.
+ */
+static gboolean net_session_handoff(gpointer user_data)
+{
+	Session *ses = user_data;
+
+	net_start_listening(ses);
+	notify(ses, NET_CONNECT, NULL);
+	return FALSE;
+}
+
 static void net_service_incoming(GObject * object, GAsyncResult * result,
 				 gpointer user_data)
 {
@@ -479,12 +909,21 @@ static void net_service_incoming(GObject * object, GAsyncResult * result,
 		g_assert(service->listener == listener);
 
 		ses = net_new(service->notify_func, service->user_data);
-		ses->service = service;
 		ses->connection = connection;
-		service->sessions = g_slist_append(service->sessions, ses);
-
-		net_start_listening(ses);
-		notify(ses, NET_CONNECT, NULL);
+		if (service->session_context != NULL) {
+			/* The session belongs to another context from now
+			 * on, the service will not close it */
+			g_main_context_unref(ses->context);
+			ses->context =
+			    g_main_context_ref(service->session_context);
+			net_idle_add(ses->context, net_session_handoff,
+				     ses);
+		} else {
+			ses->service = service;
+			service->sessions =
+			    g_slist_append(service->sessions, ses);
+			net_session_handoff(ses);
+		}
 	}
 
 	g_cancellable_reset(service->cancellable);
@@ -518,21 +957,31 @@ Service *net_service_new(guint16 port, NetNotifyFunc notify_func,
 	service->user_data = user_data;
 	service->sessions = NULL;
 	service->delayed_free = FALSE;
+	service->context = g_main_context_ref_thread_default();
+	service->session_context = NULL;
 	g_socket_listener_accept_async(socket_listener,
 				       service->cancellable,
 				       net_service_incoming, service);
 	return service;
 }
 
-void net_service_free(Service * service)
+void net_service_set_context(Service * service, GMainContext * context)
 {
+	g_return_if_fail(service != NULL);
+
+	if (service->session_context != NULL)
+		g_main_context_unref(service->session_context);
+	service->session_context = context;
+	if (context != NULL)
+		g_main_context_ref(context);
+}
+
+static gboolean net_service_free_internal(gpointer user_data)
+{
+	Service *service = user_data;
 	GSList *list;
 	gboolean delayed_free;
 
-	if (service == NULL) {
-		return;
-	}
-
 	g_cancellable_cancel(service->cancellable);
 	g_object_unref(service->cancellable);
 	service->cancellable = NULL;
@@ -556,8 +1005,22 @@ void net_service_free(Service * service)
 
 	/* Delay freeing the memory, to allow the callbacks to finish */
 	if (!delayed_free) {
-		g_free(service);
+		net_service_release(service);
+	}
+	return FALSE;
+}
+
+void net_service_free(Service * service)
+{
+	if (service == NULL) {
+		return;
 	}
+
+	/* The listener is only used by the context that accepts the
+	 * connections. When another thread owns that context, the service
+	 * is freed from there. */
+	g_main_context_invoke(service->context, net_service_free_internal,
+			      service);
 }
 
 gboolean net_get_peer_name(Session * ses, gchar ** hostname,
@@ -568,11 +1031,17 @@ gboolean net_get_peer_name(Session * ses, gchar ** hostname,
 	GResolver *resolver;
 	gchar *name;
 
+	g_return_val_if_fail(error == NULL || *error == NULL, FALSE);
+
+	if (ses->local) {
+		*hostname = g_strdup("localhost");
+		*servname = g_strdup("local");
+		return TRUE;
+	}
+
 	*hostname = g_strdup(_("unknown"));
 	*servname = g_strdup(_("unknown"));
 
-	g_return_val_if_fail(error == NULL || *error == NULL, FALSE);
-
 	remote_address =
 	    g_socket_connection_get_remote_address(ses->connection, error);
 	if (error != NULL && *error != NULL) {
@@ -43,9 +43,26 @@ void net_init(void);
 /* Finish the network drivers */
 void net_finish(void);
 
+/** Create a new session.
+ * The sources of the session are attached to the thread-default main
+ * context of the calling thread.
+ */
 Session *net_new(NetNotifyFunc notify_func, gpointer user_data);
 void net_free(Session ** ses);
 
+/** Set the main context that dispatches the session.
+ * Only allowed before the session is connected.
+ * @param ses The session
+ * @param context The context, or NULL for the global default context
+ */
+void net_set_context(Session * ses, GMainContext * context);
+
+/** Get the main context that dispatches the session.
+ * @param ses The session
+ * @return The context, never NULL
+ */
+GMainContext *net_get_context(const Session * ses);
+
 void net_set_user_data(Session * ses, gpointer user_data);
 void net_set_notify_func(Session * ses, NetNotifyFunc notify_func,
 			 gpointer user_data);
@@ -82,6 +99,42 @@ Service *net_service_new(guint16 port, NetNotifyFunc notify_func,
  */
 void net_service_free(Service * service);
 
+/** Hand the sessions of a service off to another main context.
+ * The service keeps accepting connections in the context it was created
+ * in. New sessions are dispatched in @a context, which may be iterated
+ * by another thread. The NET_CONNECT notification is sent from there.
+ * @param service The service
+ * @param context The context for new sessions, or NULL to use the
+ *                context of the service
+ */
+void net_service_set_context(Service * service, GMainContext * context);
+
+/** Add a timeout to a main context.
+ * @param context The context, or NULL for the global default context
+ * @param interval The interval in ms
+ * @param func The function to call
+ * @param data The data for the function
+ * @return The id of the source in @a context
+ */
+guint net_timeout_add(GMainContext * context, guint interval,
+		      GSourceFunc func, gpointer data);
+
+/** Add an idle function to a main context.
+ * @param context The context, or NULL for the global default context
+ * @param func The function to call
+ * @param data The data for the function
+ * @return The id of the source in @a context
+ */
+guint net_idle_add(GMainContext * context, GSourceFunc func,
+		   gpointer data);
+
+/** Remove a source that was added with net_timeout_add or net_idle_add.
+ * g_source_remove only looks in the global default context.
+ * @param context The context the source was added to
+ * @param id The id of the source
+ */
+void net_source_remove(GMainContext * context, guint id);
+
 /** Get peer name
  *  @param ses The session
  *  @retval hostname The resolved hostname (free with g_free)
@@ -92,6 +145,17 @@ void net_service_free(Service * service);
 gboolean net_get_peer_name(Session * ses, gchar ** hostname,
 			   gchar ** servname, GError ** error);
 
+/** Connect two sessions of this process to each other.
+ * No network is used.  The sessions may belong to different contexts.
+ * The accepting session is notified with NET_CONNECT in its context,
+ * like a session that was accepted by a service.  The connecting
+ * session can be used right away, like after net_connect.
+ * @param accepted   The session of the server side
+ * @param connecting The session of the client side
+ * @return TRUE if the sessions are connected
+ */
+gboolean net_connect_pair(Session * accepted, Session * connecting);
+
 /** Close a session after the pending data was sent.
  * @param ses The session to close
  */
@@ -99,10 +163,77 @@ void net_close(Session * ses);
 void net_printf(Session * ses, const gchar * fmt, ...);
 
 /** Write data.
+ * The data is sent without blocking.  When the peer does not accept
+ * all data, the remainder is queued and sent when the socket becomes
+ * writable again.
  * @param ses  The session
  * @param data The data to send
+ * @return FALSE when the data could not be sent or queued, or when the
+ *         queue is above the high-water mark (the data is queued
+ *         anyway)
+ */
+gboolean net_write(Session * ses, const gchar * data);
+
+/** Write a shared buffer.
+ * As net_write, but when the data must be queued, the buffer itself is
+ * queued instead of a copy.  This allows one formatted message to be
+ * sent to many sessions.
+ * @param ses   The session
+ * @param bytes The data to send, the caller keeps its reference
+ * @return As net_write
+ */
+gboolean net_write_bytes(Session * ses, GBytes * bytes);
+
+/** Default amount of queued outgoing data before net_write reports
+ * backpressure. */
+#define NET_DEFAULT_HIGH_WATER_MARK (64 * 1024)
+
+/** Set the high-water mark of the outgoing queue.
+ * When more data is queued, net_write returns FALSE.  When the queue
+ * grows to 16 times this amount, the session is closed.
+ * @param ses  The session
+ * @param high_water_mark The amount of bytes
+ */
+void net_set_high_water_mark(Session * ses, gsize high_water_mark);
+
+/** Get the amount of data that is queued, but not yet sent.
+ * @param ses  The session
+ * @return The amount of bytes in the outgoing queue
+ */
+gsize net_get_queued_bytes(const Session * ses);
+
+/** Get the largest amount of data that was queued at one time.
+ * @param ses  The session
+ * @return The amount of bytes
+ */
+gsize net_get_peak_queued_bytes(const Session * ses);
+
+/** Default largest size of the read buffer of a session. */
+#define NET_DEFAULT_READ_LIMIT (256 * 1024)
+
+/** Set the largest size of the read buffer.
+ * Incoming data is kept in a small buffer inside the session, which
+ * grows while a burst of data is processed and is released again when
+ * all data is processed.  When a line does not fit in this many bytes,
+ * the session is closed.
+ * @param ses  The session
+ * @param read_limit The amount of bytes
+ */
+void net_set_read_limit(Session * ses, gsize read_limit);
+
+/** Get the size of the allocated read buffer.
+ * @param ses  The session
+ * @return The amount of bytes, 0 when the small buffer in the session
+ *         is used
+ */
+gsize net_get_read_buffer_size(const Session * ses);
+
+/** Get the memory used by a session.
+ * @param ses  The session
+ * @return The amount of bytes of the session, its read buffer and the
+ *         data that is queued for sending
  */
-void net_write(Session * ses, const gchar * data);
+gsize net_get_memory_use(const Session * ses);
 
 /** Get the name of the metaserver.
  *  First the environment variable PIONEERS_METASERVER is queried
@@ -27,6 +27,10 @@
  * any other functions are called.
  *
  * To obtain a random number, use random_guint().
+ *
+ * When several independent streams of random numbers are needed (e.g. one
+ * for each game in a server process), create a context with
+ * random_context_new() and use random_guint_context().
  */
 
 #include "random.h"
@@ -55,3 +59,49 @@ guint random_guint(guint range)
 {
 	return g_rand_int_range(g_rand_ctx, 0, range);
 }
+
+/** Create a new, independently seeded, random number generator.
+ * @retval seed The seed of the new generator, to be able to reproduce it.
+ * @return The random number generator. Free with random_context_free().
+ */
+GRand *random_context_new(guint32 * seed)
+{
+	GRand *rand_ctx;
+	guint32 randomseed;
+
+	rand_ctx = g_rand_new();
+	randomseed = g_rand_int(rand_ctx);
+	g_rand_set_seed(rand_ctx, randomseed);
+	if (seed != NULL)
+		*seed = randomseed;
+	return rand_ctx;
+}
+
+/** Create a new random number generator with a known seed.
+ *  The same seed gives the same sequence, which makes games repeatable.
+ *  @param seed The seed
+ */
+GRand *random_context_new_with_seed(guint32 seed)
+{
+	return g_rand_new_with_seed(seed);
+}
+
+/** Free a random number generator created by random_context_new().
+ * @param rand_ctx The random number generator.
+ */
+void random_context_free(GRand * rand_ctx)
+{
+	if (rand_ctx != NULL)
+		g_rand_free(rand_ctx);
+}
+
+/**
+ * Returns a random number from 0 to range - 1.
+ * @param rand_ctx The random number generator to use.
+ * @param range The range of the random number generator.
+ * @return The random number.
+ */
+guint random_guint_context(GRand * rand_ctx, guint range)
+{
+	return g_rand_int_range(rand_ctx, 0, range);
+}
@@ -32,4 +32,9 @@
 guint32 random_init(void);
 guint random_guint(guint range);
 
+GRand *random_context_new(guint32 * seed);
+GRand *random_context_new_with_seed(guint32 seed);
+void random_context_free(GRand * rand_ctx);
+guint random_guint_context(GRand * rand_ctx, guint range);
+
 #endif
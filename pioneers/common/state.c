@@ -48,17 +48,24 @@ struct StateMachine {
 	gint stack_ptr;		/* stack index */
 	const gchar *current_state;	/* name of current state */
 
-	gchar *line;		/* line passed in from network event */
+	const gchar *line;	/* line passed in from network event,
+				 * only valid while it is handled */
 	size_t line_offset;	/* line prefix handling */
+	size_t verb_len;	/* length of the first word of the line */
 
 	Session *ses;		/* network session feeding state machine */
 	gint use_count;		/* # functions is in use by */
 	gboolean is_dead;	/* is this machine waiting to be killed? */
 
 	gboolean use_cache;	/* cache the data that is sent */
-	GList *cache;		/* cache for the delayed data */
+	GByteArray *cache;	/* cache for the delayed data */
+	gsize cache_peak;	/* largest size of the cache */
 };
 
+/* Protect against strange/slow connects: the most data that is cached
+ * before the connection is dropped */
+#define SM_CACHE_LIMIT (1024 * 1024)
+
 static void route_event(StateMachine * sm, gint event);
 
 void sm_inc_use_count(StateMachine * sm)
@@ -174,21 +181,25 @@ static void net_event(Session * ses, NetEvent event, const gchar * line,
 		route_event(sm, SM_NET_CLOSE);
 		break;
 	case NET_READ:
-		if (sm->line)
-			g_free(sm->line);
-		sm->line = g_strdup(line);
+		sm->line = line;
+		sm->verb_len = strcspn(line, " ");
 		/* Only handle data if there is a context.  Fixes bug that
 		 * clients starting to send data immediately crash the
 		 * server */
 		if (sm->stack_ptr != -1)
 			route_event(sm, SM_RECV);
 		else {
+			sm->line = "";
+			sm->verb_len = 0;
 			sm_dec_use_count(sm);
 			return;
 		}
 		break;
 	}
 	route_event(sm, SM_INIT);
+	/* The line belongs to the session, do not keep it */
+	sm->line = "";
+	sm->verb_len = 0;
 
 	sm_dec_use_count(sm);
 }
@@ -219,11 +230,38 @@ void sm_set_session(StateMachine * sm, Session * ses)
 	sm_dec_use_count(sm);
 };
 
+Session *sm_get_session(const StateMachine * sm)
+{
+	return sm->ses;
+}
+
+/* Can the format not match, because its first word differs in length
+ * from the first word of the line?  The states try many formats for
+ * each line, and most of them are rejected here without scanning.
+ * @param sm The statemachine
+ * @param fmt The format
+ * @param whole The format must match the whole line
+ */
+static gboolean sm_verb_differs(const StateMachine * sm,
+				const gchar * fmt, gboolean whole)
+{
+	size_t len;
+
+	if (sm->line_offset != 0)
+		return FALSE;
+	len = strcspn(fmt, " %");
+	if (fmt[len] == '%' || (fmt[len] == '\0' && !whole))
+		return FALSE;
+	return len != sm->verb_len;
+}
+
 gboolean sm_recv(StateMachine * sm, const gchar * fmt, ...)
 {
 	va_list ap;
 	ssize_t offset;
 
+	if (sm_verb_differs(sm, fmt, TRUE))
+		return FALSE;
 	va_start(ap, fmt);
 	offset = game_vscanf(sm->line + sm->line_offset, fmt, ap);
 	va_end(ap);
@@ -237,6 +275,8 @@ gboolean sm_recv_prefix(StateMachine * sm, const gchar * fmt, ...)
 	va_list ap;
 	ssize_t offset;
 
+	if (sm_verb_differs(sm, fmt, FALSE))
+		return FALSE;
 	va_start(ap, fmt);
 	offset = game_vscanf(sm->line + sm->line_offset, fmt, ap);
 	va_end(ap);
@@ -247,19 +287,45 @@ gboolean sm_recv_prefix(StateMachine * sm, const gchar * fmt, ...)
 	return TRUE;
 }
 
+/** Append data to the cache.
+ * @param sm   The statemachine
+ * @param data The data
+ * @param len  The length of the data
+ */
+static void sm_cache_append(StateMachine * sm, const gchar * data,
+			    gsize len)
+{
+	if (sm->cache == NULL)
+		sm->cache = g_byte_array_sized_new(4096);
+
+	if (sm->cache->len + len > SM_CACHE_LIMIT) {
+		net_write(sm->ses, "ERR connection too slow\n");
+		net_close(sm->ses);
+		return;
+	}
+	g_byte_array_append(sm->cache, (const guint8 *) data,
+			    (guint) len);
+	if (sm->cache->len > sm->cache_peak)
+		sm->cache_peak = sm->cache->len;
+}
+
 void sm_write(StateMachine * sm, const gchar * str)
+{
+	if (sm->use_cache)
+		sm_cache_append(sm, str, strlen(str));
+	else
+		net_write(sm->ses, str);
+}
+
+void sm_write_bytes(StateMachine * sm, GBytes * bytes)
 {
 	if (sm->use_cache) {
-		/* Protect against strange/slow connects */
-		if (g_list_length(sm->cache) > 1000) {
-			net_write(sm->ses, "ERR connection too slow\n");
-			net_close(sm->ses);
-		} else {
-			sm->cache =
-			    g_list_append(sm->cache, g_strdup(str));
-		}
+		gsize len;
+		const gchar *data = g_bytes_get_data(bytes, &len);
+
+		sm_cache_append(sm, data, len);
 	} else
-		net_write(sm->ses, str);
+		net_write_bytes(sm->ses, bytes);
 }
 
 void sm_write_uncached(StateMachine * sm, const gchar * str)
@@ -292,18 +358,19 @@ void sm_set_use_cache(StateMachine * sm, gboolean use_cache)
 		return;
 
 	if (!use_cache) {
-		/* The cache is turned off, send the delayed data */
-		GList *list = sm->cache;
-		while (list) {
-			gchar *data = list->data;
-			net_write(sm->ses, data);
-			list = g_list_remove(list, data);
-			g_free(data);
+		/* The cache is turned off, send the delayed data at once */
+		if (sm->cache != NULL) {
+			GBytes *data = g_byte_array_free_to_bytes(sm->cache);
+
+			sm->cache = NULL;
+			if (g_bytes_get_size(data) > 0)
+				net_write_bytes(sm->ses, data);
+			g_bytes_unref(data);
 		}
-		sm->cache = NULL;
 	} else {
 		/* Be sure that the cache is empty */
 		g_assert(!sm->cache);
+		sm->cache_peak = 0;
 	}
 	sm->use_cache = use_cache;
 }
@@ -313,6 +380,16 @@ gboolean sm_get_use_cache(const StateMachine * sm)
 	return sm->use_cache;
 }
 
+gsize sm_get_cache_size(const StateMachine * sm)
+{
+	return sm->cache != NULL ? sm->cache->len : 0;
+}
+
+gsize sm_get_peak_cache_size(const StateMachine * sm)
+{
+	return sm->cache_peak;
+}
+
 void sm_global_set(StateMachine * sm, StateFunc state)
 {
 	sm->global = state;
@@ -487,7 +564,6 @@ StateMachine *sm_new(gpointer user_data)
  */
 void sm_free(StateMachine * sm)
 {
-	g_free(sm->line);
 	sm->line = NULL;
 	if (sm->ses != NULL) {
 		net_free(&(sm->ses));
@@ -497,6 +573,8 @@ void sm_free(StateMachine * sm)
 		sm->is_dead = TRUE;
 	else {
 		route_event(sm, SM_FREE);
+		if (sm->cache != NULL)
+			g_byte_array_free(sm->cache, TRUE);
 		g_free(sm);
 	}
 }
@@ -506,14 +584,11 @@ void sm_close(StateMachine * sm)
 	net_free(&(sm->ses));
 	if (sm->use_cache) {
 		/* Purge the cache */
-		GList *list = sm->cache;
-		sm->cache = NULL;
-		sm_set_use_cache(sm, FALSE);
-		while (list) {
-			gchar *data = list->data;
-			list = g_list_remove(list, data);
-			g_free(data);
+		if (sm->cache != NULL) {
+			g_byte_array_free(sm->cache, TRUE);
+			sm->cache = NULL;
 		}
+		sm_set_use_cache(sm, FALSE);
 	}
 }
 
@@ -30,7 +30,9 @@
  * The server output is handled one line at a time.  For each line
  * received, the current state is called with the SM_RECV event.  The
  * [fmt] format string is modelled on the printf format string,
- * see game_printf and game_scanf for details.
+ * see game_printf and game_scanf for details.  The first word of the
+ * line is measured once, and formats that start with a word of another
+ * length are rejected without scanning the line.
  *
  * sm_recv(fmt, ...)
  *	Match the entire current line from the start position.
@@ -106,6 +108,8 @@ gboolean sm_recv(StateMachine * sm, const gchar * fmt, ...);
 gboolean sm_recv_prefix(StateMachine * sm, const gchar * fmt, ...);
 void sm_cancel_prefix(StateMachine * sm);
 void sm_write(StateMachine * sm, const gchar * str);
+/** As sm_write, but send a shared buffer */
+void sm_write_bytes(StateMachine * sm, GBytes * bytes);
 /** Send the data, even when caching is turned on */
 void sm_write_uncached(StateMachine * sm, const gchar * str);
 void sm_send(StateMachine * sm, const gchar * fmt, ...);
@@ -120,6 +124,17 @@ void sm_set_use_cache(StateMachine * sm, gboolean use_cache);
  * @return TRUE when the caching of messages is active
  */
 gboolean sm_get_use_cache(const StateMachine * sm);
+/** Get the amount of data that is cached.
+ * @param sm The statemachine
+ * @return The size of the cache in bytes
+ */
+gsize sm_get_cache_size(const StateMachine * sm);
+/** Get the largest amount of data that was cached since the caching
+ * was turned on.
+ * @param sm The statemachine
+ * @return The size in bytes
+ */
+gsize sm_get_peak_cache_size(const StateMachine * sm);
 
 void sm_debug(const gchar * function, const gchar * state);
 #define sm_goto(a, b) do { sm_debug("sm_goto", #b); sm_goto_nomacro(a, b); } while (0)
@@ -142,6 +157,11 @@ gboolean sm_is_connected(StateMachine * sm);
 gboolean sm_connect(StateMachine * sm, const gchar * host,
 		    const gchar * port);
 void sm_set_session(StateMachine * sm, Session * ses);
+/** Get the session of the statemachine.
+ * @param sm The statemachine
+ * @return The session, or NULL when it is not connected
+ */
+Session *sm_get_session(const StateMachine * sm);
 void sm_dec_use_count(StateMachine * sm);
 void sm_inc_use_count(StateMachine * sm);
 /** Dump the stack */
@@ -301,6 +301,7 @@ static void change_terrain(Hex * hex, Terrain terrain)
 			}
 		}
 	}
+	map_label_islands(hex->map);
 	guimap_draw_hex(gmap, hex);
 	return;
 }
@@ -35,10 +35,11 @@
 #include "server.h"
 #include "network.h"
 #include "version.h"
+#include "worker.h"
 
 /* network administration functions */
 static Game **admin_game;
-static gint admin_dice_roll = 0;
+static gchar *selected_port = NULL;
 static gchar *server_port = NULL;
 static gboolean register_server = TRUE;
 static GameParams *params = NULL;
@@ -66,7 +67,10 @@ typedef enum {
 	GETBANK,
 	SETBANK,
 	GETASSETS,
-	SETASSETS
+	SETASSETS,
+	LISTGAMES,
+	SELECTGAME,
+	GETMEMORY
 } AdminCommandType;
 
 typedef enum {
@@ -109,9 +113,391 @@ static AdminCommand admin_commands[] = {
 	{ SETBANK,             "set-bank",            TRUE,  FALSE, NEEDGAME   },
 	{ GETASSETS,           "get-assets",          TRUE,  FALSE, NEEDGAME   },
 	{ SETASSETS,           "set-assets",          TRUE,  FALSE, NEEDGAME   },
+	{ LISTGAMES,           "list-games",          FALSE, FALSE, NONEED     },
+	{ SELECTGAME,          "select-game",         TRUE,  FALSE, NONEED     },
+	{ GETMEMORY,           "get-memory",          FALSE, FALSE, NEEDGAME   },
 };
 /* *INDENT-ON* */
 
+/* The game the commands that need a game are applied to.
+ * This is the game started by the admin interface, unless another
+ * hosted game was selected. */
+static Game *admin_selected_game(void)
+{
+	if (selected_port != NULL)
+		return server_find_game(selected_port);
+	return *admin_game;
+}
+
+/* Stop the game and free it, in the thread that runs it */
+static gboolean admin_free_game(gpointer data)
+{
+	Game *game = data;
+
+	server_stop(game);
+	game_free(game);
+	return FALSE;
+}
+
+/* Stop the game, in the thread that runs it */
+static gboolean admin_stop_game(gpointer data)
+{
+	server_stop(data);
+	return FALSE;
+}
+
+typedef struct {
+	Session *session;
+	guint command_number;
+	const gchar *command;
+	gchar *argument;
+} AdminCall;
+
+/* Run a parsed command.
+ * Commands that need a game run in the thread of the selected game,
+ * all others run in the main thread. */
+static gboolean admin_execute(gpointer data)
+{
+	AdminCall *call = data;
+	Session *admin_session = call->session;
+	guint command_number = call->command_number;
+	const gchar *command = call->command;
+	gchar *argument = call->argument;
+	Game *game;
+
+	if (admin_commands[command_number].stop_server
+	    && server_is_running(*admin_game)) {
+		worker_call((*admin_game)->context, admin_free_game,
+			    *admin_game);
+		*admin_game = NULL;
+		net_write(admin_session, "INFO server stopped\n");
+	}
+	game = admin_selected_game();
+	switch (admin_commands[command_number].type) {
+	case BADCOMMAND:
+		net_printf(admin_session,
+			   "ERROR unrecognized command: '%s'\n",
+			   command);
+		break;
+	case SETPORT:
+		if (server_port)
+			g_free(server_port);
+		server_port = g_strdup(argument);
+		break;
+	case STARTSERVER:
+		{
+			gchar *metaserver_name =
+			    get_metaserver_name(TRUE);
+			if (!server_port)
+				server_port =
+				    g_strdup
+				    (PIONEERS_DEFAULT_GAME_PORT);
+			if (*admin_game != NULL)
+				worker_call((*admin_game)->context,
+					    admin_free_game, *admin_game);
+			*admin_game =
+			    server_start(params, get_server_name(),
+					 server_port,
+					 register_server,
+					 metaserver_name, TRUE);
+			g_free(metaserver_name);
+		}
+		break;
+	case STOPSERVER:
+		if (*admin_game != NULL)
+			worker_call((*admin_game)->context,
+				    admin_stop_game, *admin_game);
+		break;
+	case REGISTERSERVER:
+		register_server = atoi(argument);
+		break;
+	case NUMPLAYERS:
+		cfg_set_num_players(params, atoi(argument));
+		break;
+	case SEVENSRULE:
+		cfg_set_sevens_rule(params, atoi(argument));
+		break;
+	case DICEDECK:
+		cfg_set_use_dice_deck(params, atoi(argument));
+		break;
+	case NUMDICEDECKS:
+		cfg_set_num_dice_decks(params, atoi(argument));
+		break;
+	case NUMREMOVEDDICECARDS:
+		cfg_set_num_removed_dice_cards(params,
+					       atoi(argument));
+		break;
+	case VICTORYPOINTS:
+		cfg_set_victory_points(params, atoi(argument));
+		break;
+	case RANDOMTERRAIN:
+		cfg_set_terrain_type(params, atoi(argument));
+		break;
+	case SETGAME:
+		if (params)
+			params_free(params);
+		params = cfg_set_game(argument);
+		if (!params) {
+			net_printf(admin_session,
+				   "ERROR game '%s' not set\n",
+				   argument);
+		}
+		break;
+	case QUIT:
+		net_close(admin_session);
+		/* Quit the server if the admin leaves */
+		if (!server_is_running(*admin_game))
+			exit(0);
+		break;
+	case MESSAGE:
+		g_strdelimit(argument, "|", '_');
+		if (server_is_running(game))
+			admin_broadcast(game, argument);
+		break;
+	case HELP:
+		for (command_number = 1;
+		     command_number < G_N_ELEMENTS(admin_commands);
+		     ++command_number) {
+			if (admin_commands
+			    [command_number].need_argument) {
+				net_printf(admin_session,
+					   "INFO %s argument\n",
+					   admin_commands
+					   [command_number].
+					   command);
+			} else {
+				net_printf(admin_session,
+					   "INFO %s\n",
+					   admin_commands
+					   [command_number].
+					   command);
+			}
+		}
+		break;
+	case INFO:
+		net_printf(admin_session, "INFO server-port %s\n",
+			   server_port ? server_port :
+			   PIONEERS_DEFAULT_GAME_PORT);
+		net_printf(admin_session,
+			   "INFO register-server %d\n",
+			   register_server);
+		net_printf(admin_session,
+			   "INFO server running %d\n",
+			   server_is_running(game));
+		if (params) {
+			net_printf(admin_session, "INFO game %s\n",
+				   params->title);
+			net_printf(admin_session,
+				   "INFO players %d\n",
+				   params->num_players);
+			net_printf(admin_session,
+				   "INFO victory-points %d\n",
+				   params->victory_points);
+			net_printf(admin_session,
+				   "INFO random-terrain %d\n",
+				   params->random_terrain);
+			net_printf(admin_session,
+				   "INFO sevens-rule %d\n",
+				   params->sevens_rule);
+			if (server_is_running(game)) {
+				gchar *s =
+				    game_printf("INFO bank %R\n",
+						game->bank_deck);
+				net_printf(admin_session, "%s", s);
+				g_free(s);
+
+				playerlist_inc_use_count(game);
+				GList *player =
+				    player_first_real(game);
+				while (player) {
+					Player *p = (Player *)
+					    player->data;
+					if (player_num_is_spectator
+					    (game, p->num)) {
+						s = game_printf
+						    ("INFO spectator %d\n",
+						     p->num);
+					} else {
+						s = game_printf
+						    ("INFO player %d assets %R\n",
+						     p->num,
+						     p->assets);
+					}
+					net_printf(admin_session,
+						   "%s", s);
+					g_free(s);
+					player =
+					    player_next_real
+					    (player);
+				}
+				playerlist_dec_use_count(game);
+			}
+		} else {
+			net_printf(admin_session,
+				   "INFO no game set\n");
+		}
+		if (server_is_running(game)
+		    && game->fixed_dice_roll != 0)
+			net_printf(admin_session,
+				   "INFO dice fixed to %d\n",
+				   game->fixed_dice_roll);
+		break;
+	case FIXDICE:
+		game->fixed_dice_roll =
+		    CLAMP(atoi(argument), 0, 12);
+		if (game->fixed_dice_roll == 1)
+			game->fixed_dice_roll = 0;
+		if (game->fixed_dice_roll != 0) {
+			game->is_manipulated = TRUE;
+			net_printf(admin_session,
+				   "INFO dice fixed to %d\n",
+				   game->fixed_dice_roll);
+		} else
+			net_printf(admin_session,
+				   "INFO dice rolled normally\n");
+		break;
+	case SETBANK:
+		{
+			game_scanf(argument, "%R", &game->bank_deck);
+			game->is_manipulated = TRUE;
+		}
+		// FALL THROUGH
+	case GETBANK:
+		{
+			gchar *s = game_printf("INFO bank %R\n",
+					       game->bank_deck);
+			net_printf(admin_session, "%s", s);
+			g_free(s);
+		}
+		break;
+	case SETASSETS:
+		{
+			gint player_num;
+			gint assets[NO_RESOURCE];
+			Player *player;
+			gint i;
+
+			game_scanf(argument, "%d %R", &player_num,
+				   &assets);
+			player = player_by_num(game, player_num);
+			if (player != NULL
+			    && !player_num_is_spectator(game,
+						    player_num)) {
+				for (i = 0; i < NO_RESOURCE; i++) {
+					game->bank_deck[i] +=
+					    player->assets[i] -
+					    assets[i];
+					player->assets[i] =
+					    assets[i];
+				}
+			}
+			game->is_manipulated = TRUE;
+		}
+		// FALL THROUGH
+	case GETASSETS:
+		{
+			gint player_num;
+			Player *player;
+			game_scanf(argument, "%d", &player_num);
+			player = player_by_num(game, player_num);
+			if (player != NULL) {
+				if (player_num_is_spectator
+				    (game, player_num)) {
+					net_printf(admin_session,
+						   "INFO player %d is spectator\n",
+						   player_num);
+				} else {
+					gchar *s =
+					    game_printf
+					    ("INFO player %d assets %R\n",
+					     player_num,
+					     player->assets);
+					net_printf(admin_session,
+						   "%s", s);
+					g_free(s);
+				}
+			} else {
+				net_printf(admin_session,
+					   "INFO player %d not found\n",
+					   player_num);
+			}
+
+		}
+		break;
+	case LISTGAMES:
+		{
+			GList *games;
+			GList *list;
+
+			games = server_list_games();
+			for (list = games; list != NULL;
+			     list = g_list_next(list)) {
+				Game *hosted = list->data;
+				net_printf(admin_session,
+					   "INFO hosted-game %s "
+					   "running %d players %u/%u "
+					   "%s\n",
+					   hosted->server_port,
+					   server_is_running
+					   (hosted),
+					   hosted->num_players,
+					   hosted->params->
+					   num_players,
+					   hosted->params->title);
+			}
+			g_list_free(games);
+		}
+		break;
+	case SELECTGAME:
+		g_free(selected_port);
+		selected_port = NULL;
+		if (server_find_game(argument) != NULL) {
+			selected_port = g_strdup(argument);
+			net_printf(admin_session,
+				   "INFO game on port %s selected\n",
+				   selected_port);
+		} else {
+			net_printf(admin_session,
+				   "INFO no hosted game on port %s, "
+				   "the started game is selected\n",
+				   argument);
+		}
+		break;
+	case GETMEMORY:
+		{
+			GList *list;
+			gsize total = 0;
+			for (list = game->player_list; list != NULL;
+			     list = g_list_next(list)) {
+				Player *player = list->data;
+				Session *ses =
+				    sm_get_session(player->sm);
+				gsize memory;
+				if (ses == NULL)
+					continue;
+				memory = net_get_memory_use(ses) +
+				    sm_get_cache_size(player->sm);
+				total += memory;
+				net_printf(admin_session,
+					   "INFO player %d memory %"
+					   G_GSIZE_FORMAT " read-buffer %"
+					   G_GSIZE_FORMAT " write-queue %"
+					   G_GSIZE_FORMAT " cache %"
+					   G_GSIZE_FORMAT "\n",
+					   player->num, memory,
+					   net_get_read_buffer_size(ses),
+					   net_get_queued_bytes(ses),
+					   sm_get_cache_size(player->sm));
+			}
+			net_printf(admin_session,
+				   "INFO total memory %" G_GSIZE_FORMAT
+				   "\n", total);
+		}
+		break;
+	}
+	return FALSE;
+}
+
 /* parse 'line' and run the command requested */
 static void admin_run_command(Session * admin_session, const gchar * line)
 {
@@ -119,6 +505,7 @@ static void admin_run_command(Session * admin_session, const gchar * line)
 	gchar *command;
 	gchar *argument;
 	guint command_number;
+	Game *game;
 
 	if (!g_str_has_prefix(line, "admin")) {
 		net_printf(admin_session,
@@ -172,273 +559,22 @@ static void admin_run_command(Session * admin_session, const gchar * line)
 			   "ERROR command '%s' needs valid game parameters\n",
 			   command);
 	} else if (admin_commands[command_number].requirement == NEEDGAME
-		   && (NULL == *admin_game
-		       || !server_is_running(*admin_game))) {
+		   && !server_is_running(admin_selected_game())) {
 		net_printf(admin_session,
 			   "ERROR command '%s' needs a valid game\n",
 			   command);
 	} else {
-		if (admin_commands[command_number].stop_server
-		    && server_is_running(*admin_game)) {
-			server_stop(*admin_game);
-			game_free(*admin_game);
-			*admin_game = NULL;
-			net_write(admin_session, "INFO server stopped\n");
-		}
-		switch (admin_commands[command_number].type) {
-		case BADCOMMAND:
-			net_printf(admin_session,
-				   "ERROR unrecognized command: '%s'\n",
-				   command);
-			break;
-		case SETPORT:
-			if (server_port)
-				g_free(server_port);
-			server_port = g_strdup(argument);
-			break;
-		case STARTSERVER:
-			{
-				gchar *metaserver_name =
-				    get_metaserver_name(TRUE);
-				if (!server_port)
-					server_port =
-					    g_strdup
-					    (PIONEERS_DEFAULT_GAME_PORT);
-				if (*admin_game != NULL)
-					game_free(*admin_game);
-				*admin_game =
-				    server_start(params, get_server_name(),
-						 server_port,
-						 register_server,
-						 metaserver_name, TRUE);
-				g_free(metaserver_name);
-			}
-			break;
-		case STOPSERVER:
-			server_stop(*admin_game);
-			break;
-		case REGISTERSERVER:
-			register_server = atoi(argument);
-			break;
-		case NUMPLAYERS:
-			cfg_set_num_players(params, atoi(argument));
-			break;
-		case SEVENSRULE:
-			cfg_set_sevens_rule(params, atoi(argument));
-			break;
-		case DICEDECK:
-			cfg_set_use_dice_deck(params, atoi(argument));
-			break;
-		case NUMDICEDECKS:
-			cfg_set_num_dice_decks(params, atoi(argument));
-			break;
-		case NUMREMOVEDDICECARDS:
-			cfg_set_num_removed_dice_cards(params,
-						       atoi(argument));
-			break;
-		case VICTORYPOINTS:
-			cfg_set_victory_points(params, atoi(argument));
-			break;
-		case RANDOMTERRAIN:
-			cfg_set_terrain_type(params, atoi(argument));
-			break;
-		case SETGAME:
-			if (params)
-				params_free(params);
-			params = cfg_set_game(argument);
-			if (!params) {
-				net_printf(admin_session,
-					   "ERROR game '%s' not set\n",
-					   argument);
-			}
-			break;
-		case QUIT:
-			net_close(admin_session);
-			/* Quit the server if the admin leaves */
-			if (!server_is_running(*admin_game))
-				exit(0);
-			break;
-		case MESSAGE:
-			g_strdelimit(argument, "|", '_');
-			if (server_is_running(*admin_game))
-				admin_broadcast(*admin_game, argument);
-			break;
-		case HELP:
-			for (command_number = 1;
-			     command_number < G_N_ELEMENTS(admin_commands);
-			     ++command_number) {
-				if (admin_commands
-				    [command_number].need_argument) {
-					net_printf(admin_session,
-						   "INFO %s argument\n",
-						   admin_commands
-						   [command_number].
-						   command);
-				} else {
-					net_printf(admin_session,
-						   "INFO %s\n",
-						   admin_commands
-						   [command_number].
-						   command);
-				}
-			}
-			break;
-		case INFO:
-			net_printf(admin_session, "INFO server-port %s\n",
-				   server_port ? server_port :
-				   PIONEERS_DEFAULT_GAME_PORT);
-			net_printf(admin_session,
-				   "INFO register-server %d\n",
-				   register_server);
-			net_printf(admin_session,
-				   "INFO server running %d\n",
-				   server_is_running(*admin_game));
-			if (params) {
-				net_printf(admin_session, "INFO game %s\n",
-					   params->title);
-				net_printf(admin_session,
-					   "INFO players %d\n",
-					   params->num_players);
-				net_printf(admin_session,
-					   "INFO victory-points %d\n",
-					   params->victory_points);
-				net_printf(admin_session,
-					   "INFO random-terrain %d\n",
-					   params->random_terrain);
-				net_printf(admin_session,
-					   "INFO sevens-rule %d\n",
-					   params->sevens_rule);
-				if (server_is_running(*admin_game)) {
-					gchar *s =
-					    game_printf("INFO bank %R\n",
-							(*admin_game)->bank_deck);
-					net_printf(admin_session, "%s", s);
-					g_free(s);
-
-					playerlist_inc_use_count
-					    (*admin_game);
-					GList *player =
-					    player_first_real(*admin_game);
-					while (player) {
-						Player *p = (Player *)
-						    player->data;
-						if (player_is_spectator
-						    (*admin_game,
-						     p->num)) {
-							s = game_printf
-							    ("INFO spectator %d\n",
-							     p->num);
-						} else {
-							s = game_printf
-							    ("INFO player %d assets %R\n",
-							     p->num,
-							     p->assets);
-						}
-						net_printf(admin_session,
-							   "%s", s);
-						g_free(s);
-						player =
-						    player_next_real
-						    (player);
-					}
-					playerlist_dec_use_count
-					    (*admin_game);
-				}
-			} else {
-				net_printf(admin_session,
-					   "INFO no game set\n");
-			}
-			if (admin_dice_roll != 0)
-				net_printf(admin_session,
-					   "INFO dice fixed to %d\n",
-					   admin_dice_roll);
-			break;
-		case FIXDICE:
-			admin_dice_roll = CLAMP(atoi(argument), 0, 12);
-			if (admin_dice_roll == 1)
-				admin_dice_roll = 0;
-			if (admin_dice_roll != 0) {
-				(*admin_game)->is_manipulated = TRUE;
-				net_printf(admin_session,
-					   "INFO dice fixed to %d\n",
-					   admin_dice_roll);
-			} else
-				net_printf(admin_session,
-					   "INFO dice rolled normally\n");
-			break;
-		case SETBANK:
-			{
-				game_scanf(argument, "%R",
-					   &(*admin_game)->bank_deck);
-				(*admin_game)->is_manipulated = TRUE;
-			}
-			// FALL THROUGH
-		case GETBANK:
-			{
-				gchar *s = game_printf("INFO bank %R\n",
-						       (*admin_game)->bank_deck);
-				net_printf(admin_session, "%s", s);
-				g_free(s);
-			}
-			break;
-		case SETASSETS:
-			{
-				gint player_num;
-				gint assets[NO_RESOURCE];
-				Player *player;
-				gint i;
-
-				game_scanf(argument, "%d %R", &player_num,
-					   &assets);
-				player =
-				    player_by_num(*admin_game, player_num);
-				if (player != NULL
-				    && !player_is_spectator(*admin_game,
-							    player_num)) {
-					for (i = 0; i < NO_RESOURCE; i++) {
-						(*admin_game)->bank_deck[i]
-						    +=
-						    player->assets[i] -
-						    assets[i];
-						player->assets[i] =
-						    assets[i];
-					}
-				}
-				(*admin_game)->is_manipulated = TRUE;
-			}
-			// FALL THROUGH
-		case GETASSETS:
-			{
-				gint player_num;
-				Player *player;
-				game_scanf(argument, "%d", &player_num);
-				player =
-				    player_by_num(*admin_game, player_num);
-				if (player != NULL) {
-					if (player_is_spectator
-					    (*admin_game, player_num)) {
-						net_printf(admin_session,
-							   "INFO player %d is spectator\n",
-							   player_num);
-					} else {
-						gchar *s =
-						    game_printf
-						    ("INFO player %d assets %R\n",
-						     player_num,
-						     player->assets);
-						net_printf(admin_session,
-							   "%s", s);
-						g_free(s);
-					}
-				} else {
-					net_printf(admin_session,
-						   "INFO player %d not found\n",
-						   player_num);
-				}
+		AdminCall call;
 
-			}
-			break;
-		}
+		call.session = admin_session;
+		call.command_number = command_number;
+		call.command = command;
+		call.argument = argument;
+		if (admin_commands[command_number].requirement == NEEDGAME) {
+			game = admin_selected_game();
+			worker_call(game->context, admin_execute, &call);
+		} else
+			admin_execute(&call);
 	}
 	g_free(command);
 	if (argument)
@@ -514,8 +650,3 @@ gboolean admin_init(const gchar * port, Game ** game)
 	}
 	return TRUE;
 }
-
-gint admin_get_dice_roll(void)
-{
-	return admin_dice_roll;
-}
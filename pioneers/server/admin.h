@@ -32,9 +32,4 @@
  */
 gboolean admin_init(const gchar * port, Game ** game);
 
-/** Get the dice roll that was determined by the administrator.
- * @return 0 when not fixed, otherwise the dice roll
- */
-gint admin_get_dice_roll(void);
-
 #endif				/* __admin_h */
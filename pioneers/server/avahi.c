@@ -51,6 +51,7 @@ static AvahiEntryGroup *group = NULL;
 static AvahiGLibPoll *glib_poll = NULL;
 static AvahiClient *client = NULL;
 static char *name = NULL;
+static Game *registered_game = NULL;
 
 static void create_services(AvahiClient * c, Game * game);
 
@@ -204,6 +205,10 @@ void avahi_register_game(Game * game)
 #ifdef HAVE_AVAHI
 	const AvahiPoll *poll_api;
 	int error;
+
+	if (registered_game != NULL)
+		return;
+	registered_game = game;
 	glib_poll = avahi_glib_poll_new(NULL, G_PRIORITY_DEFAULT);
 	poll_api = avahi_glib_poll_get(glib_poll);
 	/* Allocate main loop object */
@@ -212,7 +217,7 @@ void avahi_register_game(Game * game)
 			    _("Avahi error: %s, %s\n"),
 			    _("Unable to register Avahi server"),
 			    "Failed to create glib poll object");
-		avahi_unregister_game();
+		avahi_unregister_game(game);
 		return;
 	}
 
@@ -226,14 +231,17 @@ void avahi_register_game(Game * game)
 			    _("Avahi error: %s, %s\n"),
 			    _("Unable to register Avahi server"),
 			    avahi_strerror(error));
-		avahi_unregister_game();
+		avahi_unregister_game(game);
 	}
 #endif				/* HAVE_AVAHI */
 }
 
-void avahi_unregister_game(void)
-{
 #ifdef HAVE_AVAHI
+static gboolean avahi_unregister(gpointer data)
+{
+	if (data != registered_game)
+		return FALSE;
+	registered_game = NULL;
 
 	/* Cleanup things */
 
@@ -258,5 +266,15 @@ void avahi_unregister_game(void)
 	}
 
 	log_message(MSG_INFO, _("Unregistering Avahi.\n"));
+	return FALSE;
+}
+#endif				/* HAVE_AVAHI */
+
+void avahi_unregister_game(Game * game)
+{
+#ifdef HAVE_AVAHI
+	/* Avahi is driven by the default context, the game can be stopped
+	 * by another thread */
+	g_main_context_invoke(NULL, avahi_unregister, game);
 #endif				/* HAVE_AVAHI */
 }
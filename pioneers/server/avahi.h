@@ -25,12 +25,13 @@
 #include "server.h"
 
 /**
- * Register the Avahi service
+ * Register the Avahi service.
+ * Only one game per process is announced.
  */
 void avahi_register_game(Game * game);
 /**
- * Unregister the Avahi service
+ * Unregister the Avahi service, when it was registered for this game
  */
-void avahi_unregister_game(void);
+void avahi_unregister_game(Game * game);
 
 #endif
@@ -23,6 +23,13 @@
 #include "cost.h"
 #include "server.h"
 
+static gboolean cross_check_longest_road = FALSE;
+
+void set_check_longest_road(gboolean enabled)
+{
+	cross_check_longest_road = enabled;
+}
+
 void check_longest_road(Game * game)
 {
 	Map *map = game->params->map;
@@ -32,7 +39,23 @@ void check_longest_road(Game * game)
 	gboolean tie;
 	guint i;
 
-	map_longest_road(map, road_length, game->params->num_players);
+	road_index_longest_road(game->road_index, road_length,
+				game->params->num_players);
+
+	if (cross_check_longest_road) {
+		guint expected[MAX_PLAYERS];
+
+		map_longest_road(map, expected, game->params->num_players);
+		for (i = 0; i < game->params->num_players; i++) {
+			if (road_length[i] != expected[i]) {
+				log_message(MSG_ERROR,
+					    "Longest road of player %u is "
+					    "%u, expected %u\n", i,
+					    road_length[i], expected[i]);
+				road_length[i] = expected[i];
+			}
+		}
+	}
 
 	num_have_longest = -1;
 	longest_length = 0;
@@ -142,8 +165,15 @@ void node_add(Player * player,
 
 	/* update the node information */
 	node->owner = player->num;
-	if (type == BUILD_CITY_WALL) {
+	if (type == BUILD_CITY_WALL)
 		node->city_wall = TRUE;
+	else
+		node->type = type;
+	road_index_node_changed(game->road_index, node);
+	production_index_node_changed(game->production_index, node);
+	frontier_index_node_changed(game->frontier_index, node);
+	port_index_node_changed(game->port_index, node);
+	if (type == BUILD_CITY_WALL) {
 		/* Older clients see an extension message */
 		player_broadcast_extension(player, PB_RESPOND,
 					   FIRST_VERSION, V0_10,
@@ -151,7 +181,6 @@ void node_add(Player * player,
 		player_broadcast(player, PB_RESPOND, V0_11, LATEST_VERSION,
 				 "built %B %d %d %d\n", type, x, y, pos);
 	} else {
-		node->type = type;
 		player_broadcast(player, PB_RESPOND, FIRST_VERSION,
 				 LATEST_VERSION, "built %B %d %d %d\n",
 				 type, x, y, pos);
@@ -234,6 +263,8 @@ void edge_add(Player * player, BuildType type, int x, int y, int pos,
 	/* update the board */
 	edge->owner = player->num;
 	edge->type = type;
+	road_index_edge_changed(game->road_index, edge);
+	frontier_index_edge_changed(game->frontier_index, edge);
 	player_broadcast(player, PB_RESPOND, FIRST_VERSION, LATEST_VERSION,
 			 "built %B %d %d %d\n", type, x, y, pos);
 
@@ -285,6 +316,10 @@ gboolean perform_undo(Player * player)
 				 BUILD_ROAD, rec->x, rec->y, rec->pos);
 		hex->edges[rec->pos]->owner = -1;
 		hex->edges[rec->pos]->type = BUILD_NONE;
+		road_index_edge_changed(game->road_index,
+					hex->edges[rec->pos]);
+		frontier_index_edge_changed(game->frontier_index,
+					    hex->edges[rec->pos]);
 		break;
 	case BUILD_BRIDGE:
 		player->num_bridges--;
@@ -294,6 +329,10 @@ gboolean perform_undo(Player * player)
 				 BUILD_BRIDGE, rec->x, rec->y, rec->pos);
 		hex->edges[rec->pos]->owner = -1;
 		hex->edges[rec->pos]->type = BUILD_NONE;
+		road_index_edge_changed(game->road_index,
+					hex->edges[rec->pos]);
+		frontier_index_edge_changed(game->frontier_index,
+					    hex->edges[rec->pos]);
 		break;
 	case BUILD_SHIP:
 		player->num_ships--;
@@ -303,6 +342,10 @@ gboolean perform_undo(Player * player)
 				 BUILD_SHIP, rec->x, rec->y, rec->pos);
 		hex->edges[rec->pos]->owner = -1;
 		hex->edges[rec->pos]->type = BUILD_NONE;
+		road_index_edge_changed(game->road_index,
+					hex->edges[rec->pos]);
+		frontier_index_edge_changed(game->frontier_index,
+					    hex->edges[rec->pos]);
 		break;
 	case BUILD_CITY:
 		player->num_cities--;
@@ -312,6 +355,12 @@ gboolean perform_undo(Player * player)
 				 LATEST_VERSION, "remove %B %d %d %d\n",
 				 BUILD_CITY, rec->x, rec->y, rec->pos);
 		hex->nodes[rec->pos]->type = BUILD_SETTLEMENT;
+		road_index_node_changed(game->road_index,
+					hex->nodes[rec->pos]);
+		production_index_node_changed(game->production_index,
+					      hex->nodes[rec->pos]);
+		frontier_index_node_changed(game->frontier_index,
+					    hex->nodes[rec->pos]);
 		if (rec->prev_status == BUILD_SETTLEMENT)
 			break;
 		/* Remove the settlement too */
@@ -325,6 +374,14 @@ gboolean perform_undo(Player * player)
 				 rec->pos);
 		hex->nodes[rec->pos]->type = BUILD_NONE;
 		hex->nodes[rec->pos]->owner = -1;
+		road_index_node_changed(game->road_index,
+					hex->nodes[rec->pos]);
+		production_index_node_changed(game->production_index,
+					      hex->nodes[rec->pos]);
+		frontier_index_node_changed(game->frontier_index,
+					    hex->nodes[rec->pos]);
+		port_index_node_changed(game->port_index,
+					hex->nodes[rec->pos]);
 		break;
 	case BUILD_CITY_WALL:
 		player->num_city_walls--;
@@ -336,13 +393,23 @@ gboolean perform_undo(Player * player)
 				 "remove %B %d %d %d\n", BUILD_CITY_WALL,
 				 rec->x, rec->y, rec->pos);
 		hex->nodes[rec->pos]->city_wall = FALSE;
+		frontier_index_node_changed(game->frontier_index,
+					    hex->nodes[rec->pos]);
 		break;
 	case BUILD_MOVE_SHIP:
 		hex->edges[rec->pos]->owner = -1;
 		hex->edges[rec->pos]->type = BUILD_NONE;
+		road_index_edge_changed(game->road_index,
+					hex->edges[rec->pos]);
+		frontier_index_edge_changed(game->frontier_index,
+					    hex->edges[rec->pos]);
 		hex = map_hex(map, rec->prev_x, rec->prev_y);
 		hex->edges[rec->prev_pos]->owner = player->num;
 		hex->edges[rec->prev_pos]->type = BUILD_SHIP;
+		road_index_edge_changed(game->road_index,
+					hex->edges[rec->prev_pos]);
+		frontier_index_edge_changed(game->frontier_index,
+					    hex->edges[rec->prev_pos]);
 		map->has_moved_ship = FALSE;
 		player_broadcast(player, PB_RESPOND, FIRST_VERSION,
 				 LATEST_VERSION,
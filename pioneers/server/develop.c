@@ -48,7 +48,9 @@ void develop_shuffle(Game * game)
 	for (idx = 0; idx < game->num_develop; idx++) {
 		gint card_idx;
 
-		card_idx = random_guint(game->num_develop - idx);
+		card_idx =
+		    random_guint_context(game->rand_ctx,
+					 game->num_develop - idx);
 		for (shuffle_idx = 0;
 		     shuffle_idx < G_N_ELEMENTS(shuffle_counts);
 		     shuffle_idx++) {
@@ -135,13 +137,18 @@ gboolean mode_road_building(Player * player, gint event)
 		    &&
 		    ((player->num_roads <
 		      game->params->num_build_type[BUILD_ROAD]
-		      && map_can_place_road(map, player->num))
+		      && frontier_index_can_build(game->frontier_index,
+						  player->num, BUILD_ROAD))
 		     || (player->num_ships <
 			 game->params->num_build_type[BUILD_SHIP]
-			 && map_can_place_ship(map, player->num))
+			 && frontier_index_can_build(game->frontier_index,
+						     player->num,
+						     BUILD_SHIP))
 		     || (player->num_bridges <
 			 game->params->num_build_type[BUILD_BRIDGE]
-			 && map_can_place_bridge(map, player->num)))) {
+			 && frontier_index_can_build(game->frontier_index,
+						     player->num,
+						     BUILD_BRIDGE)))) {
 			player_send(player, FIRST_VERSION, LATEST_VERSION,
 				    "ERR expected-build\n");
 			return TRUE;
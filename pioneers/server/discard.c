@@ -134,7 +134,9 @@ void discard_resources(Game * game)
 					total += scan->assets[idx];
 				}
 				while (scan->discard_num) {
-					gint choice = random_guint(total);
+					gint choice =
+					    random_guint_context
+					    (game->rand_ctx, total);
 					for (idx = 0; idx < NO_RESOURCE;
 					     idx++) {
 						choice -=
@@ -117,7 +117,9 @@ static void distribute_next(GList * list)
 				}
 				while ((scan->gold > 0) && (totalbank > 0)) {
 					/* choose one of them */
-					choice = random_guint(totalbank);
+					choice =
+					    random_guint_context
+					    (game->rand_ctx, totalbank);
 					/* find out which resource it is */
 					for (idx = 0; idx < NO_RESOURCE;
 					     ++idx) {
@@ -160,7 +162,7 @@ static void distribute_next(GList * list)
 	     list = player_next_real(list)) {
 		Player *p = list->data;
 		/* spectators were not pushed, they should not be popped */
-		if (player_is_spectator(game, p->num))
+		if (player_num_is_spectator(game, p->num))
 			continue;
 		sm_pop(p->sm);
 		/* this is a hack to get the next setup player.  I'd like to
@@ -233,7 +235,7 @@ void distribute_first(GList * list)
 	     looper = next_player_loop(looper, player)) {
 		Player *scan = looper->data;
 		/* leave the spectators out of this */
-		if (player_is_spectator(game, scan->num))
+		if (player_num_is_spectator(game, scan->num))
 			continue;
 		if (scan->gold > 0) {
 			player_broadcast(scan, PB_ALL, FIRST_VERSION,
@@ -388,7 +388,7 @@ static void gui_player_change(void *data)
 		Player *p = current->data;
 		gboolean isSpectator;
 
-		isSpectator = player_is_spectator(p->game, p->num);
+		isSpectator = player_num_is_spectator(p->game, p->num);
 		if (!isSpectator && !p->disconnected)
 			number_of_players++;
 
@@ -0,0 +1,217 @@
+/* Pioneers - Implementation of the excellent Settlers of Catan board game.
+ *   Go buy a copy.
+ *
+ * Copyright (C) 2026 The Pioneers developers
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include "config.h"
+#include <string.h>
+
+#include "localgame.h"
+#include "local_player.h"
+#include "log.h"
+#include "server.h"
+
+static gboolean local_game_verbose = FALSE;
+
+/* The game that is played in the current thread */
+static THREAD_LOCAL GMainLoop *game_loop;
+static THREAD_LOCAL LocalGameResult *game_result;
+static THREAD_LOCAL gchar *seat_names[MAX_PLAYERS];
+static THREAD_LOCAL guint turn_limit_timer;
+static THREAD_LOCAL gint turn_limit;
+
+static void quiet_log(gint msg_type, const gchar * text)
+{
+	if (msg_type == MSG_ERROR)
+		log_message_string_console(msg_type, text);
+}
+
+void local_game_set_verbose(gboolean verbose)
+{
+	local_game_verbose = verbose;
+	log_set_func(verbose ? NULL : quiet_log);
+}
+
+static gboolean check_turn_limit(gpointer data)
+{
+	Game *game = data;
+
+	if (game->curr_turn <= turn_limit)
+		return TRUE;
+	turn_limit_timer = 0;
+	request_server_stop(game);
+	return FALSE;
+}
+
+static gboolean stop_finished_game(gpointer data)
+{
+	request_server_stop(data);
+	return FALSE;
+}
+
+/** Record the points of all seats */
+static void record_points(Game * game)
+{
+	GList *list;
+	gint seat;
+
+	for (list = player_first_real(game); list != NULL;
+	     list = player_next_real(list)) {
+		Player *player = list->data;
+
+		for (seat = 0; seat < MAX_PLAYERS; seat++) {
+			if (seat_names[seat] != NULL
+			    && strcmp(seat_names[seat], player->name) == 0) {
+				game_result->points[seat] =
+				    player_victory_points(player);
+				if (player->num == game->curr_player
+				    && game->is_game_over)
+					game_result->winner = seat;
+			}
+		}
+	}
+	game_result->turns = game->curr_turn;
+}
+
+void local_game_play(const GameParams * params, gint max_turns,
+		     gchar ** const *seat_args, LocalGameResult * result)
+{
+	LocalPlayer *players[MAX_PLAYERS];
+	GMainContext *context;
+	gint num_local = 0;
+	Game *game;
+	gint64 start;
+	gdouble cpu_start;
+	gboolean finished;
+	gint idx;
+
+	start = g_get_monotonic_time();
+	cpu_start = local_player_thread_cpu_time();
+	result->winner = -1;
+	result->turns = 0;
+	memset(result->points, 0, sizeof(result->points));
+
+	context = g_main_context_ref_thread_default();
+	game = game_new_with_seed(params, result->seed);
+	game->context = g_main_context_ref(context);
+	server_start_local(game);
+
+	/* The server handles the connections in the order they are made,
+	 * so each seat is taken by the same player in every run */
+	for (idx = 0; idx < (gint) game->params->num_players; idx++) {
+		GPtrArray *argv;
+		GMainContext *player_context;
+		Session *ses;
+		gchar *seed;
+
+		player_context = g_main_context_new();
+		seat_names[idx] = player_new_computer_player(game);
+		ses = server_connect_local(game, player_context);
+		if (ses == NULL) {
+			g_main_context_unref(player_context);
+			break;
+		}
+		seed = g_strdup_printf("%" G_GUINT32_FORMAT,
+				       result->seed + 2u * (guint) idx + 1u);
+		argv = g_ptr_array_new();
+		g_ptr_array_add(argv, (gchar *) PIONEERS_AI_PROGRAM_NAME);
+		g_ptr_array_add(argv, (gchar *) "-n");
+		g_ptr_array_add(argv, seat_names[idx]);
+		g_ptr_array_add(argv, (gchar *) "-t");
+		g_ptr_array_add(argv, (gchar *) "0");
+		g_ptr_array_add(argv, (gchar *) "-c");
+		g_ptr_array_add(argv, (gchar *) "--seed");
+		g_ptr_array_add(argv, seed);
+		if (!local_game_verbose)
+			g_ptr_array_add(argv, (gchar *) "--quiet");
+		if (seat_args != NULL && seat_args[idx] != NULL) {
+			gchar **arg;
+			for (arg = seat_args[idx]; *arg != NULL; arg++)
+				g_ptr_array_add(argv, *arg);
+		}
+		g_ptr_array_add(argv, NULL);
+
+		players[num_local++] =
+		    local_player_start(ses, player_context,
+				       (gchar **) argv->pdata);
+		g_ptr_array_free(argv, TRUE);
+		g_free(seed);
+		g_main_context_unref(player_context);
+	}
+
+	if (num_local == (gint) game->params->num_players) {
+		game_loop = g_main_loop_new(context, FALSE);
+		game_result = result;
+		turn_limit = max_turns;
+		if (max_turns > 0)
+			turn_limit_timer =
+			    net_timeout_add(context, 1000,
+					    check_turn_limit, game);
+		g_main_loop_run(game_loop);
+		if (turn_limit_timer != 0) {
+			net_source_remove(context, turn_limit_timer);
+			turn_limit_timer = 0;
+		}
+		game_result = NULL;
+		g_main_loop_unref(game_loop);
+		game_loop = NULL;
+	} else {
+		/* The error has been logged by the network code */
+		server_stop(game);
+	}
+
+	/* The players leave when their connection is closed */
+	do {
+		finished = TRUE;
+		for (idx = 0; idx < num_local; idx++)
+			if (!local_player_is_finished(players[idx]))
+				finished = FALSE;
+		if (!finished)
+			g_main_context_iteration(context, TRUE);
+	} while (!finished);
+
+	result->cpu_time = 0.0;
+	for (idx = 0; idx < num_local; idx++)
+		result->cpu_time += local_player_join(players[idx]);
+	while (g_main_context_iteration(context, FALSE));
+	game_free(game);
+	g_main_context_unref(context);
+	for (idx = 0; idx < MAX_PLAYERS; idx++) {
+		g_free(seat_names[idx]);
+		seat_names[idx] = NULL;
+	}
+
+	result->cpu_time += local_player_thread_cpu_time() - cpu_start;
+	result->wall_time =
+	    (gdouble) (g_get_monotonic_time() - start) / G_USEC_PER_SEC;
+}
+
+void game_is_over(Game * game)
+{
+	/* Not right away, the winner is still being handled */
+	net_idle_add(game->context, stop_finished_game, game);
+}
+
+void request_server_stop(Game * game)
+{
+	if (game_result != NULL && server_is_running(game))
+		record_points(game);
+	server_stop(game);
+	if (game_loop != NULL)
+		g_main_loop_quit(game_loop);
+}
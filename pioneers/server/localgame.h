@@ -0,0 +1,64 @@
+/* Pioneers - Implementation of the excellent Settlers of Catan board game.
+ *   Go buy a copy.
+ *
+ * Copyright (C) 2026 The Pioneers developers
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef __localgame_h
+#define __localgame_h
+
+/** @file localgame.h
+ * Play games between computer players inside the current process.
+ * The server runs in the calling thread, each computer player in a
+ * thread of its own.  Several games can be played at the same time, in
+ * different threads.  The program provides game_is_over() and
+ * request_server_stop() through this module.
+ */
+
+#include <glib.h>
+#include "game.h"
+
+/** The outcome of one game */
+typedef struct {
+	guint32 seed;		/**< Seed of the game, set by the caller */
+	gint winner;		/**< Seat of the winner, -1 if aborted */
+	gint turns;		/**< Number of turns played */
+	gint points[MAX_PLAYERS];	/**< Victory points, by seat */
+	gdouble wall_time;	/**< Seconds */
+	gdouble cpu_time;	/**< Seconds, of the server and the players */
+} LocalGameResult;
+
+/** Show the messages of the server and the reasoning of the players.
+ * By default only errors are shown.
+ * @param verbose Show all messages
+ */
+void local_game_set_verbose(gboolean verbose);
+
+/** Play one game.
+ * The game runs in the thread default context of the caller, which must
+ * not be the global default context when games are played in several
+ * threads.
+ * @param params The rules of the game
+ * @param max_turns Abort the game after this many turns, 0 for no limit
+ * @param seat_args For each seat a NULL terminated list of extra
+ *                  arguments for the computer player, or NULL
+ * @param result The outcome of the game, @c seed must be set
+ */
+void local_game_play(const GameParams * params, gint max_turns,
+		     gchar ** const *seat_args, LocalGameResult * result);
+
+#endif
@@ -46,6 +46,10 @@
 #include "gettext.h"
 
 #include "admin.h"
+#include "worker.h"
+#ifdef HAVE_LOCAL_AI
+#include "local_player.h"
+#endif
 
 static GMainLoop *event_loop;
 
@@ -58,6 +62,8 @@ static gint num_removed_dice_cards = -1;
 static gint terrain = -1;
 static guint timeout = 0;
 static gint num_ai_players = 0;
+static gint num_games = 1;
+static gint num_workers = 0;
 static gchar *server_port = NULL;
 static gchar *admin_port = NULL;
 static gchar *game_title = NULL;
@@ -71,6 +77,12 @@ static gchar *metaserver_name = NULL;
 static gboolean fixed_seating_order = FALSE;
 static gboolean enable_debug = FALSE;
 static gboolean show_version = FALSE;
+#ifdef HAVE_LOCAL_AI
+static gboolean local_ai = FALSE;
+/** The computer players that run in this process */
+static GList *local_players = NULL;
+G_LOCK_DEFINE_STATIC(local_players);
+#endif
 
 static GOptionEntry commandline_game_entries[] = {
 	{ "game-title", 'g', 0, G_OPTION_ARG_STRING, &game_title,
@@ -107,6 +119,17 @@ static GOptionEntry commandline_game_entries[] = {
 	{ "computer-players", 'c', 0, G_OPTION_ARG_INT, &num_ai_players,
 	 /* Commandline server-console: computer-players */
 	 N_("Add N computer players"), "N" },
+	{ "games", 'G', 0, G_OPTION_ARG_INT, &num_games,
+	 /* Commandline server-console: games */
+	 N_("Host N games, on consecutive ports"), "N" },
+	{ "workers", 'w', 0, G_OPTION_ARG_INT, &num_workers,
+	 /* Commandline server-console: workers */
+	 N_("Run the games in N threads"), "N" },
+#ifdef HAVE_LOCAL_AI
+	{ "local-computer-players", 'l', 0, G_OPTION_ARG_NONE, &local_ai,
+	 /* Commandline server-console: local-computer-players */
+	 N_("Run the computer players in threads of the server"), NULL },
+#endif
 	{ "version", '\0', 0, G_OPTION_ARG_NONE, &show_version,
 	 /* Commandline option of server-console: version */
 	 N_("Show version information"), NULL },
@@ -158,14 +181,76 @@ static GOptionEntry commandline_other_entries[] = {
 	{ NULL, '\0', 0, 0, NULL, NULL, NULL }
 };
 
+#ifdef HAVE_LOCAL_AI
+static void start_local_player(Session * ses, GMainContext * context,
+			       gchar ** argv)
+{
+	LocalPlayer *player;
+	GList *list;
+	GList *next;
+
+	player = local_player_start(ses, context, argv);
+
+	G_LOCK(local_players);
+	/* Clean up the players that have left their game */
+	for (list = local_players; list != NULL; list = next) {
+		next = g_list_next(list);
+		if (local_player_is_finished(list->data)) {
+			local_player_join(list->data);
+			local_players =
+			    g_list_delete_link(local_players, list);
+		}
+	}
+	local_players = g_list_prepend(local_players, player);
+	G_UNLOCK(local_players);
+}
+
+/** Wait for the computer players, after their games have stopped.
+ * The players leave when the server side of their connection is closed,
+ * which needs the contexts of the games to run.
+ */
+static void join_local_players(void)
+{
+	G_LOCK(local_players);
+	while (local_players != NULL) {
+		if (!local_player_is_finished(local_players->data)) {
+			G_UNLOCK(local_players);
+			/* Games without a worker run in the default context */
+			g_main_context_iteration(NULL, FALSE);
+			g_usleep(G_USEC_PER_SEC / 100);
+			G_LOCK(local_players);
+			continue;
+		}
+		local_player_join(local_players->data);
+		local_players =
+		    g_list_delete_link(local_players, local_players);
+	}
+	G_UNLOCK(local_players);
+}
+#endif
+
+/* Set up a hosted game, in the thread that runs it */
+static gboolean prepare_hosted_game(gpointer data)
+{
+	Game *game = data;
+	gint i;
+
+	game->no_player_timeout = timeout;
+	start_timeout(game);
+	for (i = 0; i < CLAMP(num_ai_players, 0,
+			      (gint) game->params->num_players); ++i)
+		add_computer_player(game, TRUE);
+	return FALSE;
+}
+
 int main(int argc, char *argv[])
 {
-	int i;
 	GOptionContext *context;
 	GOptionGroup *context_group;
 	GError *error = NULL;
 	GameParams *params;
 	Game *game = NULL;
+	GList *games;
 
 	/* set the UI driver to Glib_Driver, since we're using glib */
 	set_ui_driver(&Glib_Driver);
@@ -287,30 +372,41 @@ int main(int argc, char *argv[])
 		cfg_set_terrain_type(params, terrain ? 1 : 0);
 
 	net_init();
+	worker_pool_start((guint) MAX(num_workers, 0));
+#ifdef HAVE_LOCAL_AI
+	if (local_ai)
+		server_set_local_computer_player(start_local_player);
+#endif
 
 	if (!disable_game_start) {
-		game =
-		    server_start(params, hostname, server_port,
-				 register_server, metaserver_name,
-				 !fixed_seating_order);
-		if (game != NULL) {
-			if (admin_port != NULL) {
-				if (!admin_init(admin_port, &game)) {
-					/* Error message */
-					g_print(_("The network port (%s) "
-						  "for the admin "
-						  "interface is not "
-						  "available.\n"),
-						admin_port);
-				}
+		gint port = atoi(server_port);
+		gint idx;
+
+		for (idx = 0; idx < MAX(num_games, 1); idx++) {
+			Game *hosted_game;
+			gchar *hosted_port;
+
+			hosted_port = g_strdup_printf("%d", port + idx);
+			hosted_game =
+			    server_start(params, hostname, hosted_port,
+					 register_server, metaserver_name,
+					 !fixed_seating_order);
+			g_free(hosted_port);
+			if (hosted_game == NULL)
+				continue;
+			if (game == NULL)
+				game = hosted_game;
+			worker_call(hosted_game->context,
+				    prepare_hosted_game, hosted_game);
+		}
+		if (game != NULL && admin_port != NULL) {
+			if (!admin_init(admin_port, &game)) {
+				/* Error message */
+				g_print(_("The network port (%s) "
+					  "for the admin "
+					  "interface is not "
+					  "available.\n"), admin_port);
 			}
-			game->no_player_timeout = timeout;
-			start_timeout(game);
-			num_ai_players =
-			    CLAMP(num_ai_players, 0,
-				  (gint) game->params->num_players);
-			for (i = 0; i < num_ai_players; ++i)
-				add_computer_player(game, TRUE);
 		}
 	} else {
 		if (admin_port == NULL)
@@ -327,7 +423,13 @@ int main(int argc, char *argv[])
 		event_loop = g_main_loop_new(NULL, FALSE);
 		g_main_loop_run(event_loop);
 		g_main_loop_unref(event_loop);
-		game_free(game);
+#ifdef HAVE_LOCAL_AI
+		join_local_players();
+#endif
+		worker_pool_stop();
+		/* Free all hosted games, including the one of the admin */
+		games = server_list_games();
+		g_list_free_full(games, (GDestroyNotify) game_free);
 		game = NULL;
 	}
 
@@ -341,23 +443,25 @@ int main(int argc, char *argv[])
 	return 0;
 }
 
-static gboolean exit_func(G_GNUC_UNUSED gpointer data)
+static gboolean exit_func(gpointer data)
 {
-	g_main_loop_quit(event_loop);
-	return TRUE;
+	request_server_stop(data);
+	return FALSE;
 }
 
 void game_is_over(Game * game)
 {
 	/* quit in ten seconds if configured */
 	if (game->params->quit_when_done) {
-		g_timeout_add(10 * 1000, &exit_func, NULL);
+		net_timeout_add(game->context, 10 * 1000, &exit_func,
+				game);
 	}
 }
 
 void request_server_stop(Game * game)
 {
-	if (server_stop(game)) {
+	/* Quit when the last hosted game has stopped */
+	if (server_stop(game) && !server_any_running()) {
 		g_main_loop_quit(event_loop);
 	}
 }
@@ -25,34 +25,40 @@
 #include "server.h"
 #include "network.h"
 
-static Session *meta_session;
-static enum {
-	MODE_SIGNON,
-	MODE_REDIRECT,
-	MODE_SERVER_LIST,
-	MODE_REDIRECT_OVERFLOW
-} meta_mode;
+/** The registration of a game at the metaserver.
+ * Each hosted game has its own connection to the metaserver.
+ */
+struct MetaRegistration {
+	Game *game;		/**< The registered game */
+	Session *session;	/**< Connection to the metaserver */
+	enum {
+		MODE_SIGNON,
+		MODE_REDIRECT,
+		MODE_SERVER_LIST,
+		MODE_REDIRECT_OVERFLOW
+	} mode;
 
-static gint metaserver_version_major;
-static gint metaserver_version_minor;
-static gint num_redirects;
-/** TRUE when the server disconnects, FALSE when the other end disconnects */
-static gboolean disconnect_initiated;
-/** GSource identifier for the reconnect timer */
-static guint reconnect_timer = 0;
-/** Reconnect interval in seconds */
-static guint reconnect_interval;
-static gchar *reconnect_server;
-static gchar *reconnect_port;
+	gint version_major;
+	gint version_minor;
+	gint num_redirects;
+	/** TRUE when the server disconnects, FALSE when the other end disconnects */
+	gboolean disconnect_initiated;
+	/** GSource identifier for the reconnect timer */
+	guint reconnect_timer;
+	/** Reconnect interval in seconds */
+	guint reconnect_interval;
+	gchar *reconnect_server;
+	gchar *reconnect_port;
+};
 
 static gboolean timed_out(gpointer data);
-static gboolean meta_connect(Game * game);
+static gboolean meta_connect(MetaRegistration * meta);
 static void meta_redirect(const gchar * server, const gchar * port,
-			  Game * game);
+			  MetaRegistration * meta);
 
-static void start_reconnect_timer(Game * game)
+static void start_reconnect_timer(MetaRegistration * meta)
 {
-	if (reconnect_timer == 0) {
+	if (meta->reconnect_timer == 0) {
 		/* Only the first time */
 		log_message(MSG_ERROR,
 			    _(""
@@ -63,33 +69,40 @@ static void start_reconnect_timer(Game * game)
 		    ngettext(""
 			     "An attempt to reconnect is scheduled in %u second.\n",
 			     "An attempt to reconnect is scheduled in %u seconds.\n",
-			     reconnect_interval), reconnect_interval);
-	reconnect_timer =
-	    g_timeout_add(reconnect_interval * 1000, timed_out, game);
+			     meta->reconnect_interval),
+		    meta->reconnect_interval);
+	meta->reconnect_timer =
+	    net_timeout_add(meta->game->context,
+			    meta->reconnect_interval * 1000, timed_out,
+			    meta);
 }
 
-static void stop_reconnect_timer(void)
+static void stop_reconnect_timer(MetaRegistration * meta)
 {
-	if (reconnect_timer != 0) {
-		g_source_remove(reconnect_timer);
+	if (meta->reconnect_timer != 0) {
+		net_source_remove(meta->game->context,
+				  meta->reconnect_timer);
 	}
-	reconnect_timer = 0;
+	meta->reconnect_timer = 0;
 }
 
 static gboolean timed_out(gpointer data)
 {
-	Game *game = data;
+	MetaRegistration *meta = data;
 	log_message(MSG_INFO,
 		    _("Attempting to reconnect to the metaserver.\n"));
-	reconnect_interval *= 2;
+	meta->reconnect_interval *= 2;
 	/* The maximum reconnection time is 24 hours */
-	if (reconnect_interval > 24 * 3600) {
-		reconnect_interval = 24 * 3600;
+	if (meta->reconnect_interval > 24 * 3600) {
+		meta->reconnect_interval = 24 * 3600;
 	}
-	if (!meta_connect(game)) {
-		start_reconnect_timer(game);
+	if (!meta_connect(meta)) {
+		start_reconnect_timer(meta);
+	} else {
+		/* This timer has expired */
+		meta->reconnect_timer = 0;
 	}
-	disconnect_initiated = FALSE;
+	meta->disconnect_initiated = FALSE;
 	return FALSE;
 }
 
@@ -104,24 +117,29 @@ gchar *get_server_name(void)
 	return server_name;
 }
 
-void meta_start_game(void)
+void meta_start_game(G_GNUC_UNUSED Game * game)
 {
 #ifdef CLOSE_META_AT_START
-	if (ses != NULL) {
-		net_printf(ses, "begin\n");
-		net_free(&ses);
+	MetaRegistration *meta = game->meta;
+	if (meta != NULL && meta->session != NULL) {
+		net_printf(meta->session, "begin\n");
+		net_free(&meta->session);
 	}
 #endif
 }
 
-void meta_report_num_players(guint num_players)
+void meta_report_num_players(Game * game)
 {
-	if (meta_session != NULL && meta_mode == MODE_SERVER_LIST)
-		net_printf(meta_session, "curr=%d\n", num_players);
+	MetaRegistration *meta = game->meta;
+	if (meta != NULL && meta->session != NULL
+	    && meta->mode == MODE_SERVER_LIST)
+		net_printf(meta->session, "curr=%d\n", game->num_players);
 }
 
-static void meta_send_details(Session * ses, Game * game)
+static void meta_send_details(Session * ses, MetaRegistration * meta)
 {
+	Game *game = meta->game;
+
 	net_printf(ses,
 		   "server\n"
 		   "port=%s\n"
@@ -135,7 +153,7 @@ static void meta_send_details(Session * ses, Game * game)
 	if (game->hostname) {
 		net_printf(ses, "host=%s\n", game->hostname);
 	}
-	if (metaserver_version_major >= 1) {
+	if (meta->version_major >= 1) {
 		net_printf(ses,
 			   "vpoints=%d\n"
 			   "sevenrule=%s\n"
@@ -158,11 +176,11 @@ static void meta_send_details(Session * ses, Game * game)
 	}
 }
 
-static void meta_free_session(Session * ses)
+static void meta_free_session(Session * ses, MetaRegistration * meta)
 {
-	disconnect_initiated = TRUE;
-	if (ses == meta_session) {
-		meta_session = NULL;
+	meta->disconnect_initiated = TRUE;
+	if (ses == meta->session) {
+		meta->session = NULL;
 	}
 	net_free(&ses);
 }
@@ -173,29 +191,30 @@ static void meta_free_session(Session * ses)
 static void meta_event(Session * ses, NetEvent event, const gchar * line,
 		       gpointer user_data)
 {
-	Game *game = (Game *) user_data;
+	MetaRegistration *meta = (MetaRegistration *) user_data;
 
 	switch (event) {
 	case NET_READ:
-		if (ses != meta_session) {
+		if (ses != meta->session) {
 			log_message(MSG_ERROR,
 				    _("Receiving data from inactive "
 				      "session: %s\n"), line);
 			return;
 		}
-		switch (meta_mode) {
+		switch (meta->mode) {
 		case MODE_SIGNON:
 		case MODE_REDIRECT:
 			if (strncmp(line, "goto ", 5) == 0) {
 				gchar **split_result;
 				const gchar *port;
-				meta_mode = MODE_REDIRECT;
-				meta_free_session(ses);
-				if (num_redirects++ >= 10) {
+				meta->mode = MODE_REDIRECT;
+				meta_free_session(ses, meta);
+				if (meta->num_redirects++ >= 10) {
 					log_message(MSG_ERROR,
 						    _(""
 						      "Too many metaserver redirects.\n"));
-					meta_mode = MODE_REDIRECT_OVERFLOW;
+					meta->mode =
+					    MODE_REDIRECT_OVERFLOW;
 					return;
 				}
 				split_result = g_strsplit(line, " ", 0);
@@ -206,7 +225,7 @@ static void meta_event(Session * ses, NetEvent event, const gchar * line,
 					if (split_result[2])
 						port = split_result[2];
 					meta_redirect(split_result[1],
-						      port, game);
+						      port, meta);
 				} else {
 					log_message(MSG_ERROR,
 						    _(""
@@ -217,26 +236,26 @@ static void meta_event(Session * ses, NetEvent event, const gchar * line,
 				break;
 			}
 
-			disconnect_initiated = FALSE;
-			reconnect_interval = 5;
-			stop_reconnect_timer();
-			metaserver_version_major = 0;
-			metaserver_version_minor = 0;
+			meta->disconnect_initiated = FALSE;
+			meta->reconnect_interval = 5;
+			stop_reconnect_timer(meta);
+			meta->version_major = 0;
+			meta->version_minor = 0;
 			if (strncmp(line, "welcome ", 8) == 0) {
 				char *p = strstr(line, "version ");
 				if (p) {
 					p += 8;
-					metaserver_version_major = atoi(p);
+					meta->version_major = atoi(p);
 					p += strspn(p, "0123456789");
 					if (*p == '.')
-						metaserver_version_minor =
+						meta->version_minor =
 						    atoi(p + 1);
 				}
 			}
 			net_printf(ses, "version %s\n",
 				   META_PROTOCOL_VERSION);
-			meta_send_details(ses, game);
-			meta_mode = MODE_SERVER_LIST;
+			meta_send_details(ses, meta);
+			meta->mode = MODE_SERVER_LIST;
 			break;
 		default:
 			log_message(MSG_ERROR,
@@ -248,56 +267,60 @@ static void meta_event(Session * ses, NetEvent event, const gchar * line,
 		break;
 	case NET_CLOSE:
 		/* During a reconnect, different sessions might co-exist */
-		if (ses == meta_session
-		    && meta_mode != MODE_REDIRECT_OVERFLOW) {
-			if (!disconnect_initiated) {
-				start_reconnect_timer(game);
+		if (ses == meta->session
+		    && meta->mode != MODE_REDIRECT_OVERFLOW) {
+			if (!meta->disconnect_initiated) {
+				start_reconnect_timer(meta);
 			}
 		}
-		meta_free_session(ses);
+		meta_free_session(ses, meta);
 		break;
 	case NET_CONNECT:
 		net_set_check_connection_alive(ses, 480u);
 		break;
 	case NET_CONNECT_FAIL:
-		if (!disconnect_initiated) {
-			start_reconnect_timer(game);
+		if (!meta->disconnect_initiated) {
+			start_reconnect_timer(meta);
 		};
-		meta_free_session(ses);
+		meta_free_session(ses, meta);
 		break;
 	}
 }
 
-static gboolean meta_connect(Game * game)
+static gboolean meta_connect(MetaRegistration * meta)
 {
-	if (meta_session != NULL)
-		net_free(&meta_session);
+	if (meta->session != NULL)
+		net_free(&meta->session);
 
-	meta_session = net_new(meta_event, game);
-	if (net_connect(meta_session, reconnect_server, reconnect_port)) {
-		meta_mode = MODE_SIGNON;
+	meta->session = net_new(meta_event, meta);
+	net_set_context(meta->session, meta->game->context);
+	if (net_connect
+	    (meta->session, meta->reconnect_server,
+	     meta->reconnect_port)) {
+		meta->mode = MODE_SIGNON;
 		return TRUE;
 	} else {
-		net_free(&meta_session);
+		net_free(&meta->session);
 		return FALSE;
 	}
 }
 
 static void meta_prepare_connection(const gchar * server,
-				    const gchar * port, Game * game)
+				    const gchar * port,
+				    MetaRegistration * meta)
 {
-	g_free(reconnect_server);
-	g_free(reconnect_port);
+	g_free(meta->reconnect_server);
+	g_free(meta->reconnect_port);
 
-	reconnect_server = g_strdup(server);
-	reconnect_port = g_strdup(port);
+	meta->reconnect_server = g_strdup(server);
+	meta->reconnect_port = g_strdup(port);
 
-	disconnect_initiated = TRUE;
-	meta_connect(game);
+	meta->disconnect_initiated = TRUE;
+	meta_connect(meta);
 }
 
 static void meta_redirect(const gchar * server, const gchar * port,
-			  Game * game)
+			  MetaRegistration * meta)
 {
 	if (strcmp(port, PIONEERS_DEFAULT_META_PORT) == 0) {
 		log_message(MSG_INFO, _("Redirected to the "
@@ -307,24 +330,41 @@ static void meta_redirect(const gchar * server, const gchar * port,
 					"metaserver at %s, port %s.\n"),
 			    server, port);
 	}
-	meta_prepare_connection(server, port, game);
+	meta_prepare_connection(server, port, meta);
 }
 
 void meta_register(const gchar * server, Game * game)
 {
+	MetaRegistration *meta;
+
 	log_message(MSG_INFO, _("Register with the metaserver at %s.\n"),
 		    server);
-	num_redirects = 0;
-	meta_prepare_connection(server, PIONEERS_DEFAULT_META_PORT, game);
+	if (game->meta == NULL) {
+		game->meta = g_malloc0(sizeof(*game->meta));
+		game->meta->game = game;
+		game->meta->reconnect_interval = 5;
+	}
+	meta = game->meta;
+	meta->num_redirects = 0;
+	meta_prepare_connection(server, PIONEERS_DEFAULT_META_PORT, meta);
 }
 
-void meta_unregister(void)
+void meta_unregister(Game * game)
 {
-	disconnect_initiated = TRUE;
-	if (meta_session != NULL) {
+	MetaRegistration *meta = game->meta;
+
+	if (meta == NULL)
+		return;
+
+	meta->disconnect_initiated = TRUE;
+	if (meta->session != NULL) {
 		log_message(MSG_INFO,
 			    _("Unregister from the metaserver.\n"));
-		net_free(&meta_session);
-		stop_reconnect_timer();
+		net_free(&meta->session);
 	}
+	stop_reconnect_timer(meta);
+	g_free(meta->reconnect_server);
+	g_free(meta->reconnect_port);
+	g_free(meta);
+	game->meta = NULL;
 }
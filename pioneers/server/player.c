@@ -60,26 +60,21 @@ static gint next_free_player_num(Game * game, gboolean force_spectator)
 	gint idx;
 
 	if (!force_spectator) {
-		GList *list;
 		gboolean player_taken[MAX_PLAYERS];
 		guint available = game->params->num_players;
 
 		memset(player_taken, 0, sizeof(player_taken));
-		playerlist_inc_use_count(game);
-		for (list = game->player_list;
-		     list != NULL; list = g_list_next(list)) {
-			Player *player = list->data;
-			if (player->num >= 0
-			    && !player_is_spectator(game, player->num)) {
-				player_taken[player->num] = TRUE;
+		for (idx = 0; idx < (gint) game->params->num_players; idx++)
+			if (game->seats[idx] != NULL) {
+				player_taken[idx] = TRUE;
 				--available;
 			}
-		}
-		playerlist_dec_use_count(game);
 		if (available > 0) {
 			guint skip;
 			if (game->random_order) {
-				skip = random_guint(available);
+				skip =
+				    random_guint_context(game->rand_ctx,
+							 available);
 			} else {
 				skip = 0;
 			}
@@ -115,10 +110,10 @@ static gboolean mode_global(Player * player, gint event)
 		if (player->devel != NULL)
 			deck_free(player->devel, NULL);
 		if (player->num >= 0
-		    && !player_is_spectator(game, player->num)
+		    && !player_num_is_spectator(game, player->num)
 		    && !player->disconnected) {
 			game->num_players--;
-			meta_report_num_players(game->num_players);
+			meta_report_num_players(game);
 		}
 		g_list_free(player->build_list);
 		g_list_free(player->special_points);
@@ -214,7 +209,7 @@ static gboolean tournament_start_cb(gpointer data)
 	GList *player;
 	gboolean human_player_present;
 
-	g_source_remove(game->tournament_timer);
+	net_source_remove(game->context, game->tournament_timer);
 	game->tournament_timer = 0;
 
 	/* if game already started */
@@ -250,7 +245,7 @@ static gboolean tournament_start_cb(gpointer data)
 	     player != NULL && !human_player_present;
 	     player = g_list_next(player)) {
 		Player *p = player->data;
-		if (!player_is_spectator(game, p->num)
+		if (!player_num_is_spectator(game, p->num)
 		    && determine_player_type(p->style) == PLAYER_HUMAN) {
 			human_player_present = TRUE;
 		}
@@ -300,7 +295,7 @@ static gboolean talk_about_tournament_cb(gpointer data)
 					  "tournament timer is reset."));
 			game->tournament_countdown =
 			    game->params->tournament_time;
-			g_source_remove(game->tournament_timer);
+			net_source_remove(game->context, game->tournament_timer);
 			game->tournament_timer = 0;
 		}
 		return FALSE;
@@ -318,8 +313,8 @@ static gboolean talk_about_tournament_cb(gpointer data)
 	game->tournament_countdown--;
 
 	if (game->tournament_countdown > 0)
-		g_timeout_add(tournament_minute,
-			      &talk_about_tournament_cb, game);
+		net_timeout_add(game->context, tournament_minute,
+				&talk_about_tournament_cb, game);
 
 	return FALSE;
 }
@@ -346,7 +341,8 @@ static gchar *generate_name_for_computer_player(Game * game)
 	} else {
 		while (read_line_from_file(&line, stream)) {
 			if (player_by_name(game, line) == NULL) {
-				if (g_random_int_range(0, num) == 0) {
+				if (random_guint_context
+				    (game->rand_ctx, (guint) num) == 0) {
 					if (name)
 						g_free(name);
 					name = g_strdup(line);
@@ -536,6 +532,26 @@ static void player_set_name_real(Player * player, gchar * name,
 	driver->player_change(game);
 }
 
+/* Give the player the seat of its number, unless it is a spectator */
+static void player_take_seat(Player * player)
+{
+	Game *game = player->game;
+
+	if (player->num < 0 || player_num_is_spectator(game, player->num))
+		return;
+	game->seats[player->num] = g_list_find(game->player_list, player);
+}
+
+/* Remove the player from the player list, and free its seat */
+static void player_list_remove(Game * game, Player * player)
+{
+	if (player->num >= 0 && player->num < MAX_PLAYERS
+	    && game->seats[player->num] != NULL
+	    && game->seats[player->num]->data == player)
+		game->seats[player->num] = NULL;
+	game->player_list = g_list_remove(game->player_list, player);
+}
+
 static void player_setup(Player * player, gint playernum,
 			 const gchar * name, gboolean force_spectator)
 {
@@ -548,10 +564,11 @@ static void player_setup(Player * player, gint playernum,
 	if (player->num < 0) {
 		player->num = next_free_player_num(game, force_spectator);
 	}
+	player_take_seat(player);
 
-	if (!player_is_spectator(game, player->num)) {
+	if (!player_num_is_spectator(game, player->num)) {
 		game->num_players++;
-		meta_report_num_players(game->num_players);
+		meta_report_num_players(game);
 	}
 
 	player->num_roads = 0;
@@ -562,7 +579,7 @@ static void player_setup(Player * player, gint playernum,
 
 	/* give the player her new name */
 	if (name == NULL) {
-		if (player_is_spectator(game, player->num)) {
+		if (player_num_is_spectator(game, player->num)) {
 			gint num = 1;
 			do {
 				sprintf(nm, _("Spectator %d"), num++);
@@ -626,7 +643,7 @@ void player_free(Player * player)
 		return;
 	}
 
-	game->player_list = g_list_remove(game->player_list, player);
+	player_list_remove(game, player);
 	driver->player_change(game);
 
 	sm_free(player->sm);
@@ -654,7 +671,7 @@ void player_archive(Player * player)
 	GList *pl;
 
 	/* If this was a spectator, forget about him */
-	if (player_is_spectator(game, player->num)) {
+	if (player_num_is_spectator(game, player->num)) {
 		player_free(player);
 		return;
 	}
@@ -699,7 +716,7 @@ void player_archive(Player * player)
 
 	/* Inform the metaserver */
 	game->num_players--;
-	meta_report_num_players(game->num_players);
+	meta_report_num_players(game);
 
 	/* if no human players are present, start timer */
 	playerlist_inc_use_count(game);
@@ -707,7 +724,7 @@ void player_archive(Player * player)
 	for (pl = game->player_list;
 	     pl != NULL && !human_player_present; pl = g_list_next(pl)) {
 		Player *p = pl->data;
-		if (!player_is_spectator(game, p->num)
+		if (!player_num_is_spectator(game, p->num)
 		    && !p->disconnected
 		    && determine_player_type(p->style) == PLAYER_HUMAN) {
 			human_player_present = TRUE;
@@ -717,8 +734,9 @@ void player_archive(Player * player)
 	if (!human_player_present && game->no_humans_timer == 0
 	    && is_tournament_game(game)) {
 		game->no_humans_timer =
-		    g_timeout_add(time_to_wait_for_players, timed_out,
-				  game);
+		    net_timeout_add(game->context,
+				    time_to_wait_for_players, timed_out,
+				    game);
 		player_broadcast(player_none(game), PB_SILENT,
 				 FIRST_VERSION, LATEST_VERSION,
 				 "NOTE %s\n",
@@ -740,7 +758,7 @@ void player_revive(Player * newp, char *name)
 	gchar *safe_name;
 
 	if (game->no_humans_timer != 0) {
-		g_source_remove(game->no_humans_timer);
+		net_source_remove(game->context, game->no_humans_timer);
 		game->no_humans_timer = 0;
 		player_broadcast(player_none(game), PB_SILENT,
 				 FIRST_VERSION, LATEST_VERSION,
@@ -794,7 +812,7 @@ void player_revive(Player * newp, char *name)
 	    (game->setup_player && game->setup_player->data == p);
 
 	/* remove the disconnected player from the player list, it's memory will be freed at the end of this routine */
-	game->player_list = g_list_remove(game->player_list, p);
+	player_list_remove(game, p);
 
 	/* initialize the player */
 	player_setup(newp, p->num, name, FALSE);
@@ -995,11 +1013,12 @@ static void start_tournament_mode(Player * player)
 			game->tournament_countdown =
 			    game->params->tournament_time;
 			game->tournament_timer =
-			    g_timeout_add(game->tournament_countdown *
-					  tournament_minute + 500,
-					  &tournament_start_cb, game);
-			g_timeout_add(1000, &talk_about_tournament_cb,
-				      game);
+			    net_timeout_add(game->context,
+					    game->tournament_countdown *
+					    tournament_minute + 500,
+					    &tournament_start_cb, game);
+			net_timeout_add(game->context, 1000,
+					&talk_about_tournament_cb, game);
 		} else {
 			if (game->tournament_timer != 0
 			    && game->num_players !=
@@ -1057,17 +1076,7 @@ static gboolean mode_check_status(Player * player, gint event)
 /* Returns a GList* to player 0 */
 GList *player_first_real(Game * game)
 {
-	GList *list;
-	/* search for player 0 */
-	playerlist_inc_use_count(game);
-	for (list = game->player_list;
-	     list != NULL; list = g_list_next(list)) {
-		Player *player = list->data;
-		if (player->num == 0)
-			break;
-	}
-	playerlist_dec_use_count(game);
-	return list;
+	return game->seats[0];
 }
 
 /* Returns a GList * to a player with a number one higher than last */
@@ -1077,7 +1086,6 @@ GList *player_next_real(GList * last)
 	Game *game;
 	guint numplayers;
 	gint nextnum;
-	GList *list;
 
 	if (!last)
 		return NULL;
@@ -1090,15 +1098,7 @@ GList *player_next_real(GList * last)
 	if (nextnum >= (gint) numplayers)
 		return NULL;
 
-	playerlist_inc_use_count(game);
-	for (list = game->player_list; list != NULL;
-	     list = g_list_next(list)) {
-		Player *scan = list->data;
-		if (scan->num == nextnum)
-			break;
-	}
-	playerlist_dec_use_count(game);
-	return list;
+	return game->seats[nextnum];
 }
 
 static Player *player_by_name(Game * game, char *name)
@@ -1125,6 +1125,11 @@ Player *player_by_num(Game * game, gint num)
 {
 	GList *list;
 
+	/* The players have a seat, the spectators are looked up */
+	if (num >= 0 && !player_num_is_spectator(game, num))
+		return game->seats[num] != NULL ?
+		    game->seats[num]->data : NULL;
+
 	playerlist_inc_use_count(game);
 	for (list = game->player_list;
 	     list != NULL; list = g_list_next(list)) {
@@ -1140,7 +1145,7 @@ Player *player_by_num(Game * game, gint num)
 	return NULL;
 }
 
-gboolean player_is_spectator(Game * game, gint player_num)
+gboolean player_num_is_spectator(Game * game, gint player_num)
 {
 	return (gint) game->params->num_players <= player_num;
 }
@@ -1149,12 +1154,27 @@ gboolean player_is_spectator(Game * game, gint player_num)
  */
 Player *player_none(Game * game)
 {
-	static Player player;
+	Player *player = &game->no_player;
 
-	player.game = game;
-	player.num = -1;
-	player.disconnected = TRUE;
-	return &player;
+	player->game = game;
+	player->num = -1;
+	player->disconnected = TRUE;
+	return player;
+}
+
+/** Format a broadcast line into a shared buffer */
+static GBytes *broadcast_bytes(const gchar * fmt, ...)
+{
+	GString *buffer = g_string_sized_new(64);
+	gsize len;
+	va_list ap;
+
+	va_start(ap, fmt);
+	game_vprintf_into(buffer, fmt, ap);
+	va_end(ap);
+
+	len = buffer->len;
+	return g_bytes_new_take(g_string_free(buffer, FALSE), len);
 }
 
 /** Broadcast a message to all players and spectators - prepend "player %d " to
@@ -1178,6 +1198,10 @@ static void player_broadcast_internal(Player * player, BroadcastType type,
 {
 	Game *game = player->game;
 	GList *list;
+	/* Only two different lines are sent, each is formatted once
+	 * and shared by all recipients */
+	GBytes *plain = NULL;
+	GBytes *prefixed = NULL;
 
 	playerlist_inc_use_count(game);
 	for (list = game->player_list; list != NULL;
@@ -1190,31 +1214,28 @@ static void player_broadcast_internal(Player * player, BroadcastType type,
 			continue;
 		if (type == PB_SILENT
 		    || (scan == player && type == PB_RESPOND)) {
-			if (is_extension) {
-				player_send(scan, first_supported_version,
-					    last_supported_version,
-					    "extension %s", message);
-			} else {
-				player_send(scan, first_supported_version,
-					    last_supported_version, "%s",
-					    message);
-			}
+			if (plain == NULL)
+				plain = is_extension ?
+				    broadcast_bytes("extension %s",
+						    message) :
+				    broadcast_bytes("%s", message);
+			sm_write_bytes(scan->sm, plain);
 		} else if (scan != player || type == PB_ALL) {
-			if (is_extension) {
-				player_send(scan, first_supported_version,
-					    last_supported_version,
-					    "extension player %d %s",
-					    player->num, message);
-			} else {
-				player_send(scan, first_supported_version,
-					    last_supported_version,
-					    "player %d %s", player->num,
-					    message);
-			}
-
+			if (prefixed == NULL)
+				prefixed = is_extension ?
+				    broadcast_bytes
+				    ("extension player %d %s", player->num,
+				     message) :
+				    broadcast_bytes("player %d %s",
+						    player->num, message);
+			sm_write_bytes(scan->sm, prefixed);
 		}
 	}
 	playerlist_dec_use_count(game);
+	if (plain != NULL)
+		g_bytes_unref(plain);
+	if (prefixed != NULL)
+		g_bytes_unref(prefixed);
 }
 
 /** As player_broadcast, but will add the 'extension' keyword */
@@ -344,10 +344,10 @@ static void try_start_game(Game * game)
 	/* All players have connected, and are ready to begin
 	 */
 	if (game->tournament_timer != 0) {
-		g_source_remove(game->tournament_timer);
+		net_source_remove(game->context, game->tournament_timer);
 		game->tournament_timer = 0;
 	}
-	meta_start_game();
+	meta_start_game(game);
 	game->setup_player = player_first_real(game);
 	while (((Player *) game->setup_player->data)->num < 0)
 		game->setup_player = game->setup_player->next;
@@ -393,6 +393,73 @@ static void send_game_line(gpointer player, const gchar * str)
 			     LATEST_VERSION, "%s\n", str);
 }
 
+/* Send the buildings as compact lists, to clients that understand them.
+ * A node is sent as the distance to the previous id, the owner, and 1
+ * for a city plus 2 for a city wall.  An edge is sent as the distance
+ * to the previous id, the owner, and 0 for a road, 1 for a ship or 2
+ * for a bridge.
+ */
+static void send_board_uncached(Player * player, const Map * map)
+{
+	GString *nodes;
+	GString *edges;
+	guint prev;
+	guint idx;
+
+	if (player->version < V16)
+		return;
+
+	nodes = g_string_new(NULL);
+	prev = 0;
+	for (idx = 0; idx < map->num_nodes; idx++) {
+		const Node *node = map->nodes[idx];
+
+		if (node->owner < 0 || node->type == BUILD_NONE)
+			continue;
+		game_append_compact(nodes, idx - prev);
+		game_append_compact(nodes, (guint) node->owner);
+		game_append_compact(nodes,
+				    (node->type == BUILD_CITY ? 1u : 0u)
+				    | (node->city_wall ? 2u : 0u));
+		prev = idx;
+	}
+	edges = g_string_new(NULL);
+	prev = 0;
+	for (idx = 0; idx < map->num_edges; idx++) {
+		const Edge *edge = map->edges[idx];
+		guint type;
+
+		if (edge->owner < 0)
+			continue;
+		switch (edge->type) {
+		case BUILD_ROAD:
+			type = 0;
+			break;
+		case BUILD_SHIP:
+			type = 1;
+			break;
+		case BUILD_BRIDGE:
+			type = 2;
+			break;
+		default:
+			continue;
+		}
+		game_append_compact(edges, idx - prev);
+		game_append_compact(edges, (guint) edge->owner);
+		game_append_compact(edges, type);
+		prev = idx;
+	}
+
+	if (nodes->len > 0)
+		player_send_uncached(player, V16, LATEST_VERSION,
+				     "board nodes %s\n", nodes->str);
+	if (edges->len > 0)
+		player_send_uncached(player, V16, LATEST_VERSION,
+				     "board edges %s\n", edges->str);
+	g_string_free(nodes, TRUE);
+	g_string_free(edges, TRUE);
+}
+
 gboolean send_gameinfo_uncached(const Hex * hex, void *data)
 {
 	guint i;
@@ -406,14 +473,14 @@ gboolean send_gameinfo_uncached(const Hex * hex, void *data)
 			switch (hex->nodes[i]->type) {
 			case BUILD_SETTLEMENT:
 				player_send_uncached(player, FIRST_VERSION,
-						     LATEST_VERSION,
+						     V15,
 						     "S%d,%d,%d,%d\n",
 						     hex->x, hex->y, i,
 						     hex->nodes[i]->owner);
 				break;
 			case BUILD_CITY:
 				player_send_uncached(player, FIRST_VERSION,
-						     LATEST_VERSION,
+						     V15,
 						     "C%d,%d,%d,%d\n",
 						     hex->x, hex->y, i,
 						     hex->nodes[i]->owner);
@@ -427,7 +494,7 @@ gboolean send_gameinfo_uncached(const Hex * hex, void *data)
 						     V0_10,
 						     "extension city wall\n");
 				player_send_uncached(player, V0_11,
-						     LATEST_VERSION,
+						     V15,
 						     "W%d,%d,%d,%d\n",
 						     hex->x, hex->y, i,
 						     hex->nodes[i]->owner);
@@ -443,21 +510,21 @@ gboolean send_gameinfo_uncached(const Hex * hex, void *data)
 			switch (hex->edges[i]->type) {
 			case BUILD_ROAD:
 				player_send_uncached(player, FIRST_VERSION,
-						     LATEST_VERSION,
+						     V15,
 						     "R%d,%d,%d,%d\n",
 						     hex->x, hex->y, i,
 						     hex->edges[i]->owner);
 				break;
 			case BUILD_SHIP:
 				player_send_uncached(player, FIRST_VERSION,
-						     LATEST_VERSION,
+						     V15,
 						     "SH%d,%d,%d,%d\n",
 						     hex->x, hex->y, i,
 						     hex->edges[i]->owner);
 				break;
 			case BUILD_BRIDGE:
 				player_send_uncached(player, FIRST_VERSION,
-						     LATEST_VERSION,
+						     V15,
 						     "B%d,%d,%d,%d\n",
 						     hex->x, hex->y, i,
 						     hex->edges[i]->owner);
@@ -494,7 +561,6 @@ gboolean mode_pre_game(Player * player, gint event)
 	GList *next;
 	gint longestroadpnum = -1;
 	gint largestarmypnum = -1;
-	static gboolean recover_from_plenty = FALSE;
 	guint stack_offset;
 	gchar *player_style;
 
@@ -559,6 +625,7 @@ gboolean mode_pre_game(Player * player, gint event)
 					     LATEST_VERSION, "gameinfo\n");
 			map_traverse_const(map, send_gameinfo_uncached,
 					   player);
+			send_board_uncached(player, map);
 			player_send_uncached(player, FIRST_VERSION,
 					     LATEST_VERSION, ".\n");
 
@@ -634,7 +701,7 @@ gboolean mode_pre_game(Player * player, gint event)
 				prevstate = "MONOPOLY";
 			else if (state ==
 				 (StateFunc) mode_plenty_resources) {
-				recover_from_plenty = TRUE;
+				player->recover_from_plenty = TRUE;
 				prevstate = "PLENTY";
 			} else if (state == (StateFunc) mode_setup) {
 				if (game->double_setup)
@@ -844,12 +911,12 @@ gboolean mode_pre_game(Player * player, gint event)
 							     reverse_setup);
 			}
 
-			if (recover_from_plenty) {
+			if (player->recover_from_plenty) {
 				player_send_uncached(player, FIRST_VERSION,
 						     LATEST_VERSION,
 						     "plenty %R\n",
 						     game->bank_deck);
-				recover_from_plenty = FALSE;
+				player->recover_from_plenty = FALSE;
 			}
 
 			/* send discard and gold info for all players */
@@ -930,6 +997,10 @@ gboolean mode_pre_game(Player * player, gint event)
 							     player->num);
 				}
 			}
+			debug("Player %d: sending %" G_GSIZE_FORMAT
+			      " cached bytes (peak %" G_GSIZE_FORMAT ")\n",
+			      player->num, sm_get_cache_size(sm),
+			      sm_get_peak_cache_size(sm));
 			sm_set_use_cache(sm, FALSE);
 
 			if (player->disconnected) {
@@ -954,7 +1025,7 @@ gboolean mode_pre_game(Player * player, gint event)
 					}
 				}
 			} else {
-				if (!player_is_spectator
+				if (!player_num_is_spectator
 				    (game, player->num))
 					sm_goto(sm, (StateFunc) mode_idle);
 				else
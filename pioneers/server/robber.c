@@ -23,14 +23,14 @@
 #include "server.h"
 #include "random.h"
 
-static Hex *previous_robber_hex;
-
 static void move_pirate(Player * player, Hex * hex, gboolean is_undo)
 {
 	Map *map = hex->map;
 
-	previous_robber_hex = map->pirate_hex;
+	player->game->previous_robber_hex = map->pirate_hex;
 	map->pirate_hex = hex;
+	frontier_index_pirate_moved(player->game->frontier_index,
+				    player->game->previous_robber_hex, hex);
 	/* 0.10 didn't know about undo for movement, so move happens
 	 * only after stealing has been done.  */
 	if (is_undo) {
@@ -46,11 +46,14 @@ static void move_robber(Player * player, Hex * hex, gboolean is_undo)
 {
 	Map *map = hex->map;
 
-	previous_robber_hex = map->robber_hex;
+	player->game->previous_robber_hex = map->robber_hex;
 	if (map->robber_hex)
 		map->robber_hex->robber = FALSE;
 	map->robber_hex = hex;
 	map->robber_hex->robber = TRUE;
+	production_index_robber_moved(player->game->production_index,
+				      player->game->previous_robber_hex,
+				      hex);
 	/* 0.10 didn't know about undo for movement, so move happens
 	 * only after stealing has been done.  */
 	if (is_undo) {
@@ -83,7 +86,7 @@ static void steal_card_from(Player * player, Player * victim)
 
 	/* Work out which card to steal from the victim
 	 */
-	steal = random_guint(num);
+	steal = random_guint_context(game->rand_ctx, num);
 	for (idx = 0; idx < G_N_ELEMENTS(victim->assets); idx++) {
 		steal -= victim->assets[idx];
 		if (steal < 0)
@@ -463,6 +466,8 @@ void robber_place(Player * player)
 
 void robber_undo(Player * player)
 {
+	Hex *previous_robber_hex = player->game->previous_robber_hex;
+
 	if (previous_robber_hex->terrain == SEA_TERRAIN)
 		move_pirate(player, previous_robber_hex, TRUE);
 	else
@@ -0,0 +1,261 @@
+/* Pioneers - Implementation of the excellent Settlers of Catan board game.
+ *   Go buy a copy.
+ *
+ * Copyright (C) 2026 The Pioneers developers
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+/* Pioneers Self-Play Engine
+ *
+ * Plays games between computer players without any network traffic or
+ * child processes.  The server and the computer players of a game run
+ * in threads of this process, and are connected by socket pairs.
+ * Several games are played at the same time, one per job.
+ */
+#include "config.h"
+#include "version.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <glib.h>
+#include <glib-object.h>
+
+#include "driver.h"
+#include "game.h"
+#include "network.h"
+#include "log.h"
+#include "server.h"
+
+#include "common_glib.h"
+#include "glib-driver.h"
+#include "gettext.h"
+#include "localgame.h"
+
+static gint num_players = 0;
+static gint num_points = 0;
+static gint num_games = 1;
+static gint num_jobs = 1;
+static gint64 base_seed = -1;
+static gint max_turns = 1000;
+static gchar *game_title = NULL;
+static gchar *game_file = NULL;
+static gchar *algorithm = NULL;
+static gboolean verbose = FALSE;
+static gboolean show_version = FALSE;
+
+static GOptionEntry commandline_entries[] = {
+	{ "game-title", 'g', 0, G_OPTION_ARG_STRING, &game_title,
+	 /* Commandline selfplay: game-title */
+	 N_("Game title to use"), NULL },
+	{ "file", 0, 0, G_OPTION_ARG_STRING, &game_file,
+	 /* Commandline selfplay: file */
+	 N_("Game file to use"), NULL },
+	{ "players", 'P', 0, G_OPTION_ARG_INT, &num_players,
+	 /* Commandline selfplay: players */
+	 N_("Override number of players"), NULL },
+	{ "points", 'v', 0, G_OPTION_ARG_INT, &num_points,
+	 /* Commandline selfplay: points */
+	 N_("Override number of points needed to win"), NULL },
+	{ "games", 'n', 0, G_OPTION_ARG_INT, &num_games,
+	 /* Commandline selfplay: games */
+	 N_("Play N games"), "N" },
+	{ "jobs", 'j', 0, G_OPTION_ARG_INT, &num_jobs,
+	 /* Commandline selfplay: jobs */
+	 N_("Play N games at the same time"), "N" },
+	{ "seed", 's', 0, G_OPTION_ARG_INT64, &base_seed,
+	 /* Commandline selfplay: seed */
+	 N_("Seed of the first game, the next games count up"), "N" },
+	{ "algorithm", 'a', 0, G_OPTION_ARG_STRING, &algorithm,
+	 /* Commandline selfplay: algorithm */
+	 N_("Type of computer player"), "greedy" },
+	{ "max-turns", 0, 0, G_OPTION_ARG_INT, &max_turns,
+	 /* Commandline selfplay: max-turns */
+	 N_("Abort a game after N turns, 0 for no limit"), "N" },
+	{ "verbose", 0, 0, G_OPTION_ARG_NONE, &verbose,
+	 /* Commandline selfplay: verbose */
+	 N_("Show the messages of the server and the players"), NULL },
+	{ "version", '\0', 0, G_OPTION_ARG_NONE, &show_version,
+	 /* Commandline option of selfplay: version */
+	 N_("Show version information"), NULL },
+	{ NULL, '\0', 0, 0, NULL, NULL, NULL }
+};
+
+static GameParams *params;
+static LocalGameResult *results;
+static gint next_game = 0;
+G_LOCK_DEFINE_STATIC(output);
+
+static gpointer job_thread(G_GNUC_UNUSED gpointer data)
+{
+	GMainContext *context;
+	gchar *args[] = { (gchar *) "-a", algorithm, NULL };
+	gchar **seat_args[MAX_PLAYERS];
+	gint idx;
+
+	for (idx = 0; idx < MAX_PLAYERS; idx++)
+		seat_args[idx] = algorithm != NULL ? args : NULL;
+
+	context = g_main_context_new();
+	g_main_context_push_thread_default(context);
+
+	while ((idx = g_atomic_int_add(&next_game, 1)) < num_games) {
+		LocalGameResult *result = &results[idx];
+
+		local_game_play(params, max_turns, seat_args, result);
+
+		G_LOCK(output);
+		if (result->winner >= 0)
+			g_print("Game %d: seed %" G_GUINT32_FORMAT
+				", player %d won after %d turns, "
+				"%.2f s, %.2f s CPU\n", idx,
+				result->seed, result->winner,
+				result->turns, result->wall_time,
+				result->cpu_time);
+		else
+			g_print("Game %d: seed %" G_GUINT32_FORMAT
+				", aborted after %d turns, "
+				"%.2f s, %.2f s CPU\n", idx,
+				result->seed, result->turns,
+				result->wall_time, result->cpu_time);
+		G_UNLOCK(output);
+	}
+
+	g_main_context_pop_thread_default(context);
+	g_main_context_unref(context);
+	return NULL;
+}
+
+int main(int argc, char *argv[])
+{
+	GOptionContext *context;
+	GError *error = NULL;
+	GThread **jobs;
+	gint wins[MAX_PLAYERS];
+	gint aborted = 0;
+	gint64 start;
+	gdouble wall_time;
+	gdouble cpu_time = 0.0;
+	guint32 seed;
+	gint idx;
+
+	/* set the UI driver to Glib_Driver, since we're using glib */
+	set_ui_driver(&Glib_Driver);
+	driver->player_added = srv_glib_player_added;
+	driver->player_renamed = srv_glib_player_renamed;
+	driver->player_removed = srv_player_removed;
+	driver->player_change = srv_player_change;
+
+#if !GLIB_CHECK_VERSION(2,36,0)
+	/* Starting with glib 2.36, this function does nothing */
+	g_type_init();
+#endif
+
+	server_init();
+
+	/* Initialize translations */
+	gettext_init();
+
+	/* Long description in the commandline for selfplay: help */
+	context = g_option_context_new(_("- Let computer players "
+					 "play games of Pioneers"));
+	g_option_context_add_main_entries(context, commandline_entries,
+					  PACKAGE);
+	g_option_context_parse(context, &argc, &argv, &error);
+	g_option_context_free(context);
+	if (error != NULL) {
+		g_print("%s\n", error->message);
+		g_error_free(error);
+		return 1;
+	}
+	if (show_version) {
+		g_print(_("Pioneers version:"));
+		g_print(" ");
+		g_print(FULL_VERSION);
+		g_print("\n");
+		return 0;
+	}
+	local_game_set_verbose(verbose);
+
+	if (game_title && game_file) {
+		/* selfplay commandline error */
+		g_print(_(""
+			  "Cannot set game title and filename at the same time\n"));
+		return 2;
+	}
+	if (game_file == NULL) {
+		if (game_title == NULL) {
+			if (num_players > 4)
+				params = cfg_set_game("5/6-player");
+			else
+				params = cfg_set_game("Default");
+		} else
+			params = cfg_set_game(game_title);
+	} else {
+		params = cfg_set_game_file(game_file);
+	}
+	if (params == NULL) {
+		/* selfplay commandline error */
+		g_print(_("Cannot load the parameters for the game\n"));
+		return 3;
+	}
+	if (num_players)
+		cfg_set_num_players(params, num_players);
+	if (num_points > 0)
+		cfg_set_victory_points(params, num_points);
+
+	num_games = MAX(num_games, 0);
+	num_jobs = CLAMP(num_jobs, 1, MAX(num_games, 1));
+	if (base_seed < 0)
+		seed = g_random_int();
+	else
+		seed = (guint32) base_seed;
+	results = g_new0(LocalGameResult, num_games);
+	for (idx = 0; idx < num_games; idx++)
+		results[idx].seed = seed + 1000u * (guint) idx;
+
+	net_init();
+	start = g_get_monotonic_time();
+	jobs = g_new(GThread *, num_jobs);
+	for (idx = 0; idx < num_jobs; idx++)
+		jobs[idx] = g_thread_new("job", job_thread, NULL);
+	for (idx = 0; idx < num_jobs; idx++)
+		g_thread_join(jobs[idx]);
+	g_free(jobs);
+	wall_time =
+	    (gdouble) (g_get_monotonic_time() - start) / G_USEC_PER_SEC;
+	net_finish();
+
+	memset(wins, 0, sizeof(wins));
+	for (idx = 0; idx < num_games; idx++) {
+		if (results[idx].winner >= 0
+		    && results[idx].winner < MAX_PLAYERS)
+			wins[results[idx].winner]++;
+		else
+			aborted++;
+		cpu_time += results[idx].cpu_time;
+	}
+	for (idx = 0; idx < (gint) params->num_players; idx++)
+		g_print(_("Player %d won %d games\n"), idx, wins[idx]);
+	g_print(_("%d games (%d aborted) in %.2f s, %.2f s CPU, "
+		  "%.1f games per minute\n"), num_games, aborted,
+		wall_time, cpu_time,
+		wall_time > 0.0 ? num_games * 60.0 / wall_time : 0.0);
+
+	g_free(results);
+	params_free(params);
+	return 0;
+}
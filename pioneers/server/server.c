@@ -27,10 +27,19 @@
 #include "avahi.h"
 #include "game-list.h"
 #include "random.h"
+#include "worker.h"
 
 #define TERRAIN_DEFAULT	0
 #define TERRAIN_RANDOM	1
 
+/** All games hosted by this process */
+static GList *game_registry = NULL;
+G_LOCK_DEFINE_STATIC(game_registry);
+/** Number of games that are running, in any thread */
+static gint num_running_games = 0;
+/** Starts computer players in this process, NULL to spawn pioneersai */
+static LocalComputerPlayerFunc local_computer_player = NULL;
+
 static gboolean timed_out(gpointer data)
 {
 	Game *game = data;
@@ -46,24 +55,37 @@ void start_timeout(Game * game)
 	if (!game->no_player_timeout)
 		return;
 	game->no_player_timer =
-	    g_timeout_add(game->no_player_timeout * 1000, timed_out, game);
+	    net_timeout_add(game->context, game->no_player_timeout * 1000,
+			    timed_out, game);
 }
 
 void stop_timeout(Game * game)
 {
 	if (game->no_player_timer != 0) {
-		g_source_remove(game->no_player_timer);
+		net_source_remove(game->context, game->no_player_timer);
 		game->no_player_timer = 0;
 	}
 }
 
-Game *game_new(const GameParams * params)
+/** Create a game that uses the given random number generator.
+ * @param params The parameters of the game
+ * @param rand_ctx The random number generator, owned by the game
+ * @param randomseed The seed of @p rand_ctx
+ */
+static Game *game_new_with_context(const GameParams * params,
+				   GRand * rand_ctx, guint32 randomseed)
 {
 	Game *game;
 	guint idx;
 
 	game = g_malloc0(sizeof(*game));
 
+	game->rand_ctx = rand_ctx;
+	log_message(MSG_INFO, "%s #%" G_GUINT32_FORMAT ".%s.%03u\n",
+		    /* Server: preparing game #..... */
+		    _("Preparing game"), randomseed, "G",
+		    random_guint_context(game->rand_ctx, 1000));
+
 	game->service = NULL;
 	game->is_running = FALSE;
 	game->is_game_over = FALSE;
@@ -75,28 +97,89 @@ Game *game_new(const GameParams * params)
 		game->bank_deck[idx] = game->params->resource_count;
 	develop_shuffle(game);
 	if (params->random_terrain)
-		map_shuffle_terrain(game->params->map);
-
+		map_shuffle_terrain(game->params->map, game->rand_ctx);
+	game->road_index = road_index_new(game->params->map);
+	game->production_index = production_index_new(game->params->map);
+	game->frontier_index = frontier_index_new(game->params->map,
+						  game->params->num_players);
+	game->port_index = port_index_new(game->params->map,
+					  game->params->num_players);
+
+	G_LOCK(game_registry);
+	game_registry = g_list_append(game_registry, game);
+	G_UNLOCK(game_registry);
 	return game;
 }
 
+Game *game_new(const GameParams * params)
+{
+	GRand *rand_ctx;
+	guint32 randomseed;
+
+	/* create new random seed, to be able to reproduce games */
+	rand_ctx = random_context_new(&randomseed);
+	return game_new_with_context(params, rand_ctx, randomseed);
+}
+
+Game *game_new_with_seed(const GameParams * params, guint32 seed)
+{
+	return game_new_with_context(params,
+				     random_context_new_with_seed(seed),
+				     seed);
+}
+
 void game_free(Game * game)
 {
 	if (game == NULL)
 		return;
 
 	server_stop(game);
+	G_LOCK(game_registry);
+	game_registry = g_list_remove(game_registry, game);
+	G_UNLOCK(game_registry);
 
 	g_assert(game->player_list_use_count == 0);
+	road_index_free(game->road_index);
+	production_index_free(game->production_index);
+	frontier_index_free(game->frontier_index);
+	port_index_free(game->port_index);
 	if (game->server_port != NULL)
 		g_free(game->server_port);
 	params_free(game->params);
 	net_service_free(game->service);
 	game->service = NULL;
 	g_free(game->develop_deck);
+	random_context_free(game->rand_ctx);
+	worker_pool_release(game->context);
 	g_free(game);
 }
 
+void server_set_local_computer_player(LocalComputerPlayerFunc func)
+{
+	local_computer_player = func;
+}
+
+/** Add a computer player that runs in a thread of this process.
+ * @param game The game
+ * @param argv The command line of the computer player
+ * @return 0 on success, -1 on failure
+ */
+static gint add_local_computer_player(Game * game, gchar ** argv)
+{
+	GMainContext *context;
+	Session *ses;
+
+	context = g_main_context_new();
+	ses = server_connect_local(game, context);
+	if (ses == NULL) {
+		g_main_context_unref(context);
+		return -1;
+	}
+	local_computer_player(ses, context, argv);
+	g_main_context_unref(context);
+	return 0;
+}
+
 gint add_computer_player(Game * game, gboolean want_chat)
 {
 	gchar *child_argv[10];
@@ -107,10 +190,12 @@ gint add_computer_player(Game * game, gboolean want_chat)
 
 	child_argv[n++] = g_strdup(PIONEERS_AI_PROGRAM_NAME);
 	child_argv[n++] = g_strdup(PIONEERS_AI_PROGRAM_NAME);
-	child_argv[n++] = g_strdup("-s");
-	child_argv[n++] = g_strdup(PIONEERS_DEFAULT_GAME_HOST);
-	child_argv[n++] = g_strdup("-p");
-	child_argv[n++] = g_strdup(game->server_port);
+	if (local_computer_player == NULL) {
+		child_argv[n++] = g_strdup("-s");
+		child_argv[n++] = g_strdup(PIONEERS_DEFAULT_GAME_HOST);
+		child_argv[n++] = g_strdup("-p");
+		child_argv[n++] = g_strdup(game->server_port);
+	}
 	child_argv[n++] = g_strdup("-n");
 	child_argv[n++] = player_new_computer_player(game);
 	if (!want_chat)
@@ -118,7 +203,10 @@ gint add_computer_player(Game * game, gboolean want_chat)
 	child_argv[n] = NULL;
 	g_assert(n < 10);
 
-	if (!g_spawn_async
+	if (local_computer_player != NULL)
+		/* The first element is the program to spawn */
+		ret = add_local_computer_player(game, child_argv + 1);
+	else if (!g_spawn_async
 	    (NULL, child_argv, NULL, G_SPAWN_SEARCH_PATH, NULL, NULL, NULL,
 	     &error)) {
 		log_message(MSG_ERROR, _("Error starting %s: %s\n"),
@@ -147,7 +235,11 @@ static void player_connect(Session * ses, NetEvent event,
 		break;
 	case NET_CONNECT:
 		/* new connection was made */
-		if (player_new_connection(game, ses) != NULL) {
+		if (!server_is_running(game)) {
+			/* The game was stopped after the connection was
+			 * accepted */
+			net_close(ses);
+		} else if (player_new_connection(game, ses) != NULL) {
 			stop_timeout(game);
 		} else {
 			net_close(ses);
@@ -160,11 +252,38 @@ static void player_connect(Session * ses, NetEvent event,
 	}
 }
 
+typedef struct {
+	Game *game;
+	gboolean register_server;
+	const gchar *metaserver_name;
+} GameStartArgs;
+
+/* Start the game in its own context */
+static gboolean game_server_run(gpointer data)
+{
+	GameStartArgs *args = data;
+	Game *game = args->game;
+
+	game->is_running = TRUE;
+	g_atomic_int_inc(&num_running_games);
+
+	start_timeout(game);
+
+	if (args->register_server) {
+		g_assert(args->metaserver_name != NULL);
+		meta_register(args->metaserver_name, game);
+	}
+	return FALSE;
+}
+
 static gboolean game_server_start(Game * game, gboolean register_server,
 				  const gchar * metaserver_name)
 {
 	gchar *error_message;
+	GameStartArgs args;
 
+	/* The connections are accepted in this thread, and handed off to
+	 * the worker of the game */
 	game->service =
 	    net_service_new(atoi(game->server_port), player_connect, game,
 			    &error_message);
@@ -174,14 +293,13 @@ static gboolean game_server_start(Game * game, gboolean register_server,
 		g_free(error_message);
 		return FALSE;
 	}
-	game->is_running = TRUE;
+	net_service_set_context(game->service, game->context);
 
-	start_timeout(game);
+	args.game = game;
+	args.register_server = register_server;
+	args.metaserver_name = metaserver_name;
+	worker_call(game->context, game_server_run, &args);
 
-	if (register_server) {
-		g_assert(metaserver_name != NULL);
-		meta_register(metaserver_name, game);
-	}
 	avahi_register_game(game);
 	return TRUE;
 }
@@ -200,7 +318,6 @@ Game *server_start(const GameParams * params, const gchar * hostname,
 		   const gchar * metaserver_name, gboolean random_order)
 {
 	Game *game;
-	guint32 randomseed;
 
 	g_return_val_if_fail(params != NULL, NULL);
 	g_return_val_if_fail(port != NULL, NULL);
@@ -215,13 +332,6 @@ Game *server_start(const GameParams * params, const gchar * hostname,
 	g_print("Quit when done: %d\n", params->quit_when_done);
 #endif
 
-	/* create new random seed, to be able to reproduce games */
-	randomseed = random_init();
-	log_message(MSG_INFO, "%s #%" G_GUINT32_FORMAT ".%s.%03u\n",
-		    /* Server: preparing game #..... */
-		    _("Preparing game"), randomseed, "G",
-		    random_guint(1000));
-
 	game = game_new(params);
 	g_assert(game->server_port == NULL);
 	game->server_port = g_strdup(port);
@@ -230,6 +340,7 @@ Game *server_start(const GameParams * params, const gchar * hostname,
 		game->hostname = g_strdup(hostname);
 	}
 	game->random_order = random_order;
+	game->context = worker_pool_assign();
 	if (!game_server_start(game, register_server, metaserver_name)) {
 		game_free(game);
 		game = NULL;
@@ -237,6 +348,49 @@ Game *server_start(const GameParams * params, const gchar * hostname,
 	return game;
 }
 
+/** Start a game that is only reachable from this process.
+ * No port is opened and the game is not registered anywhere.  The
+ * players are connected with server_connect_local().
+ * @param game A game from game_new()
+ */
+void server_start_local(Game * game)
+{
+	g_return_if_fail(!server_is_running(game));
+
+	if (game->context == NULL)
+		game->context = worker_pool_assign();
+	game->is_running = TRUE;
+	g_atomic_int_inc(&num_running_games);
+}
+
+/** Connect a player of this process to a local game.
+ * The server side of the connection is handled in the context of the
+ * game, like a connection that was accepted from the network.
+ * @param game A game started with server_start_local()
+ * @param client_context The context of the client, or NULL for the
+ *                       default context
+ * @return The session of the client, or NULL.  The notify function of
+ *         the session is not set yet.
+ */
+Session *server_connect_local(Game * game, GMainContext * client_context)
+{
+	Session *server_ses;
+	Session *client_ses;
+
+	g_return_val_if_fail(server_is_running(game), NULL);
+
+	server_ses = net_new(player_connect, game);
+	net_set_context(server_ses, game->context);
+	client_ses = net_new(NULL, NULL);
+	net_set_context(client_ses, client_context);
+	if (!net_connect_pair(server_ses, client_ses)) {
+		net_free(&server_ses);
+		net_free(&client_ses);
+		return NULL;
+	}
+	return client_ses;
+}
+
 /** Stop the server.
  * @param game A game
  * @return TRUE if the game changed from running to stopped
@@ -248,10 +402,11 @@ gboolean server_stop(Game * game)
 	if (!server_is_running(game))
 		return FALSE;
 
-	meta_unregister();
-	avahi_unregister_game();
+	meta_unregister(game);
+	avahi_unregister_game(game);
 
 	game->is_running = FALSE;
+	g_atomic_int_add(&num_running_games, -1);
 	net_service_free(game->service);
 	game->service = NULL;
 
@@ -278,6 +433,40 @@ gboolean server_is_running(Game * game)
 	return FALSE;
 }
 
+GList *server_list_games(void)
+{
+	GList *list;
+
+	G_LOCK(game_registry);
+	list = g_list_copy(game_registry);
+	G_UNLOCK(game_registry);
+	return list;
+}
+
+Game *server_find_game(const gchar * port)
+{
+	GList *list;
+	Game *found = NULL;
+
+	G_LOCK(game_registry);
+	for (list = game_registry; list != NULL; list = g_list_next(list)) {
+		Game *game = list->data;
+		if (game->server_port != NULL
+		    && !strcmp(game->server_port, port)) {
+			found = game;
+			break;
+		}
+	}
+	G_UNLOCK(game_registry);
+	return found;
+}
+
+gboolean server_any_running(void)
+{
+	/* The games can run in different threads */
+	return g_atomic_int_get(&num_running_games) > 0;
+}
+
 /* game configuration functions / callbacks */
 void cfg_set_num_players(GameParams * params, gint num_players)
 {
@@ -406,4 +595,7 @@ void server_init(void)
 	sa.sa_handler = SIG_IGN;
 	sigaction(SIGPIPE, &sa, NULL);
 #endif				/* G_OS_WIN32 */
+
+	set_check_longest_road(g_getenv("PIONEERS_CHECK_LONGEST_ROAD") !=
+			       NULL);
 }
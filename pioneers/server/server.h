@@ -33,6 +33,7 @@
 #define TERRAIN_RANDOM	1
 
 typedef struct Game Game;
+typedef struct MetaRegistration MetaRegistration;
 typedef struct {
 	StateMachine *sm;	/* state machine for this player */
 	Game *game;		/* game that player belongs to */
@@ -68,6 +69,7 @@ typedef struct {
 	gint market_played;	/* number of Market cards played */
 	guint islands_discovered;	/* number of islands discovered */
 	gboolean disconnected;
+	gboolean recover_from_plenty;	/* send "plenty" when the recovered player starts */
 } Player;
 
 struct Game {
@@ -75,10 +77,15 @@ struct Game {
 	gchar *hostname;	/* reported hostname */
 
 	Service *service;	/* network service */
+	MetaRegistration *meta;	/* registration at the metaserver */
+	GRand *rand_ctx;	/* random numbers for this game */
+	GMainContext *context;	/* context of the worker that runs the game, NULL for the default context */
 
 	GList *player_list;	/* all players in the game */
+	GList *seats[MAX_PLAYERS];	/* link in player_list of each player number, NULL == free */
 	GList *dead_players;	/* all players that should be removed when player_list_use_count == 0 */
 	gint player_list_use_count;	/* # functions is in use by */
+	Player no_player;	/* placeholder returned by player_none */
 	guint num_players;	/* current number of players in the game */
 
 	guint tournament_countdown;	/* number of remaining minutes before AIs are added */
@@ -90,7 +97,12 @@ struct Game {
 
 	gboolean is_game_over;	/* is the game over? */
 	Player *longest_road;	/* who holds longest road */
+	RoadIndex *road_index;	/* road networks, to find the longest road */
+	ProductionIndex *production_index;	/* buildings that produce, by roll */
+	FrontierIndex *frontier_index;	/* legal building locations */
+	PortIndex *port_index;	/* ports of each player */
 	Player *largest_army;	/* who has largest army */
+	Hex *previous_robber_hex;	/* where the robber/pirate was before it was moved */
 
 	QuoteList *quotes;	/* domestic trade quotes */
 	gint quote_supply[NO_RESOURCE];	/* only valid when trading */
@@ -114,6 +126,7 @@ struct Game {
 	gchar *server_port;	/* port to run game on */
 	gboolean random_order;	/* is turn order randomized? */
 	gboolean is_manipulated;	/* has the game been manipulated by the admin? */
+	gint fixed_dice_roll;	/* dice roll fixed by the admin, 0 when not fixed */
 
 	guint no_player_timeout;	/* time to wait for players */
 	guint no_player_timer;	/* glib timer identifier */
@@ -123,6 +136,10 @@ struct Game {
 
 /**** global variables ****/
 /* buildutil.c */
+/** Compare the longest road of the road index with a search of the whole
+ * map after every change.  A difference is logged as an error.
+ */
+void set_check_longest_road(gboolean enabled);
 void check_longest_road(Game * game);
 void node_add(Player * player,
 	      BuildType type, int x, int y, int pos, gboolean paid_for,
@@ -148,9 +165,9 @@ gboolean mode_discard_resources_place_robber(Player * player, gint event);
 /* meta.c */
 gchar *get_server_name(void);
 void meta_register(const gchar * server, Game * game);
-void meta_unregister(void);
-void meta_start_game(void);
-void meta_report_num_players(guint num_players);
+void meta_unregister(Game * game);
+void meta_start_game(Game * game);
+void meta_report_num_players(Game * game);
 
 /* player.c */
 typedef enum {
@@ -192,7 +209,7 @@ GList *next_player_loop(GList * current, Player * first);
 gboolean mode_spectator(Player * player, gint event);
 void playerlist_inc_use_count(Game * game);
 void playerlist_dec_use_count(Game * game);
-gboolean player_is_spectator(Game * game, gint player_num);
+gboolean player_num_is_spectator(Game * game, gint player_num);
 
 /* pregame.c */
 gboolean mode_pre_game(Player * player, gint event);
@@ -222,13 +239,48 @@ void robber_undo(Player * player);
 void start_timeout(Game * game);
 void stop_timeout(Game * game);
 Game *game_new(const GameParams * params);
+/** Create a game with a known seed, to be able to replay it.
+ * @param params The parameters of the game
+ * @param seed The seed of the random number generator of the game
+ * @return The new game
+ */
+Game *game_new_with_seed(const GameParams * params, guint32 seed);
 void game_free(Game * game);
 gint add_computer_player(Game * game, gboolean want_chat);
+/** Start a computer player in a thread of this process.
+ * @param ses The session of the player, connected to the game
+ * @param context The context for @p ses
+ * @param argv The command line of the player, like for pioneersai
+ */
+typedef void (*LocalComputerPlayerFunc) (Session * ses,
+					 GMainContext * context,
+					 gchar ** argv);
+/** Let add_computer_player() run the computer players in this process.
+ * @param func The function that starts a player, NULL to spawn
+ *             a pioneersai process for each player
+ */
+void server_set_local_computer_player(LocalComputerPlayerFunc func);
 Game *server_start(const GameParams * params, const gchar * hostname,
 		   const gchar * port, gboolean register_server,
 		   const gchar * metaserver_name, gboolean random_order);
+void server_start_local(Game * game);
+Session *server_connect_local(Game * game, GMainContext * client_context);
 gboolean server_stop(Game * game);
 gboolean server_is_running(Game * game);
+/** All games that are hosted by this process.
+ * @return A copy of the list of Game *, free it with g_list_free.
+ *         The games are owned by the server
+ */
+GList *server_list_games(void);
+/** Find a hosted game.
+ * @param port The port of the game
+ * @return The game, or NULL if no game is hosted on that port
+ */
+Game *server_find_game(const gchar * port);
+/** Check whether any of the hosted games is running.
+ * @return TRUE if at least one game is running
+ */
+gboolean server_any_running(void);
 gint accept_connection(gint in_fd, gchar ** location);
 
 /**** callbacks to set parameters ****/
@@ -267,6 +319,7 @@ void trade_begin_domestic(Player * player, gint * supply, gint * receive);
 gboolean mode_idle(Player * player, gint event);
 gboolean mode_turn(Player * player, gint event);
 void turn_next_player(Game * game);
+gint player_victory_points(Player * player);
 /** Check whether this player has won the game.
  *  If so, return TRUE and set all state machines to idle
  *  @param player Has this player won?
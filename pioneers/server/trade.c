@@ -28,7 +28,6 @@ void trade_perform_maritime(Player * player,
 			    gint ratio, Resource supply, Resource receive)
 {
 	Game *game = player->game;
-	const Map *map = game->params->map;
 	gint check[NO_RESOURCE];
 	MaritimeInfo info;
 
@@ -48,7 +47,7 @@ void trade_perform_maritime(Player * player,
 
 	/* Now check that the trade can actually be performed.
 	 */
-	map_maritime_info(map, &info, player->num);
+	port_index_maritime_info(game->port_index, &info, player->num);
 	switch (ratio) {
 	case 4:
 		if (player->assets[supply] < 4) {
@@ -200,7 +199,7 @@ void trade_finish_domestic(Player * player)
 	     list != NULL; list = player_next_real(list)) {
 		Player *scan = list->data;
 		if (scan != player
-		    && !player_is_spectator(game, scan->num))
+		    && !player_num_is_spectator(game, scan->num))
 			sm_pop(scan->sm);
 	}
 	quotelist_free(&game->quotes);
@@ -300,7 +299,7 @@ static void process_call_domestic(Player * player, gint * supply,
 	for (list = player_first_real(game); list != NULL;
 	     list = player_next_real(list)) {
 		Player *scan = list->data;
-		if (!player_is_spectator(game, scan->num)
+		if (!player_num_is_spectator(game, scan->num)
 		    && scan != player) {
 			sm_goto(scan->sm, (StateFunc) mode_domestic_quote);
 		}
@@ -427,7 +426,7 @@ void trade_begin_domestic(Player * player, gint * supply, gint * receive)
 	for (list = player_first_real(game); list != NULL;
 	     list = player_next_real(list)) {
 		Player *scan = list->data;
-		if (!player_is_spectator(game, scan->num)
+		if (!player_num_is_spectator(game, scan->num)
 		    && scan != player)
 			sm_push(scan->sm, (StateFunc) mode_domestic_quote);
 	}
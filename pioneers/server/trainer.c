@@ -0,0 +1,656 @@
+/* Pioneers - Implementation of the excellent Settlers of Catan board game.
+ *   Go buy a copy.
+ *
+ * Copyright (C) 2026 The Pioneers developers
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+/* Pioneers Genetic Trainer
+ *
+ * Evolves the chromosome of the genetic computer player.  Every
+ * generation, each chromosome plays a number of games against the
+ * others.  The games are played in parallel with the self-play engine.
+ * The fittest chromosomes are selected by tournament, and the next
+ * generation is bred by crossover and mutation.
+ */
+#include "config.h"
+#include "version.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <glib.h>
+#include <glib-object.h>
+
+#include "driver.h"
+#include "game.h"
+#include "network.h"
+#include "server.h"
+
+#include "common_glib.h"
+#include "glib-driver.h"
+#include "gettext.h"
+#include "localgame.h"
+#include "genetic_core.h"
+
+/** Number of genes in a chromosome */
+#define NUM_GENES (10 * 8 + 3)
+
+static gint num_players = 0;
+static gint num_points = 0;
+static gint population_size = 16;
+static gint num_generations = 20;
+static gint num_rounds = 4;
+static gint num_jobs = 0;
+static gint tournament_size = 3;
+static gint num_elite = 2;
+static gdouble mutation_rate = 0.1;
+static gint64 base_seed = -1;
+static gint max_turns = 1000;
+static gchar *game_title = NULL;
+static gchar *game_file = NULL;
+static gchar *directory = NULL;
+static gchar *resume_file = NULL;
+static gchar *output_file = NULL;
+static gboolean verbose = FALSE;
+static gboolean show_version = FALSE;
+
+static GOptionEntry commandline_entries[] = {
+	{ "game-title", 'g', 0, G_OPTION_ARG_STRING, &game_title,
+	 /* Commandline trainer: game-title */
+	 N_("Game title to use"), NULL },
+	{ "file", 0, 0, G_OPTION_ARG_STRING, &game_file,
+	 /* Commandline trainer: file */
+	 N_("Game file to use"), NULL },
+	{ "players", 'P', 0, G_OPTION_ARG_INT, &num_players,
+	 /* Commandline trainer: players */
+	 N_("Override number of players"), NULL },
+	{ "points", 'v', 0, G_OPTION_ARG_INT, &num_points,
+	 /* Commandline trainer: points */
+	 N_("Override number of points needed to win"), NULL },
+	{ "population", 'p', 0, G_OPTION_ARG_INT, &population_size,
+	 /* Commandline trainer: population */
+	 N_("Number of chromosomes in a generation"), "N" },
+	{ "generations", 'G', 0, G_OPTION_ARG_INT, &num_generations,
+	 /* Commandline trainer: generations */
+	 N_("Number of generations"), "N" },
+	{ "rounds", 'r', 0, G_OPTION_ARG_INT, &num_rounds,
+	 /* Commandline trainer: rounds */
+	 N_("Number of games of each chromosome per generation"), "N" },
+	{ "jobs", 'j', 0, G_OPTION_ARG_INT, &num_jobs,
+	 /* Commandline trainer: jobs */
+	 N_("Play N games at the same time, default one per processor"),
+	 "N" },
+	{ "tournament", 't', 0, G_OPTION_ARG_INT, &tournament_size,
+	 /* Commandline trainer: tournament */
+	 N_("Number of chromosomes that compete to become a parent"), "N" },
+	{ "elite", 'e', 0, G_OPTION_ARG_INT, &num_elite,
+	 /* Commandline trainer: elite */
+	 N_("Copy the N best chromosomes to the next generation"), "N" },
+	{ "mutation", 'm', 0, G_OPTION_ARG_DOUBLE, &mutation_rate,
+	 /* Commandline trainer: mutation */
+	 N_("Chance that a gene mutates"), "0.1" },
+	{ "seed", 's', 0, G_OPTION_ARG_INT64, &base_seed,
+	 /* Commandline trainer: seed */
+	 N_("Seed of the trainer"), "N" },
+	{ "max-turns", 0, 0, G_OPTION_ARG_INT, &max_turns,
+	 /* Commandline trainer: max-turns */
+	 N_("Abort a game after N turns, 0 for no limit"), "N" },
+	{ "directory", 'd', 0, G_OPTION_ARG_FILENAME, &directory,
+	 /* Commandline trainer: directory */
+	 N_("Directory for the chromosomes and the checkpoints"),
+	 "training" },
+	{ "resume", 0, 0, G_OPTION_ARG_FILENAME, &resume_file,
+	 /* Commandline trainer: resume */
+	 N_("Continue with the population of a checkpoint"), NULL },
+	{ "output", 'o', 0, G_OPTION_ARG_FILENAME, &output_file,
+	 /* Commandline trainer: output */
+	 N_("Write the best chromosome to this file"), NULL },
+	{ "verbose", 0, 0, G_OPTION_ARG_NONE, &verbose,
+	 /* Commandline trainer: verbose */
+	 N_("Show the messages of the server and the players"), NULL },
+	{ "version", '\0', 0, G_OPTION_ARG_NONE, &show_version,
+	 /* Commandline option of trainer: version */
+	 N_("Show version information"), NULL },
+	{ NULL, '\0', 0, 0, NULL, NULL, NULL }
+};
+
+typedef struct {
+	struct chromosome_t chromosome;
+	gchar *filename;	/**< The chromosome, for the players */
+	gdouble score;		/**< Sum of the scores of the games */
+	gint games;		/**< Number of games played */
+} Individual;
+
+/** A game of a generation */
+typedef struct {
+	LocalGameResult result;
+	gint seats[MAX_PLAYERS];	/**< Individual in each seat */
+} TrainingGame;
+
+static GameParams *params;
+static Individual *population;
+static TrainingGame *games;
+static gint num_games;
+static gint next_game;
+static GRand *trainer_rand;
+
+/** Access a gene of a chromosome.
+ * @param chromosome The chromosome
+ * @param idx The number of the gene, less than NUM_GENES
+ * @return The gene
+ */
+static float *gene(struct chromosome_t *chromosome, gint idx)
+{
+	if (idx < 80)
+		return &chromosome->resourcesValueMatrix[idx / 8][idx % 8];
+	switch (idx) {
+	case 80:
+		return &chromosome->depreciation_constant;
+	case 81:
+		return &chromosome->turn;
+	default:
+		return &chromosome->probability;
+	}
+}
+
+/** The value of a gene of a chromosome */
+static float gene_value(const struct chromosome_t *chromosome, gint idx)
+{
+	if (idx < 80)
+		return chromosome->resourcesValueMatrix[idx / 8][idx % 8];
+	switch (idx) {
+	case 80:
+		return chromosome->depreciation_constant;
+	case 81:
+		return chromosome->turn;
+	default:
+		return chromosome->probability;
+	}
+}
+
+/** Keep a gene within the limits that the genetic player expects */
+static float clamp_gene(gint idx, gdouble value)
+{
+	if (idx < 80)
+		return (float) CLAMP(value, 0.0, 20.0);
+	switch (idx) {
+	case 80:
+		return (float) CLAMP(value, 0.0, 10.0);
+	case 81:
+		return (float) CLAMP(value, 0.0, 24.0);
+	default:
+		return (float) CLAMP(value, 0.01, 0.99);
+	}
+}
+
+/** A normally distributed random number, with the Box-Muller method */
+static gdouble random_gaussian(void)
+{
+	gdouble u1, u2;
+
+	u1 = g_rand_double_range(trainer_rand, 1e-12, 1.0);
+	u2 = g_rand_double(trainer_rand);
+	return sqrt(-2.0 * log(u1)) * cos(2.0 * G_PI * u2);
+}
+
+static void mutate(struct chromosome_t *chromosome, gdouble rate)
+{
+	gint idx;
+
+	for (idx = 0; idx < NUM_GENES; idx++) {
+		float *value = gene(chromosome, idx);
+		gdouble sigma;
+
+		if (g_rand_double(trainer_rand) >= rate)
+			continue;
+		/* The step is relative to the size of the gene */
+		sigma = 0.2 * MAX(fabs(*value), 0.1);
+		*value = clamp_gene(idx, *value + sigma * random_gaussian());
+	}
+}
+
+static void crossover(const struct chromosome_t *a,
+		      const struct chromosome_t *b,
+		      struct chromosome_t *child)
+{
+	gint idx;
+
+	for (idx = 0; idx < NUM_GENES; idx++) {
+		if (g_rand_boolean(trainer_rand))
+			*gene(child, idx) = gene_value(a, idx);
+		else
+			*gene(child, idx) = gene_value(b, idx);
+	}
+}
+
+static gdouble fitness(const Individual * individual)
+{
+	if (individual->games == 0)
+		return 0.0;
+	return individual->score / individual->games;
+}
+
+/** Select a parent, the fittest of a few random individuals */
+static const Individual *tournament(void)
+{
+	const Individual *best = NULL;
+	gint idx;
+
+	for (idx = 0; idx < MAX(tournament_size, 1); idx++) {
+		const Individual *candidate =
+		    &population[g_rand_int_range(trainer_rand, 0,
+						 population_size)];
+		if (best == NULL || fitness(candidate) > fitness(best))
+			best = candidate;
+	}
+	return best;
+}
+
+static gint compare_fitness(gconstpointer a, gconstpointer b)
+{
+	gdouble fa = fitness(a);
+	gdouble fb = fitness(b);
+
+	if (fa > fb)
+		return -1;
+	if (fa < fb)
+		return 1;
+	return 0;
+}
+
+static gboolean write_chromosome(const gchar * filename,
+				 const struct chromosome_t *chromosome)
+{
+	FILE *stream;
+
+	stream = fopen(filename, "w");
+	if (stream == NULL) {
+		g_printerr(_("Cannot write %s\n"), filename);
+		return FALSE;
+	}
+	chromosome_write(stream, chromosome);
+	fclose(stream);
+	return TRUE;
+}
+
+/** Write the population that is evaluated in a generation.
+ * The first line names the generation, then the chromosomes follow in
+ * the format of the chromosome files.
+ */
+static void write_checkpoint(gint generation)
+{
+	gchar *filename;
+	gchar *basename;
+	FILE *stream;
+	gint idx;
+
+	basename = g_strdup_printf("generation-%03d.population", generation);
+	filename = g_build_filename(directory, basename, NULL);
+	g_free(basename);
+	stream = fopen(filename, "w");
+	if (stream == NULL) {
+		g_printerr(_("Cannot write %s\n"), filename);
+		g_free(filename);
+		return;
+	}
+	fprintf(stream, "generation %d\n", generation);
+	for (idx = 0; idx < population_size; idx++)
+		chromosome_write(stream, &population[idx].chromosome);
+	fclose(stream);
+	g_free(filename);
+}
+
+/** Read a checkpoint of write_checkpoint.
+ * When the checkpoint holds fewer chromosomes than the population, the
+ * population is filled with mutations of them.
+ * @return The generation of the checkpoint, or -1 on error
+ */
+static gint read_checkpoint(const gchar * filename)
+{
+	FILE *stream;
+	char line[80];
+	gint generation;
+	gint count = 0;
+	gint idx;
+
+	stream = fopen(filename, "r");
+	if (stream == NULL)
+		return -1;
+	if (fgets(line, sizeof(line), stream) == NULL
+	    || sscanf(line, "generation %d", &generation) != 1) {
+		fclose(stream);
+		return -1;
+	}
+	while (count < population_size
+	       && chromosome_read(stream, &population[count].chromosome))
+		count++;
+	fclose(stream);
+	if (count == 0)
+		return -1;
+	for (idx = count; idx < population_size; idx++) {
+		population[idx].chromosome =
+		    population[idx % count].chromosome;
+		mutate(&population[idx].chromosome, 1.0);
+	}
+	return generation;
+}
+
+static gpointer job_thread(G_GNUC_UNUSED gpointer data)
+{
+	GMainContext *context;
+	gchar *args[MAX_PLAYERS][5];
+	gchar **seat_args[MAX_PLAYERS];
+	gint idx;
+
+	context = g_main_context_new();
+	g_main_context_push_thread_default(context);
+
+	while ((idx = g_atomic_int_add(&next_game, 1)) < num_games) {
+		TrainingGame *game = &games[idx];
+		gint seat;
+
+		for (seat = 0; seat < MAX_PLAYERS; seat++) {
+			args[seat][0] = (gchar *) "-a";
+			args[seat][1] = (gchar *) "genetic";
+			args[seat][2] = (gchar *) "--chromosome-file";
+			args[seat][3] =
+			    population[game->seats[seat]].filename;
+			args[seat][4] = NULL;
+			seat_args[seat] = args[seat];
+		}
+		local_game_play(params, max_turns, seat_args,
+				&game->result);
+	}
+
+	g_main_context_pop_thread_default(context);
+	g_main_context_unref(context);
+	return NULL;
+}
+
+/** Play the games of one generation, and score the individuals */
+static void evaluate_generation(void)
+{
+	GThread **jobs;
+	gint *order;
+	gint seats;
+	gint round;
+	gint idx;
+	gint jobs_count;
+
+	seats = (gint) params->num_players;
+	for (idx = 0; idx < population_size; idx++) {
+		population[idx].score = 0.0;
+		population[idx].games = 0;
+		write_chromosome(population[idx].filename,
+				 &population[idx].chromosome);
+	}
+
+	/* In each round every individual plays at least one game, against
+	 * randomly chosen opponents */
+	num_games = num_rounds * ((population_size + seats - 1) / seats);
+	games = g_new0(TrainingGame, num_games);
+	order = g_new(gint, population_size);
+	for (round = 0; round < num_rounds; round++) {
+		for (idx = 0; idx < population_size; idx++)
+			order[idx] = idx;
+		for (idx = population_size - 1; idx > 0; idx--) {
+			gint other = g_rand_int_range(trainer_rand, 0, idx + 1);
+			gint swap = order[idx];
+			order[idx] = order[other];
+			order[other] = swap;
+		}
+		for (idx = 0; idx < (population_size + seats - 1) / seats;
+		     idx++) {
+			TrainingGame *game =
+			    &games[round *
+				   ((population_size + seats - 1) / seats) +
+				   idx];
+			gint seat;
+
+			game->result.seed = g_rand_int(trainer_rand);
+			for (seat = 0; seat < seats; seat++) {
+				gint pos = idx * seats + seat;
+				if (pos < population_size)
+					game->seats[seat] = order[pos];
+				else
+					game->seats[seat] =
+					    g_rand_int_range(trainer_rand, 0,
+							     population_size);
+			}
+		}
+	}
+	g_free(order);
+
+	next_game = 0;
+	jobs_count = CLAMP(num_jobs, 1, num_games);
+	jobs = g_new(GThread *, jobs_count);
+	for (idx = 0; idx < jobs_count; idx++)
+		jobs[idx] = g_thread_new("job", job_thread, NULL);
+	for (idx = 0; idx < jobs_count; idx++)
+		g_thread_join(jobs[idx]);
+	g_free(jobs);
+
+	/* Score: the share of the victory points that were reached, and
+	 * one more for a win */
+	for (idx = 0; idx < num_games; idx++) {
+		gint seat;
+
+		for (seat = 0; seat < seats; seat++) {
+			Individual *individual =
+			    &population[games[idx].seats[seat]];
+			individual->score +=
+			    (gdouble) games[idx].result.points[seat] /
+			    params->victory_points;
+			if (games[idx].result.winner == seat)
+				individual->score += 1.0;
+			individual->games++;
+		}
+	}
+}
+
+/** Replace the population by the next generation */
+static void breed_generation(void)
+{
+	Individual *next;
+	gint idx;
+
+	next = g_new0(Individual, population_size);
+	for (idx = 0; idx < population_size; idx++) {
+		next[idx].filename = population[idx].filename;
+		if (idx < num_elite) {
+			/* The population is sorted */
+			next[idx].chromosome = population[idx].chromosome;
+		} else {
+			crossover(&tournament()->chromosome,
+				  &tournament()->chromosome,
+				  &next[idx].chromosome);
+			mutate(&next[idx].chromosome, mutation_rate);
+		}
+	}
+	g_free(population);
+	population = next;
+}
+
+int main(int argc, char *argv[])
+{
+	GOptionContext *context;
+	GError *error = NULL;
+	gint generation = 0;
+	gint last_generation;
+	guint32 seed;
+	gint idx;
+
+	/* set the UI driver to Glib_Driver, since we're using glib */
+	set_ui_driver(&Glib_Driver);
+	driver->player_added = srv_glib_player_added;
+	driver->player_renamed = srv_glib_player_renamed;
+	driver->player_removed = srv_player_removed;
+	driver->player_change = srv_player_change;
+
+#if !GLIB_CHECK_VERSION(2,36,0)
+	/* Starting with glib 2.36, this function does nothing */
+	g_type_init();
+#endif
+
+	server_init();
+
+	/* Initialize translations */
+	gettext_init();
+
+	/* Long description in the commandline for trainer: help */
+	context = g_option_context_new(_("- Train the genetic computer "
+					 "player of Pioneers"));
+	g_option_context_add_main_entries(context, commandline_entries,
+					  PACKAGE);
+	g_option_context_parse(context, &argc, &argv, &error);
+	g_option_context_free(context);
+	if (error != NULL) {
+		g_print("%s\n", error->message);
+		g_error_free(error);
+		return 1;
+	}
+	if (show_version) {
+		g_print(_("Pioneers version:"));
+		g_print(" ");
+		g_print(FULL_VERSION);
+		g_print("\n");
+		return 0;
+	}
+	local_game_set_verbose(verbose);
+
+	if (game_title && game_file) {
+		/* trainer commandline error */
+		g_print(_(""
+			  "Cannot set game title and filename at the same time\n"));
+		return 2;
+	}
+	if (game_file == NULL) {
+		if (game_title == NULL) {
+			if (num_players > 4)
+				params = cfg_set_game("5/6-player");
+			else
+				params = cfg_set_game("Default");
+		} else
+			params = cfg_set_game(game_title);
+	} else {
+		params = cfg_set_game_file(game_file);
+	}
+	if (params == NULL) {
+		/* trainer commandline error */
+		g_print(_("Cannot load the parameters for the game\n"));
+		return 3;
+	}
+	if (num_players)
+		cfg_set_num_players(params, num_players);
+	if (num_points > 0)
+		cfg_set_victory_points(params, num_points);
+
+	if (num_jobs <= 0) {
+#if GLIB_CHECK_VERSION(2,36,0)
+		num_jobs = (gint) g_get_num_processors();
+#else
+		num_jobs = 1;
+#endif
+	}
+	population_size = MAX(population_size, 2);
+	num_rounds = MAX(num_rounds, 1);
+	num_elite = CLAMP(num_elite, 0, population_size);
+	if (directory == NULL)
+		directory = g_strdup("training");
+	if (g_mkdir_with_parents(directory, 0755) != 0) {
+		g_printerr(_("Cannot create the directory %s\n"), directory);
+		return 4;
+	}
+	if (output_file == NULL)
+		output_file = g_build_filename(directory, "best.chromosome",
+					       NULL);
+
+	if (base_seed < 0)
+		seed = g_random_int();
+	else
+		seed = (guint32) base_seed;
+	trainer_rand = g_rand_new_with_seed(seed);
+	g_print(_("Training with seed %u, %d jobs\n"), (guint) seed,
+		num_jobs);
+
+	population = g_new0(Individual, population_size);
+	if (resume_file != NULL) {
+		generation = read_checkpoint(resume_file);
+		if (generation < 0) {
+			g_printerr(_("Cannot read the checkpoint %s\n"),
+				   resume_file);
+			return 5;
+		}
+	} else {
+		/* Start with variations of the default chromosome */
+		for (idx = 0; idx < population_size; idx++) {
+			population[idx].chromosome = default_chromosome;
+			if (idx > 0)
+				mutate(&population[idx].chromosome, 1.0);
+		}
+	}
+	for (idx = 0; idx < population_size; idx++) {
+		gchar *basename;
+
+		basename =
+		    g_strdup_printf("individual-%03d.chromosome", idx);
+		population[idx].filename =
+		    g_build_filename(directory, basename, NULL);
+		g_free(basename);
+	}
+
+	net_init();
+	last_generation = generation + MAX(num_generations, 1) - 1;
+	for (; generation <= last_generation; generation++) {
+		gint64 start;
+		gdouble wall_time;
+		gdouble mean = 0.0;
+
+		write_checkpoint(generation);
+		start = g_get_monotonic_time();
+		evaluate_generation();
+		wall_time = (gdouble) (g_get_monotonic_time() - start)
+		    / G_USEC_PER_SEC;
+
+		qsort(population, (gsize) population_size,
+		      sizeof(*population), compare_fitness);
+		for (idx = 0; idx < population_size; idx++)
+			mean += fitness(&population[idx]);
+		mean /= population_size;
+		g_print(_("Generation %d: best %.3f, mean %.3f, "
+			  "%d games in %.1f s, %.1f games per minute\n"),
+			generation, fitness(&population[0]), mean, num_games,
+			wall_time,
+			wall_time > 0.0 ? num_games * 60.0 / wall_time : 0.0);
+		write_chromosome(output_file, &population[0].chromosome);
+
+		g_free(games);
+		games = NULL;
+		if (generation < last_generation)
+			breed_generation();
+	}
+	net_finish();
+	g_print(_("The best chromosome is written to %s\n"), output_file);
+
+	for (idx = 0; idx < population_size; idx++)
+		g_free(population[idx].filename);
+	g_free(population);
+	g_rand_free(trainer_rand);
+	params_free(params);
+	return 0;
+}
@@ -25,7 +25,6 @@
 #include "buildrec.h"
 #include "cost.h"
 #include "server.h"
-#include "admin.h"
 #include "random.h"
 
 static void build_add(Player * player, BuildType type, gint x, gint y,
@@ -314,12 +313,16 @@ static void build_move(Player * player, gint sx, gint sy, gint spos,
 	/* Move it away */
 	from->owner = -1;
 	from->type = BUILD_NONE;
+	road_index_edge_changed(game->road_index, from);
+	frontier_index_edge_changed(game->frontier_index, from);
 
 	/* Check if it is allowed to move to the other place */
 	if ((sx == dx && sy == dy && spos == dpos)
 	    || !can_ship_be_built(to, player->num)) {
 		from->owner = player->num;
 		from->type = BUILD_SHIP;
+		road_index_edge_changed(game->road_index, from);
+		frontier_index_edge_changed(game->frontier_index, from);
 		player_send(player, FIRST_VERSION, LATEST_VERSION,
 			    "ERR bad-pos\n");
 		return;
@@ -347,39 +350,33 @@ static void build_move(Player * player, gint sx, gint sy, gint spos,
 	/* administrate the arrival of the ship */
 	to->owner = player->num;
 	to->type = BUILD_SHIP;
+	road_index_edge_changed(game->road_index, to);
+	frontier_index_edge_changed(game->frontier_index, to);
 
 	/* check the longest road again */
 	check_longest_road(game);
 }
 
-typedef struct {
-	Game *game;
-	int roll;
-} GameRoll;
-
-static gboolean distribute_resources(const Hex * hex, gpointer closure)
+static void distribute_resources(Game * game, gint roll)
 {
+	const Production *entries;
+	guint num_entries;
 	guint idx;
-	GameRoll *data = closure;
-
-	if (hex->roll != data->roll || hex->robber)
-		/* return false so the traverse function continues */
-		return FALSE;
 
-	for (idx = 0; idx < G_N_ELEMENTS(hex->nodes); idx++) {
-		const Node *node = hex->nodes[idx];
+	entries =
+	    production_index_lookup(game->production_index, roll,
+				    &num_entries);
+	for (idx = 0; idx < num_entries; idx++) {
+		const Production *entry = &entries[idx];
 		Player *player;
-		gint num;
 
-		if (node->type == BUILD_NONE)
-			continue;
-		player = player_by_num(data->game, node->owner);
+		player = player_by_num(game, entry->owner);
 		if (player != NULL) {
-			num = (node->type == BUILD_CITY) ? 2 : 1;
-			if (hex->terrain == GOLD_TERRAIN)
-				player->gold += num;
+			if (entry->hex->terrain == GOLD_TERRAIN)
+				player->gold += entry->amount;
 			else
-				player->assets[hex->terrain] += num;
+				player->assets[entry->hex->terrain] +=
+				    entry->amount;
 		} else {
 			/* This should be fixed at some point. */
 			log_message(MSG_ERROR,
@@ -387,20 +384,17 @@ static gboolean distribute_resources(const Hex * hex, gpointer closure)
 				      "Tried to assign resources to NULL player.\n"));
 		}
 	}
-
-	/* return false so the traverse function continues */
-	return FALSE;
 }
 
-gboolean check_victory(Player * player)
+/** The number of victory points of a player.
+ * @param player The player
+ * @return The points, can be negative due to island bonuses
+ */
+gint player_victory_points(Player * player)
 {
 	Game *game = player->game;
 	GList *list;
-	gint points;		/* can be negative, due to island bonuses */
-
-	if (player->num != game->curr_player)
-		/* Only the player that has the turn can win */
-		return FALSE;
+	gint points;
 
 	points = player->num_settlements
 	    + player->num_cities * 2 + player->develop_points;
@@ -416,7 +410,20 @@ gboolean check_victory(Player * player)
 		points += point->points;
 		list = g_list_next(list);
 	}
+	return points;
+}
+
+gboolean check_victory(Player * player)
+{
+	Game *game = player->game;
+	GList *list;
+	gint points;		/* can be negative, due to island bonuses */
+
+	if (player->num != game->curr_player)
+		/* Only the player that has the turn can win */
+		return FALSE;
 
+	points = player_victory_points(player);
 	if (points >= (gint) game->params->victory_points) {
 		player_broadcast(player, PB_ALL, FIRST_VERSION,
 				 LATEST_VERSION, "won with %d\n", points);
@@ -429,7 +436,7 @@ gboolean check_victory(Player * player)
 			sm_pop_all_and_goto(scan->sm,
 					    (StateFunc) mode_idle);
 		}
-		meta_unregister();
+		meta_unregister(game);
 
 		game_is_over(game);
 		return TRUE;
@@ -443,8 +450,6 @@ gboolean check_victory(Player * player)
 static void roll_dice(Player * player)
 {
 	Game *game = player->game;
-	const Map *map = game->params->map;
-	GameRoll data;
 	gint roll;
 
 	if (game->rolled_dice) {
@@ -453,7 +458,7 @@ static void roll_dice(Player * player)
 		return;
 	}
 
-	roll = admin_get_dice_roll();
+	roll = game->fixed_dice_roll;
 	if (roll == 0) {
 		/* roll the dice until we like it */
 		while (TRUE) {
@@ -478,7 +483,9 @@ static void roll_dice(Player * player)
 							 LATEST_VERSION,
 							 "shuffled-dice-deck\n");
 				}
-				card = random_guint(game->num_dice_cards);
+				card =
+				    random_guint_context(game->rand_ctx,
+							 game->num_dice_cards);
 
 				i = -1;
 				while (card >= 0) {
@@ -491,8 +498,12 @@ static void roll_dice(Player * player)
 				game->die2 = i / 6 + 1;
 			} else {
 				/* two dice */
-				game->die1 = random_guint(6) + 1;
-				game->die2 = random_guint(6) + 1;
+				game->die1 =
+				    random_guint_context(game->rand_ctx,
+							 6) + 1;
+				game->die2 =
+				    random_guint_context(game->rand_ctx,
+							 6) + 1;
 			}
 			roll = game->die1 + game->die2;
 			/* sevens_rule == 1: reroll first two turns */
@@ -533,9 +544,7 @@ static void roll_dice(Player * player)
 		return;
 	}
 	resource_start(game);
-	data.game = game;
-	data.roll = roll;
-	map_traverse_const(map, distribute_resources, &data);
+	distribute_resources(game, roll);
 	/* distribute resources and gold (includes resource_end) */
 	distribute_first(list_from_player(player));
 	return;
@@ -0,0 +1,170 @@
+/* Pioneers - Implementation of the excellent Settlers of Catan board game.
+ *   Go buy a copy.
+ *
+ * Copyright (C) 2026 The Pioneers developers
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include "config.h"
+#include "worker.h"
+
+typedef struct {
+	GThread *thread;
+	GMainContext *context;
+	GMainLoop *loop;
+	guint num_games; /**< Number of games pinned to this worker */
+} Worker;
+
+/* A function call that is waiting for another thread */
+typedef struct {
+	GSourceFunc func;
+	gpointer data;
+	gboolean done;
+	GMutex mutex;
+	GCond cond;
+} WorkerCall;
+
+static Worker *workers = NULL;
+static guint num_workers = 0;
+G_LOCK_DEFINE_STATIC(workers);
+
+static gpointer worker_thread(gpointer data)
+{
+	Worker *worker = data;
+
+	g_main_context_push_thread_default(worker->context);
+	g_main_loop_run(worker->loop);
+	g_main_context_pop_thread_default(worker->context);
+	return NULL;
+}
+
+void worker_pool_start(guint count)
+{
+	guint idx;
+
+	g_return_if_fail(workers == NULL);
+
+	if (count == 0)
+		return;
+
+	workers = g_new0(Worker, count);
+	num_workers = count;
+	for (idx = 0; idx < count; idx++) {
+		gchar *name;
+
+		workers[idx].context = g_main_context_new();
+		workers[idx].loop =
+		    g_main_loop_new(workers[idx].context, FALSE);
+		name = g_strdup_printf("worker %u", idx);
+		workers[idx].thread =
+		    g_thread_new(name, worker_thread, &workers[idx]);
+		g_free(name);
+	}
+}
+
+void worker_pool_stop(void)
+{
+	guint idx;
+
+	for (idx = 0; idx < num_workers; idx++) {
+		g_main_loop_quit(workers[idx].loop);
+		g_thread_join(workers[idx].thread);
+		g_main_loop_unref(workers[idx].loop);
+		/* The games still hold a reference to the context */
+		g_main_context_unref(workers[idx].context);
+	}
+	g_free(workers);
+	workers = NULL;
+	num_workers = 0;
+}
+
+GMainContext *worker_pool_assign(void)
+{
+	Worker *selected = NULL;
+	guint idx;
+
+	G_LOCK(workers);
+	for (idx = 0; idx < num_workers; idx++) {
+		if (selected == NULL
+		    || workers[idx].num_games < selected->num_games)
+			selected = &workers[idx];
+	}
+	if (selected != NULL)
+		selected->num_games++;
+	G_UNLOCK(workers);
+
+	if (selected == NULL)
+		return NULL;
+	return g_main_context_ref(selected->context);
+}
+
+void worker_pool_release(GMainContext * context)
+{
+	guint idx;
+
+	if (context == NULL)
+		return;
+
+	G_LOCK(workers);
+	for (idx = 0; idx < num_workers; idx++) {
+		if (workers[idx].context == context) {
+			workers[idx].num_games--;
+			break;
+		}
+	}
+	G_UNLOCK(workers);
+	g_main_context_unref(context);
+}
+
+static gboolean worker_call_dispatch(gpointer data)
+{
+	WorkerCall *call = data;
+
+	call->func(call->data);
+
+	g_mutex_lock(&call->mutex);
+	call->done = TRUE;
+	g_cond_signal(&call->cond);
+	g_mutex_unlock(&call->mutex);
+	return FALSE;
+}
+
+void worker_call(GMainContext * context, GSourceFunc func, gpointer data)
+{
+	WorkerCall call;
+
+	if (context == NULL || g_main_context_is_owner(context)) {
+		func(data);
+		return;
+	}
+
+	call.func = func;
+	call.data = data;
+	call.done = FALSE;
+	g_mutex_init(&call.mutex);
+	g_cond_init(&call.cond);
+
+	/* Calls the function directly when nobody iterates the context */
+	g_main_context_invoke(context, worker_call_dispatch, &call);
+
+	g_mutex_lock(&call.mutex);
+	while (!call.done)
+		g_cond_wait(&call.cond, &call.mutex);
+	g_mutex_unlock(&call.mutex);
+
+	g_mutex_clear(&call.mutex);
+	g_cond_clear(&call.cond);
+}
@@ -0,0 +1,64 @@
+/* Pioneers - Implementation of the excellent Settlers of Catan board game.
+ *   Go buy a copy.
+ *
+ * Copyright (C) 2026 The Pioneers developers
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef __worker_h
+#define __worker_h
+
+#include <glib.h>
+
+/**
+ * Start the worker threads.
+ * Each worker iterates its own main context. A game is pinned to one
+ * worker, all its sources are dispatched by that worker.
+ * Without workers, all games run in the global default context.
+ * @param num_workers The number of threads
+ */
+void worker_pool_start(guint num_workers);
+
+/**
+ * Stop all worker threads, and wait until they have finished.
+ */
+void worker_pool_stop(void);
+
+/**
+ * Select the worker for a new game.
+ * @return The context of the least loaded worker (add a reference),
+ *         or NULL when there are no workers
+ */
+GMainContext *worker_pool_assign(void);
+
+/**
+ * Release the context that was returned by worker_pool_assign.
+ * @param context The context, or NULL
+ */
+void worker_pool_release(GMainContext * context);
+
+/**
+ * Run a function in the thread that dispatches a context, and wait until
+ * it has finished.
+ * When the current thread owns the context, or it is not iterated at all,
+ * the function is called directly.
+ * @param context The context, or NULL for the current thread
+ * @param func The function to call, its return value is ignored
+ * @param data The data for the function
+ */
+void worker_call(GMainContext * context, GSourceFunc func, gpointer data);
+
+#endif